@@ -1,10 +1,13 @@
-#version 130
+#version 140
 
 in vec2 Position2;
 in vec2 TexCoord2;
 out vec2 TexCoord;
 uniform mat4 ViewModel;
-uniform mat4 Projection;
+
+layout(std140) uniform View {
+    mat4 Projection;
+};
 
 void main() {
     // Assumes sprite coordinates are [0,0] lower left corner to [1,1] upper right.
@@ -0,0 +1,10 @@
+#version 130
+
+in vec2 TexCoord;
+in vec4 Color;
+
+uniform sampler2D Texture;
+
+void main() {
+    gl_FragColor = Color * texture(Texture, TexCoord.xy);
+}
@@ -0,0 +1,32 @@
+#version 140
+
+in vec2 InstancePosition2;
+in float GlyphIndex;
+in vec4 Color4;
+out vec2 TexCoord;
+out vec4 Color;
+uniform vec2 GlyphSize;
+uniform vec2 AtlasGrid;
+uniform vec2 BatchOrigin;
+uniform vec2 PositionStep;
+uniform mat4 ViewModel;
+
+layout(std140) uniform View {
+    mat4 Projection;
+};
+
+void main() {
+    // Each glyph is an instance of a 4 vertex triangle strip, with [0,0] as
+    // the lower left corner and [1,1] as the upper right.
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+
+    // Glyphs are laid out in rows in the atlas, in order of their index.
+    float row = floor((GlyphIndex + 0.5) / AtlasGrid.x);
+    float col = GlyphIndex - row * AtlasGrid.x;
+    TexCoord = (vec2(col, row) + corner) / AtlasGrid;
+    Color = Color4;
+
+    // Positions are offsets from the batch origin, in steps of PositionStep.
+    vec2 position = BatchOrigin + InstancePosition2 * PositionStep + corner * GlyphSize;
+    gl_Position = Projection * ViewModel * vec4(position.x, position.y, 0.5, 1.0);
+}
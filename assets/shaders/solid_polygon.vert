@@ -1,12 +1,15 @@
-#version 130
+#version 140
 
-uniform mat4 Projection;
 uniform mat4 ViewModel;
 uniform vec4 PolygonColor;
 
 in vec4 Position2;
 out vec4 Color;
 
+layout(std140) uniform View {
+    mat4 Projection;
+};
+
 // Passes position through without modification and generates texture
 // coordinates for drawing to a quad with the axis in the lower left
 // corner.
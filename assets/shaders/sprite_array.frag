@@ -0,0 +1,9 @@
+#version 130
+
+in vec3 TexCoord;
+
+uniform sampler2DArray TextureArray;
+
+void main() {
+    gl_FragColor = texture(TextureArray, TexCoord);
+}
@@ -0,0 +1,20 @@
+#version 140
+
+in vec2 Position2;
+in vec2 TexCoord2;
+in float Layer;
+out vec3 TexCoord;
+uniform vec2 BatchOrigin;
+uniform vec2 PositionStep;
+uniform mat4 ViewModel;
+
+layout(std140) uniform View {
+    mat4 Projection;
+};
+
+void main() {
+    // Positions are offsets from the batch origin, in steps of PositionStep.
+    vec2 position = BatchOrigin + Position2 * PositionStep;
+    TexCoord = vec3(TexCoord2, Layer);
+    gl_Position = Projection * ViewModel * vec4(position.x, position.y, 0.5, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 140
+
+in vec2 Position2;
+in vec2 TexCoord2;
+out vec2 TexCoord;
+uniform vec2 BatchOrigin;
+uniform vec2 TileSize;
+uniform mat4 ViewModel;
+
+layout(std140) uniform View {
+    mat4 Projection;
+};
+
+void main() {
+    // Positions are in tiles from the lower left corner of the chunk.
+    vec2 position = BatchOrigin + Position2 * TileSize;
+    TexCoord = TexCoord2;
+    gl_Position = Projection * ViewModel * vec4(position.x, position.y, 0.5, 1.0);
+}
@@ -0,0 +1,167 @@
+/**
+ * @file bench-atlas.c
+ *
+ * Compares ways of filling a texture atlas with 8x16 glyphs:
+ * - the original per-pixel copy with bounds checks on every pixel
+ * - `cnTextureAtlas_Insert`, one glyph at a time
+ * - `cnTextureAtlas_InsertBulk`
+ * - concurrent inserts from several threads
+ */
+#include "bench.h"
+
+#include <calendon/atlas.h>
+#include <calendon/log.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CN_BENCH_GLYPH_WIDTH 8
+#define CN_BENCH_GLYPH_HEIGHT 16
+#define CN_BENCH_DISTINCT_GLYPHS 256
+#define CN_BENCH_MAX_THREADS 8
+
+static CnImageRGBA8 glyphs[CN_BENCH_DISTINCT_GLYPHS];
+
+/**
+ * The atlas insertion from before row copies, kept as a baseline.
+ */
+static uint32_t cnBenchAtlas_InsertPerPixel(CnTextureAtlas* ta, CnImageRGBA8* subImage)
+{
+	const uint32_t subImageId = cnTextureAtlas_Reserve(ta, 1);
+	CnRowColu32 cell = cnTextureAtlas_SubImageGrid(ta, subImageId);
+	cell.row = ta->gridSize.height - cell.row - 1;
+
+	const uint32_t destStart = cell.row * ta->backingSizePixels.width * subImage->height + cell.col * subImage->width;
+	const uint32_t bytesPerPixel = 4;
+	for (uint32_t y = 0; y < subImage->height; ++y) {
+		for (uint32_t x = 0; x < subImage->width; ++x) {
+			const uint32_t srcOffset = x + y * subImage->width;
+			const uint32_t destOffset = destStart + x + y * ta->backingSizePixels.width;
+
+			CN_ASSERT(bytesPerPixel * destOffset < ta->image.pixels.size, "Writing off the edge of the image.");
+			CN_ASSERT(bytesPerPixel * srcOffset < subImage->pixels.size, "Reading off the edge of the image.");
+
+			uint32_t* dest = (uint32_t*)&ta->image.pixels.contents[bytesPerPixel * destOffset];
+			uint32_t* src = (uint32_t*)&subImage->pixels.contents[bytesPerPixel * srcOffset];
+			*dest = *src;
+		}
+	}
+	return subImageId;
+}
+
+typedef struct {
+	CnTextureAtlas* atlas;
+	uint32_t numGlyphs;
+} CnBenchAtlasWork;
+
+static int cnBenchAtlas_InsertWorker(void* data)
+{
+	CnBenchAtlasWork* work = (CnBenchAtlasWork*)data;
+	const uint32_t first = cnTextureAtlas_Reserve(work->atlas, work->numGlyphs);
+	for (uint32_t i = 0; i < work->numGlyphs; ++i) {
+		cnTextureAtlas_Write(work->atlas, first + i, &glyphs[(first + i) % CN_BENCH_DISTINCT_GLYPHS]);
+	}
+	return 0;
+}
+
+typedef enum {
+	CnBenchAtlasPerPixel,
+	CnBenchAtlasInsert,
+	CnBenchAtlasInsertBulk,
+	CnBenchAtlasThreaded
+} CnBenchAtlasMethod;
+
+static double cnBenchAtlas_Fill(CnTextureAtlas* atlas, uint32_t numGlyphs, CnBenchAtlasMethod method,
+	uint32_t numThreads)
+{
+	SDL_AtomicSet(&atlas->usedImages, 0);
+
+	const CnBenchTicks start = cnBench_Now();
+	switch (method) {
+		case CnBenchAtlasPerPixel:
+			for (uint32_t i = 0; i < numGlyphs; ++i) {
+				cnBenchAtlas_InsertPerPixel(atlas, &glyphs[i % CN_BENCH_DISTINCT_GLYPHS]);
+			}
+			break;
+		case CnBenchAtlasInsert:
+			for (uint32_t i = 0; i < numGlyphs; ++i) {
+				cnTextureAtlas_Insert(atlas, &glyphs[i % CN_BENCH_DISTINCT_GLYPHS]);
+			}
+			break;
+		case CnBenchAtlasInsertBulk:
+			for (uint32_t i = 0; i < numGlyphs; i += CN_BENCH_DISTINCT_GLYPHS) {
+				const uint32_t count = numGlyphs - i < CN_BENCH_DISTINCT_GLYPHS ? numGlyphs - i : CN_BENCH_DISTINCT_GLYPHS;
+				cnTextureAtlas_InsertBulk(atlas, glyphs, count);
+			}
+			break;
+		case CnBenchAtlasThreaded: {
+			CnBenchAtlasWork work[CN_BENCH_MAX_THREADS];
+			SDL_Thread* threads[CN_BENCH_MAX_THREADS];
+			for (uint32_t i = 0; i < numThreads; ++i) {
+				work[i].atlas = atlas;
+				work[i].numGlyphs = numGlyphs / numThreads + (i < numGlyphs % numThreads ? 1 : 0);
+				threads[i] = SDL_CreateThread(cnBenchAtlas_InsertWorker, "bench-atlas", &work[i]);
+			}
+			for (uint32_t i = 0; i < numThreads; ++i) {
+				SDL_WaitThread(threads[i], NULL);
+			}
+			break;
+		}
+		default:
+			CN_FATAL_ERROR("Unknown atlas fill method: %i", (int)method);
+	}
+	return cnBench_SecondsSince(start);
+}
+
+static void cnBenchAtlas_Run(const char* name, uint32_t numGlyphs, CnBenchAtlasMethod method,
+	uint32_t numThreads)
+{
+	CnTextureAtlas atlas;
+	cnTextureAtlas_Allocate(&atlas, (CnDimension2u32) { CN_BENCH_GLYPH_WIDTH, CN_BENCH_GLYPH_HEIGHT }, numGlyphs);
+	memset(atlas.image.pixels.contents, 0, atlas.image.pixels.size);
+
+	double best = cnBenchAtlas_Fill(&atlas, numGlyphs, method, numThreads);
+	for (uint32_t run = 1; run < CN_BENCH_RUNS; ++run) {
+		const double seconds = cnBenchAtlas_Fill(&atlas, numGlyphs, method, numThreads);
+		best = seconds < best ? seconds : best;
+	}
+
+	char label[64];
+	snprintf(label, sizeof(label), "%s (%" PRIu32 " glyphs)", name, numGlyphs);
+	cnBench_Report(label, best, 4.0 * CN_BENCH_GLYPH_WIDTH * CN_BENCH_GLYPH_HEIGHT * numGlyphs);
+
+	cnTextureAtlas_Free(&atlas);
+}
+
+int main(int argc, char* argv[])
+{
+	CN_UNUSED(argc);
+	CN_UNUSED(argv);
+
+	cnLog_SetEnabled(false);
+
+	for (uint32_t i = 0; i < CN_BENCH_DISTINCT_GLYPHS; ++i) {
+		cnImageRGBA8_AllocateSized(&glyphs[i], (CnDimension2u32) { CN_BENCH_GLYPH_WIDTH, CN_BENCH_GLYPH_HEIGHT });
+		for (uint32_t p = 0; p < glyphs[i].pixels.size; ++p) {
+			glyphs[i].pixels.contents[p] = (char)((i * 31 + p) & 0xFF);
+		}
+	}
+
+	int cpus = SDL_GetCPUCount();
+	const uint32_t numThreads = cpus < 2 ? 2 : (cpus > CN_BENCH_MAX_THREADS ? CN_BENCH_MAX_THREADS : (uint32_t)cpus);
+	char threadedName[32];
+	snprintf(threadedName, sizeof(threadedName), "Threaded x%" PRIu32, numThreads);
+
+	const uint32_t sizes[] = { 256, 4096, 65536 };
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(sizes); ++i) {
+		cnBenchAtlas_Run("Per pixel", sizes[i], CnBenchAtlasPerPixel, 1);
+		cnBenchAtlas_Run("Insert", sizes[i], CnBenchAtlasInsert, 1);
+		cnBenchAtlas_Run("Insert bulk", sizes[i], CnBenchAtlasInsertBulk, 1);
+		cnBenchAtlas_Run(threadedName, sizes[i], CnBenchAtlasThreaded, numThreads);
+	}
+
+	for (uint32_t i = 0; i < CN_BENCH_DISTINCT_GLYPHS; ++i) {
+		cnImageRGBA8_Free(&glyphs[i]);
+	}
+	return EXIT_SUCCESS;
+}
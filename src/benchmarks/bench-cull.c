@@ -0,0 +1,65 @@
+/**
+ * @file bench-cull.c
+ *
+ * Compares testing bounds against the camera one at a time with
+ * `cnCull_IsVisible` against testing them in a batch with `cnCull_AABB2s`,
+ * with about a quarter of the bounds visible.
+ */
+#include "bench.h"
+
+#include <calendon/cull.h>
+#include <calendon/log.h>
+
+#include <stdlib.h>
+
+#define CN_BENCH_CULL_BOUNDS (1024 * 1024)
+
+static CnAABB2 bounds[CN_BENCH_CULL_BOUNDS];
+static uint32_t visible[CN_BENCH_CULL_BOUNDS];
+
+static uint32_t cnBenchCull_OneAtATime(CnAABB2 area)
+{
+	uint32_t numVisible = 0;
+	for (uint32_t i = 0; i < CN_BENCH_CULL_BOUNDS; ++i) {
+		if (cnCull_IsVisible(area, bounds[i])) {
+			visible[numVisible++] = i;
+		}
+	}
+	return numVisible;
+}
+
+int main(int argc, char* argv[])
+{
+	CN_UNUSED(argc);
+	CN_UNUSED(argv);
+
+	cnLog_SetEnabled(false);
+
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < CN_BENCH_CULL_BOUNDS; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		const float x = (float)(seed >> 20);
+		const float y = (float)((seed >> 8) & 0xFFF);
+		bounds[i] = cnAABB2_MakeMinMax(cnFloat2_Make(x, y), cnFloat2_Make(x + 16.0f, y + 16.0f));
+	}
+	const CnAABB2 area = cnAABB2_MakeMinMax(cnFloat2_Make(0.0f, 0.0f), cnFloat2_Make(2048.0f, 2048.0f));
+
+	const char* names[] = { "One at a time", "Batch" };
+	for (uint32_t method = 0; method < CN_ARRAY_SIZE(names); ++method) {
+		double best = 0.0;
+		uint32_t numVisible = 0;
+		for (uint32_t run = 0; run < CN_BENCH_RUNS; ++run) {
+			const CnBenchTicks start = cnBench_Now();
+			numVisible = method == 0
+				? cnBenchCull_OneAtATime(area)
+				: cnCull_AABB2s(area, bounds, CN_BENCH_CULL_BOUNDS, visible);
+			const double seconds = cnBench_SecondsSince(start);
+			best = (run == 0 || seconds < best) ? seconds : best;
+		}
+
+		char label[64];
+		snprintf(label, sizeof(label), "%s (%" PRIu32 " visible)", names[method], numVisible);
+		cnBench_Report(label, best, (double)sizeof(bounds));
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file bench-image.c
+ *
+ * Measures throughput of each image kernel at every supported kernel level,
+ * on a 2048x2048 image.  Throughput counts the bytes of the source image.
+ */
+#include "bench.h"
+
+#include <calendon/image-kernels.h>
+#include <calendon/log.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CN_BENCH_IMAGE_SIZE 2048
+
+typedef enum {
+	CnBenchImageClear,
+	CnBenchImageFlip,
+	CnBenchImageBlit,
+	CnBenchImagePremultiply,
+	CnBenchImageSwizzle,
+	CnBenchImageDownsample,
+	CnBenchImageResizeNearest,
+	CnBenchImageResizeBilinear,
+	CnBenchImageKernelCount
+} CnBenchImageKernel;
+
+static const char* kernelNames[] = {
+	"Clear",
+	"Flip",
+	"Blit",
+	"Premultiply",
+	"Swizzle",
+	"Downsample",
+	"Resize nearest",
+	"Resize bilinear"
+};
+
+static const char* levelNames[] = {
+	"scalar",
+	"SSE2",
+	"AVX2"
+};
+
+static CnImageRGBA8 source, target, half, resized;
+
+static void cnBenchImage_RunKernel(CnBenchImageKernel kernel)
+{
+	static const uint8_t toBGRA[4] = { 2, 1, 0, 3 };
+	switch (kernel) {
+		case CnBenchImageClear:
+			cnImageRGBA8_ClearRGBA(&target, 10, 20, 30, 40);
+			break;
+		case CnBenchImageFlip:
+			cnImageRGBA8_Flip(&target);
+			break;
+		case CnBenchImageBlit:
+			cnImageRGBA8_Blit(&target, (CnRowColu32) { 0, 0 }, &source, (CnRowColu32) { 0, 0 },
+				(CnDimension2u32) { source.width, source.height });
+			break;
+		case CnBenchImagePremultiply:
+			cnImageRGBA8_Premultiply(&target);
+			break;
+		case CnBenchImageSwizzle:
+			cnImageRGBA8_Swizzle(&target, toBGRA);
+			break;
+		case CnBenchImageDownsample:
+			cnImageRGBA8_Downsample(&half, &source);
+			break;
+		case CnBenchImageResizeNearest:
+			cnImageRGBA8_Resize(&resized, &source, CnImageFilterNearest);
+			break;
+		case CnBenchImageResizeBilinear:
+			cnImageRGBA8_Resize(&resized, &source, CnImageFilterBilinear);
+			break;
+		default:
+			CN_FATAL_ERROR("Unknown image kernel: %i", (int)kernel);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	CN_UNUSED(argc);
+	CN_UNUSED(argv);
+
+	cnLog_SetEnabled(false);
+
+	const CnDimension2u32 size = { CN_BENCH_IMAGE_SIZE, CN_BENCH_IMAGE_SIZE };
+	cnImageRGBA8_AllocateSized(&source, size);
+	cnImageRGBA8_AllocateSized(&target, size);
+	cnImageRGBA8_AllocateSized(&half, (CnDimension2u32) { size.width / 2, size.height / 2 });
+	cnImageRGBA8_AllocateSized(&resized, (CnDimension2u32) { size.width * 3 / 4, size.height * 3 / 4 });
+	for (uint32_t i = 0; i < source.pixels.size; ++i) {
+		source.pixels.contents[i] = (char)((i * 131) >> 3);
+	}
+	memcpy(target.pixels.contents, source.pixels.contents, source.pixels.size);
+
+	cnImageKernels_SetMaxLevel(CnImageKernelLevelAVX2);
+	const CnImageKernelLevel supported = cnImageKernels_Level();
+
+	for (uint32_t kernel = 0; kernel < CnBenchImageKernelCount; ++kernel) {
+		for (uint32_t level = CnImageKernelLevelScalar; level <= (uint32_t)supported; ++level) {
+			cnImageKernels_SetMaxLevel((CnImageKernelLevel)level);
+
+			double best = 0.0;
+			for (uint32_t run = 0; run < CN_BENCH_RUNS; ++run) {
+				const CnBenchTicks start = cnBench_Now();
+				cnBenchImage_RunKernel((CnBenchImageKernel)kernel);
+				const double seconds = cnBench_SecondsSince(start);
+				best = (run == 0 || seconds < best) ? seconds : best;
+			}
+
+			char label[64];
+			snprintf(label, sizeof(label), "%s (%s)", kernelNames[kernel], levelNames[level]);
+			cnBench_Report(label, best, (double)source.pixels.size);
+		}
+	}
+
+	cnImageRGBA8_Free(&source);
+	cnImageRGBA8_Free(&target);
+	cnImageRGBA8_Free(&half);
+	cnImageRGBA8_Free(&resized);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,36 @@
+/*
+ * Timing helpers shared by benchmarks.
+ */
+#ifndef CN_BENCH_H
+#define CN_BENCH_H
+
+#include <calendon/cn.h>
+
+#include <calendon/compat-sdl.h>
+
+#include <stdio.h>
+
+/**
+ * Runs of each case, of which the fastest is reported to reduce noise from
+ * other processes.
+ */
+#define CN_BENCH_RUNS 5
+
+typedef uint64_t CnBenchTicks;
+
+static inline CnBenchTicks cnBench_Now(void)
+{
+	return SDL_GetPerformanceCounter();
+}
+
+static inline double cnBench_SecondsSince(CnBenchTicks start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+static inline void cnBench_Report(const char* name, double seconds, double bytes)
+{
+	printf("%-40s %10.3f ms %10.3f GB/s\n", name, seconds * 1000.0, bytes / seconds / 1.0e9);
+}
+
+#endif /* CN_BENCH_H */
@@ -0,0 +1,193 @@
+#include "assets-archive.h"
+
+#include <calendon/log.h>
+
+#include <string.h>
+#include <zlib.h>
+
+extern CnLogHandle LogSysAssets;
+
+const uint8_t cnArchive_Magic[4] = { 'C', 'N', 'P', 'K' };
+
+/**
+ * Hashes an asset name for lookup in the archive table of contents.  This is
+ * 64-bit FNV-1a, which is stable across platforms so archives may be built on
+ * a different machine than the one reading them.
+ */
+uint64_t cnArchive_HashName(const char* name)
+{
+	CN_ASSERT_PTR(name);
+
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (const uint8_t* cursor = (const uint8_t*)name; *cursor; ++cursor) {
+		hash ^= *cursor;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/**
+ * Maps an archive for reading and validates its table of contents.
+ */
+bool cnArchive_Open(CnArchive* archive, const char* path)
+{
+	CN_ASSERT_PTR(archive);
+	CN_ASSERT_PTR(path);
+
+	memset(archive, 0, sizeof(CnArchive));
+
+	if (!cnAssets_MapFile(path, &archive->file)) {
+		return false;
+	}
+
+	const CnArchiveHeader* header = (const CnArchiveHeader*)archive->file.contents;
+	if (archive->file.size < sizeof(CnArchiveHeader)
+		|| memcmp(header->magic, cnArchive_Magic, sizeof(cnArchive_Magic)) != 0)
+	{
+		CN_ERROR(LogSysAssets, "Not an asset archive: %s", path);
+		cnArchive_Close(archive);
+		return false;
+	}
+
+	if (header->version != CN_ARCHIVE_VERSION) {
+		CN_ERROR(LogSysAssets, "Asset archive %s is version %" PRIu32 ", expected %" PRIu32,
+			path, header->version, (uint32_t)CN_ARCHIVE_VERSION);
+		cnArchive_Close(archive);
+		return false;
+	}
+
+	const uint64_t tableEnd = sizeof(CnArchiveHeader)
+		+ (uint64_t)header->numEntries * sizeof(CnArchiveEntry)
+		+ header->namesSize;
+	if (tableEnd > archive->file.size) {
+		CN_ERROR(LogSysAssets, "Asset archive %s is truncated", path);
+		cnArchive_Close(archive);
+		return false;
+	}
+
+	archive->header = header;
+	archive->entries = (const CnArchiveEntry*)(archive->file.contents + sizeof(CnArchiveHeader));
+	archive->names = (const char*)(archive->entries + header->numEntries);
+
+	// Uncompressed entries are mapped with their unpacked size, so it must match
+	// what is stored.
+	for (uint32_t i = 0; i < header->numEntries; ++i) {
+		const CnArchiveEntry* entry = &archive->entries[i];
+		const bool compressed = (entry->flags & CN_ARCHIVE_ENTRY_FLAG_ZLIB) != 0;
+		if (entry->nameOffset >= header->namesSize
+			|| entry->offset > archive->file.size
+			|| entry->storedSize > archive->file.size - entry->offset
+			|| (!compressed && entry->size != entry->storedSize))
+		{
+			CN_ERROR(LogSysAssets, "Asset archive %s has a bad entry: %" PRIu32, path, i);
+			cnArchive_Close(archive);
+			return false;
+		}
+	}
+
+	CN_TRACE(LogSysAssets, "Opened asset archive %s with %" PRIu32 " entries",
+		path, header->numEntries);
+	return true;
+}
+
+void cnArchive_Close(CnArchive* archive)
+{
+	CN_ASSERT_PTR(archive);
+	if (archive->file.contents) {
+		cnAssets_UnmapFile(&archive->file);
+	}
+	archive->header = NULL;
+	archive->entries = NULL;
+	archive->names = NULL;
+}
+
+bool cnArchive_IsOpen(const CnArchive* archive)
+{
+	CN_ASSERT_PTR(archive);
+	return archive->header != NULL;
+}
+
+/**
+ * Finds an entry by its name relative to the assets root, e.g.
+ * "sprites/test_sprite.png".
+ *
+ * @return the entry, or NULL if the archive doesn't contain the asset
+ */
+const CnArchiveEntry* cnArchive_Find(const CnArchive* archive, const char* name)
+{
+	CN_ASSERT_PTR(archive);
+	CN_ASSERT_PTR(name);
+
+	if (!cnArchive_IsOpen(archive)) {
+		return NULL;
+	}
+
+	const uint64_t hash = cnArchive_HashName(name);
+
+	// Find the first entry with the hash.
+	uint32_t low = 0;
+	uint32_t high = archive->header->numEntries;
+	while (low < high) {
+		const uint32_t mid = low + (high - low) / 2;
+		if (archive->entries[mid].nameHash < hash) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+
+	// Colliding names are adjacent.
+	const size_t maxNameLength = archive->header->namesSize;
+	for (uint32_t i = low; i < archive->header->numEntries; ++i) {
+		const CnArchiveEntry* entry = &archive->entries[i];
+		if (entry->nameHash != hash) {
+			break;
+		}
+		const char* entryName = archive->names + entry->nameOffset;
+		if (strncmp(entryName, name, maxNameLength - entry->nameOffset) == 0) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Provides read-only access to an archive entry.  Uncompressed entries are
+ * borrowed directly from the archive mapping, and must not outlive the
+ * archive.  Compressed entries are inflated into a buffer owned by the view.
+ */
+bool cnArchive_MapEntry(const CnArchive* archive, const CnArchiveEntry* entry, CnFileView* view)
+{
+	CN_ASSERT_PTR(archive);
+	CN_ASSERT_PTR(entry);
+	CN_ASSERT_PTR(view);
+	CN_ASSERT(cnArchive_IsOpen(archive), "Cannot map an entry from a closed archive.");
+
+	const uint8_t* stored = archive->file.contents + entry->offset;
+
+	if ((entry->flags & CN_ARCHIVE_ENTRY_FLAG_ZLIB) == 0) {
+		view->contents = stored;
+		view->size = entry->size;
+		view->buffer.contents = NULL;
+		view->buffer.size = 0;
+		view->source = CnFileViewSourceArchive;
+		return true;
+	}
+
+	cnDynamicBuffer_Allocate(&view->buffer, entry->size);
+	uLongf inflatedSize = entry->size;
+	const int result = uncompress((Bytef*)view->buffer.contents, &inflatedSize,
+		(const Bytef*)stored, entry->storedSize);
+	if (result != Z_OK || inflatedSize != entry->size) {
+		CN_ERROR(LogSysAssets, "Unable to inflate archive entry: %s",
+			archive->names + entry->nameOffset);
+		cnDynamicBuffer_Free(&view->buffer);
+		return false;
+	}
+
+	view->contents = (const uint8_t*)view->buffer.contents;
+	view->size = entry->size;
+	view->source = CnFileViewSourceBuffer;
+	return true;
+}
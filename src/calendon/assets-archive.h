@@ -0,0 +1,93 @@
+#ifndef CN_ASSETS_ARCHIVE_H
+#define CN_ASSETS_ARCHIVE_H
+
+/**
+ * @file assets-archive.h
+ *
+ * Packed asset archives store many assets in a single file, so loading an
+ * asset doesn't require resolving, opening and reading a separate file.
+ *
+ * Archive layout:
+ * - `CnArchiveHeader`
+ * - `CnArchiveEntry[numEntries]`, sorted by `nameHash`, then by name
+ * - name table of null-terminated asset names, relative to the assets root
+ * - entry data, each entry starting on a `CN_ARCHIVE_ALIGNMENT` boundary
+ *
+ * All values are stored little-endian.  Archives are memory mapped, so
+ * uncompressed entries are read directly out of the mapping without copying.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/assets-fileio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CN_ARCHIVE_VERSION 1
+
+/**
+ * Entry data is page aligned, so mapped entries can be handed directly to
+ * anything expecting page aligned memory.
+ */
+#define CN_ARCHIVE_ALIGNMENT 4096
+
+/**
+ * The entry is stored zlib compressed and must be inflated on read.
+ */
+#define CN_ARCHIVE_ENTRY_FLAG_ZLIB 0x01
+
+typedef struct {
+	uint8_t magic[4];
+	uint32_t version;
+	uint32_t numEntries;
+
+	/** The size in bytes of the name table following the entries. */
+	uint32_t namesSize;
+} CnArchiveHeader;
+
+typedef struct {
+	uint64_t nameHash;
+
+	/** Byte offset of the entry data from the start of the archive. */
+	uint64_t offset;
+
+	/** The number of bytes stored in the archive. */
+	uint32_t storedSize;
+
+	/** The number of bytes once decompressed. */
+	uint32_t size;
+
+	/** Byte offset of the entry name in the name table. */
+	uint32_t nameOffset;
+	uint32_t flags;
+} CnArchiveEntry;
+
+CN_STATIC_ASSERT(sizeof(CnArchiveHeader) == 16, "Padding present in CnArchiveHeader");
+CN_STATIC_ASSERT(sizeof(CnArchiveEntry) == 32, "Padding present in CnArchiveEntry");
+
+/**
+ * An open, read-only archive.
+ */
+typedef struct {
+	CnFileView file;
+	const CnArchiveHeader* header;
+	const CnArchiveEntry* entries;
+	const char* names;
+} CnArchive;
+
+extern CN_API const uint8_t cnArchive_Magic[4];
+
+CN_API uint64_t              cnArchive_HashName(const char* name);
+CN_API bool                  cnArchive_Open(CnArchive* archive, const char* path);
+CN_API void                  cnArchive_Close(CnArchive* archive);
+CN_API bool                  cnArchive_IsOpen(const CnArchive* archive);
+CN_API const CnArchiveEntry* cnArchive_Find(const CnArchive* archive, const char* name);
+CN_API bool                  cnArchive_MapEntry(const CnArchive* archive, const CnArchiveEntry* entry, CnFileView* view);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_ASSETS_ARCHIVE_H */
@@ -6,6 +6,9 @@
 #include <calendon/string.h>
 
 int32_t cnAssets_OptionAssetDir(const CnCommandLineParse* parse, void* c);
+int32_t cnAssets_OptionAssetArchive(const CnCommandLineParse* parse, void* c);
+int32_t cnAssets_OptionAssetCache(const CnCommandLineParse* parse, void* c);
+int32_t cnAssets_OptionNoAssetCache(const CnCommandLineParse* parse, void* c);
 
 static CnAssetsConfig s_config;
 static CnCommandLineOption options[] = {
@@ -16,12 +19,33 @@ static CnCommandLineOption options[] = {
 		"--asset-dir",
 		cnAssets_OptionAssetDir
 	},
+	{
+		"\t--asset-archive FILE\n"
+			"\t\tChange the packed asset archive to prefer over loose files.\n",
+		NULL,
+		"--asset-archive",
+		cnAssets_OptionAssetArchive
+	},
+	{
+		"\t--asset-cache DIR\n"
+			"\t\tChange the directory where decoded images are cached.\n",
+		NULL,
+		"--asset-cache",
+		cnAssets_OptionAssetCache
+	},
+	{
+		"\t--no-asset-cache\n"
+			"\t\tDecode images on every load, without caching them.\n",
+		NULL,
+		"--no-asset-cache",
+		cnAssets_OptionNoAssetCache
+	},
 };
 
 CnCommandLineOptionList cnAssets_CommandLineOptionList(void) {
 	CnCommandLineOptionList optionList;
 	optionList.options = options;
-	optionList.numOptions = 1;
+	optionList.numOptions = 4;
 	return optionList;
 }
 
@@ -53,6 +77,68 @@ int32_t cnAssets_OptionAssetDir(const CnCommandLineParse* parse, void* c)
 	}
 }
 
+int32_t cnAssets_OptionAssetArchive(const CnCommandLineParse* parse, void* c)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(c);
+
+	CnAssetsConfig* config = (CnAssetsConfig*)c;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide an asset archive to use.\n");
+		return CnOptionParseError;
+	}
+
+	const char* archive = cnCommandLineParse_LookAhead(parse, 2);
+	if (cnString_FitsWithNull(archive, CN_MAX_TERMINATED_PATH)) {
+		if (!cnPath_IsFile(archive)) {
+			cnPrint("Asset archive %s does not exist\n", archive);
+			return CnOptionParseError;
+		}
+		cnPathBuffer_Set(&config->archivePath, archive);
+		cnPrint("Asset archive: '%s'\n", config->archivePath.str);
+		return 2;
+	}
+	else {
+		cnPrint( "The asset archive path is too long.");
+		return CnOptionParseError;
+	}
+}
+
+int32_t cnAssets_OptionAssetCache(const CnCommandLineParse* parse, void* c)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(c);
+
+	CnAssetsConfig* config = (CnAssetsConfig*)c;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide an asset cache directory to use.\n");
+		return CnOptionParseError;
+	}
+
+	const char* cacheDir = cnCommandLineParse_LookAhead(parse, 2);
+	if (cnString_FitsWithNull(cacheDir, CN_MAX_TERMINATED_PATH)) {
+		cnPathBuffer_Set(&config->cachePath, cacheDir);
+		cnPrint("Asset cache: '%s'\n", config->cachePath.str);
+		return 2;
+	}
+	else {
+		cnPrint( "The asset cache path is too long.");
+		return CnOptionParseError;
+	}
+}
+
+int32_t cnAssets_OptionNoAssetCache(const CnCommandLineParse* parse, void* c)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(c);
+
+	CnAssetsConfig* config = (CnAssetsConfig*)c;
+	cnPathBuffer_Clear(&config->cachePath);
+	return 1;
+}
+
 void* cnAssets_Config(void) {
 	return &s_config;
 }
@@ -68,4 +154,21 @@ void cnAssets_SetDefaultConfig(void* config)
 	if (!cnPathBuffer_Join(&c->assetDirPath, "assets")) {
 		CN_FATAL_ERROR("Unable to join to Calendon home expect asset dir path: %s", c->assetDirPath.str);
 	}
+
+	// The default archive sits beside the default asset directory.
+	cnPathBuffer_Clear(&c->archivePath);
+	if (!cnPathBuffer_DefaultCalendonHome(&c->archivePath)) {
+		CN_FATAL_ERROR("Unable to get default Calendon home.");
+	}
+	if (!cnPathBuffer_Join(&c->archivePath, "assets.cnpack")) {
+		CN_FATAL_ERROR("Unable to join to Calendon home expect asset archive path: %s", c->archivePath.str);
+	}
+
+	cnPathBuffer_Clear(&c->cachePath);
+	if (!cnPathBuffer_DefaultCalendonHome(&c->cachePath)) {
+		CN_FATAL_ERROR("Unable to get default Calendon home.");
+	}
+	if (!cnPathBuffer_Join(&c->cachePath, "cache")) {
+		CN_FATAL_ERROR("Unable to join to Calendon home expect asset cache path: %s", c->cachePath.str);
+	}
 }
@@ -7,6 +7,18 @@
 
 typedef struct {
 	CnPathBuffer assetDirPath;
+
+	/**
+	 * A packed asset archive to read assets from before falling back to loose
+	 * files in `assetDirPath`.  Ignored if the file does not exist.
+	 */
+	CnPathBuffer archivePath;
+
+	/**
+	 * Where decoded images are cached between runs.  Caching is disabled if
+	 * this is empty.
+	 */
+	CnPathBuffer cachePath;
 } CnAssetsConfig;
 
 CnCommandLineOptionList cnAssets_CommandLineOptionList(void);
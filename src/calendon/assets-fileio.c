@@ -1,11 +1,25 @@
+#ifdef __linux__
+	// Expose madvise, which is not part of the POSIX level used by the build.
+	#define _DEFAULT_SOURCE
+#endif
+
 #include "assets-fileio.h"
 
+#include "assets.h"
 #include "log.h"
+#include "path.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
+#ifdef __linux__
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
 extern CnLogHandle LogSysAssets;
 
 /**
@@ -38,6 +52,20 @@ bool cnAssets_ReadFile(const char *filename, uint32_t format, CnDynamicBuffer *b
 		return false;
 	}
 
+	// Prefer the contents of the asset archive when one is loaded.
+	CnFileView archived;
+	if (cnAssets_MapFromArchive(filename, &archived)) {
+		const uint32_t storageSize = format == CnFileTypeText ? archived.size + 1 : archived.size;
+		cnDynamicBuffer_Allocate(buffer, storageSize);
+		memcpy(buffer->contents, archived.contents, archived.size);
+		if (format == CnFileTypeText) {
+			buffer->contents[archived.size] = '\0';
+		}
+		buffer->size = archived.size;
+		cnAssets_UnmapFile(&archived);
+		return true;
+	}
+
 	const char* readMode = format == CnFileTypeText ? "r" : "rb";
 	FILE* file = fopen(filename, readMode);
 	if (!file) {
@@ -79,6 +107,137 @@ bool cnAssets_ReadFile(const char *filename, uint32_t format, CnDynamicBuffer *b
 	return true;
 }
 
+/**
+ * Provides read-only access to an entire binary file without copying it into a
+ * separately allocated buffer where possible.  Asset parsers which only read
+ * their input should prefer this to `cnAssets_ReadFile`.
+ *
+ * Assets found in the loaded asset archive are provided from the archive.
+ * On Linux, loose files are privately mapped and the kernel is told to start
+ * reading the pages in sequentially.  Other platforms read the file into a
+ * dynamic buffer owned by the view.
+ *
+ * @param filename some valid, null-terminated path
+ * @param view where the file view will be written to
+ * @return true if succeeded, false otherwise
+ *
+ * @see cnAssets_UnmapFile
+ */
+bool cnAssets_MapFile(const char* filename, CnFileView* view)
+{
+	if (!filename) {
+		CN_ERROR(LogSysAssets, "Cannot map a null filename");
+		return false;
+	}
+
+	if (!view) {
+		CN_ERROR(LogSysAssets, "Cannot write a file mapping to a null view");
+		return false;
+	}
+
+	view->contents = NULL;
+	view->size = 0;
+	view->buffer.contents = NULL;
+	view->buffer.size = 0;
+	view->source = CnFileViewSourceBuffer;
+
+	if (cnAssets_MapFromArchive(filename, view)) {
+		return true;
+	}
+
+#ifdef __linux__
+	const int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		CN_ERROR(LogSysAssets, "Cannot open file: %s", filename);
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		CN_ERROR(LogSysAssets, "Cannot determine size of file: %s", filename);
+		close(fd);
+		return false;
+	}
+
+	if (info.st_size <= 0 || (uint64_t)info.st_size > UINT32_MAX) {
+		CN_ERROR(LogSysAssets, "File '%s' has an unmappable size: %lli bytes",
+			filename, (long long int)info.st_size);
+		close(fd);
+		return false;
+	}
+
+	void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping holds its own reference to the file.
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		CN_ERROR(LogSysAssets, "Unable to map file: %s", filename);
+		return false;
+	}
+
+	// Advice is only a hint, so failures here are not errors.
+	madvise(mapping, (size_t)info.st_size, MADV_WILLNEED);
+	madvise(mapping, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+	view->contents = (const uint8_t*)mapping;
+	view->size = (uint32_t)info.st_size;
+	view->source = CnFileViewSourceMapping;
+
+	CN_TRACE(LogSysAssets, "Mapped %" PRIu32 " bytes from %s", view->size, filename);
+	return true;
+#else
+	if (!cnAssets_ReadFile(filename, CnFileTypeBinary, &view->buffer)) {
+		return false;
+	}
+	view->contents = (const uint8_t*)view->buffer.contents;
+	view->size = view->buffer.size;
+	return true;
+#endif
+}
+
+/**
+ * Releases the file contents provided by `cnAssets_MapFile`.  Pointers into
+ * the view are invalid after this call.
+ */
+void cnAssets_UnmapFile(CnFileView* view)
+{
+	CN_ASSERT_PTR(view);
+	CN_ASSERT(view->contents != NULL, "CnFileView has already been released");
+
+	switch (view->source) {
+		case CnFileViewSourceBuffer:
+			cnDynamicBuffer_Free(&view->buffer);
+			break;
+		case CnFileViewSourceMapping:
+#ifdef __linux__
+			munmap((void*)view->contents, view->size);
+#endif
+			break;
+		case CnFileViewSourceArchive:
+			// The archive owns the contents.
+			break;
+		default:
+			CN_FATAL_ERROR("Unknown file view source: %i", (int)view->source);
+	}
+
+	view->contents = NULL;
+	view->size = 0;
+	view->source = CnFileViewSourceBuffer;
+}
+
+/**
+ * Determines if a file can be read, either from the asset archive or as a
+ * loose file.
+ */
+bool cnAssets_FileExists(const char* filename)
+{
+	if (!filename) {
+		return false;
+	}
+	return cnAssets_IsInArchive(filename) || cnPath_IsFile(filename);
+}
+
 bool cnAssets_LastModifiedTime(const char* filename, uint64_t* lastModifiedTime)
 {
 	if (!filename) {
@@ -93,3 +252,29 @@ bool cnAssets_LastModifiedTime(const char* filename, uint64_t* lastModifiedTime)
 	*lastModifiedTime = (uint64_t)info.st_mtime;
 	return true;
 }
+
+/**
+ * Provides the size and modification time of a file, which together identify
+ * a version of an asset for caching derived data.
+ */
+bool cnAssets_FileStamp(const char* filename, uint64_t* size, uint64_t* lastModifiedTime)
+{
+	CN_ASSERT_PTR(size);
+	CN_ASSERT_PTR(lastModifiedTime);
+
+	if (!filename) {
+		return false;
+	}
+
+	if (cnAssets_ArchiveStamp(filename, size, lastModifiedTime)) {
+		return true;
+	}
+
+	struct stat info;
+	if (stat(filename, &info) != 0) {
+		return false;
+	}
+
+	*size = (uint64_t)info.st_size;
+	return cnAssets_LastModifiedTime(filename, lastModifiedTime);
+}
@@ -14,8 +14,44 @@ typedef enum {
 	CnFileTypeText
 } CnFileType;
 
+/**
+ * Where the contents of a `CnFileView` are stored, which determines how the
+ * view gets released.
+ */
+typedef enum {
+	/** Contents are owned by the view's dynamic buffer. */
+	CnFileViewSourceBuffer,
+
+	/** Contents are a memory mapping of the file owned by the view. */
+	CnFileViewSourceMapping,
+
+	/** Contents are borrowed from an open asset archive. */
+	CnFileViewSourceArchive
+} CnFileViewSource;
+
+/**
+ * Read-only access to the contents of an entire file.
+ *
+ * Views are created with `cnAssets_MapFile` and must be released with
+ * `cnAssets_UnmapFile`.  Where supported, the file is memory mapped so no copy
+ * of the file is made, otherwise the file is read into `buffer`.
+ */
+typedef struct {
+	const uint8_t* contents;
+	uint32_t size;
+
+	/** Fallback storage when memory mapping is not available. */
+	CnDynamicBuffer buffer;
+
+	CnFileViewSource source;
+} CnFileView;
+
 CN_API bool cnAssets_ReadFile(const char *filename, uint32_t format, CnDynamicBuffer *buffer);
+CN_API bool cnAssets_MapFile(const char* filename, CnFileView* view);
+CN_API void cnAssets_UnmapFile(CnFileView* view);
+CN_API bool cnAssets_FileExists(const char* filename);
 CN_API bool cnAssets_LastModifiedTime(const char* filename, uint64_t* lastModifiedTime);
+CN_API bool cnAssets_FileStamp(const char* filename, uint64_t* size, uint64_t* lastModifiedTime);
 
 #ifdef __cplusplus
 }
@@ -2,7 +2,9 @@
 
 #include <calendon/cn.h>
 
+#include <calendon/assets-archive.h>
 #include <calendon/assets-config.h>
+#include <calendon/image-cache.h>
 #include <calendon/log.h>
 #include <calendon/path.h>
 #include <calendon/string.h>
@@ -14,6 +16,13 @@ static size_t assetsRootLength = 0;
 CnLogHandle LogSysAssets;
 static bool assetsInitialized = false;
 
+/**
+ * Assets are read from the archive in preference to loose files, when an
+ * archive is available.
+ */
+static CnArchive assetsArchive;
+static uint64_t assetsArchiveModifiedTime;
+
 bool cnAssets_IsReady(void)
 {
 	return assetsInitialized;
@@ -48,6 +57,21 @@ bool cnAssets_Init(void)
 
 	LogSysAssets = cnLog_RegisterSystem("Assets");
 
+	memset(&assetsArchive, 0, sizeof(CnArchive));
+	assetsArchiveModifiedTime = 0;
+	if (cnPathBuffer_IsFile(&config->archivePath)) {
+		if (!cnArchive_Open(&assetsArchive, config->archivePath.str)) {
+			CN_WARN(LogSysAssets, "Unable to open asset archive, using loose files: %s",
+				config->archivePath.str);
+		}
+		cnAssets_LastModifiedTime(config->archivePath.str, &assetsArchiveModifiedTime);
+	}
+
+	if (config->cachePath.str[0] != '\0' && !cnImageCache_Open(config->cachePath.str)) {
+		CN_WARN(LogSysAssets, "Unable to use texture cache, images will be decoded: %s",
+			config->cachePath.str);
+	}
+
 	CN_TRACE(LogSysAssets, "Assets initialized with root at: '%s'", assetsRoot);
 	assetsInitialized = true;
 	return true;
@@ -56,6 +80,8 @@ bool cnAssets_Init(void)
 void cnAssets_Shutdown(void)
 {
 	CN_ASSERT(cnAssets_IsReady(), "Cannot shutdown assets system, is not initialized.");
+	cnImageCache_Close();
+	cnArchive_Close(&assetsArchive);
 	assetsInitialized = false;
 	CN_ASSERT(!cnAssets_IsReady(), "Shutdown did not work on assets system.");
 }
@@ -81,6 +107,81 @@ bool cnAssets_PathBufferFor(const char* assetName, CnPathBuffer* path)
 	return true;
 }
 
+/**
+ * Converts a path resolved by `cnAssets_PathBufferFor` back into the asset
+ * name, relative to the assets root.
+ *
+ * @return the asset name, or NULL if the path is not within the assets root
+ */
+const char* cnAssets_NameForPath(const char* path)
+{
+	if (!path || assetsRootLength == 0) {
+		return NULL;
+	}
+	if (strncmp(path, assetsRoot, assetsRootLength) != 0 || path[assetsRootLength] != '/') {
+		return NULL;
+	}
+	return path + assetsRootLength + 1;
+}
+
+static const char* cnAssets_ArchiveNameForPath(const char* path)
+{
+	if (!cnArchive_IsOpen(&assetsArchive)) {
+		return NULL;
+	}
+	return cnAssets_NameForPath(path);
+}
+
+bool cnAssets_IsInArchive(const char* path)
+{
+	const char* name = cnAssets_ArchiveNameForPath(path);
+	return name && cnArchive_Find(&assetsArchive, name) != NULL;
+}
+
+/**
+ * Provides the contents of an asset from the asset archive.
+ *
+ * @return false if there is no archive, or the asset isn't in it
+ */
+bool cnAssets_MapFromArchive(const char* path, CnFileView* view)
+{
+	CN_ASSERT_PTR(view);
+
+	const char* name = cnAssets_ArchiveNameForPath(path);
+	if (!name) {
+		return false;
+	}
+
+	const CnArchiveEntry* entry = cnArchive_Find(&assetsArchive, name);
+	if (!entry) {
+		return false;
+	}
+	return cnArchive_MapEntry(&assetsArchive, entry, view);
+}
+
+/**
+ * Archived assets have no modification time of their own, so they take the
+ * modification time of the archive.
+ */
+bool cnAssets_ArchiveStamp(const char* path, uint64_t* size, uint64_t* lastModifiedTime)
+{
+	CN_ASSERT_PTR(size);
+	CN_ASSERT_PTR(lastModifiedTime);
+
+	const char* name = cnAssets_ArchiveNameForPath(path);
+	if (!name) {
+		return false;
+	}
+
+	const CnArchiveEntry* entry = cnArchive_Find(&assetsArchive, name);
+	if (!entry) {
+		return false;
+	}
+	*size = entry->size;
+	*lastModifiedTime = assetsArchiveModifiedTime;
+	return true;
+}
+
 const char* cnAssets_Name(void)
 {
 	return "Assets";
@@ -2,6 +2,7 @@
 #define CN_ASSETS_H
 
 #include <calendon/cn.h>
+#include <calendon/assets-fileio.h>
 #include <calendon/path.h>
 #include <calendon/system.h>
 
@@ -13,6 +14,11 @@ CN_API CnSystem cnAssets_System(void);
 CN_API bool cnAssets_IsReady(void);
 CN_API bool cnAssets_PathBufferFor(const char* assetName, CnPathBuffer* path);
 
+const char* cnAssets_NameForPath(const char* path);
+bool cnAssets_IsInArchive(const char* path);
+bool cnAssets_MapFromArchive(const char* path, CnFileView* view);
+bool cnAssets_ArchiveStamp(const char* path, uint64_t* size, uint64_t* lastModifiedTime);
+
 #ifdef __cplusplus
 }
 #endif
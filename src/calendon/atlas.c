@@ -3,13 +3,14 @@
 #include <calendon/log.h>
 
 #include <math.h>
+#include <string.h>
 
 void cnTextureAtlas_Allocate(CnTextureAtlas* ta, CnDimension2u32 subImageSize, uint32_t numImages) {
 	CN_ASSERT(ta != NULL, "Cannot allocate a NULL texture atlas.");
 	CN_ASSERT(subImageSize.width > 0, "Cannot create a texture atlas with a zero width sub image.");
 	CN_ASSERT(subImageSize.height > 0, "Cannot create a texture atlas with a zero height sub image.");
 	CN_ASSERT(numImages > 0, "Cannot create a texture atlas for zero images.");
-	ta->usedImages = 0;
+	SDL_AtomicSet(&ta->usedImages, 0);
 	ta->totalImages = numImages;
 	ta->subImageSizePixels = subImageSize;
 	ta->gridSize = (CnDimension2u32) { (uint32_t)ceil(sqrt(numImages)), (uint32_t)ceil(sqrt(numImages)) };
@@ -44,43 +45,88 @@ uint32_t cnImageRGBA8_OffsetForRowCol(CnImageRGBA8* image, CnRowColu32 rowCol, b
 	}
 }
 
-// Assumes both textures are unflipped.
-uint32_t cnTextureAtlas_Insert(CnTextureAtlas* ta, CnImageRGBA8* subImage) {
+/**
+ * Claims the next `numImages` cells of the atlas, returning the id of the
+ * first.  Safe to call from several threads at once.
+ */
+uint32_t cnTextureAtlas_Reserve(CnTextureAtlas* ta, uint32_t numImages)
+{
+	CN_ASSERT(ta != NULL, "Cannot reserve space in a null texture atlas.");
+	CN_ASSERT(numImages <= ta->totalImages, "CnTextureAtlas is full.");
+
+	const uint32_t first = (uint32_t)SDL_AtomicAdd(&ta->usedImages, (int)numImages);
+	CN_ASSERT(first + numImages <= ta->totalImages, "CnTextureAtlas is full.");
+	return first;
+}
+
+uint32_t cnTextureAtlas_UsedImages(CnTextureAtlas* ta)
+{
+	CN_ASSERT(ta != NULL, "Cannot count images in a null texture atlas.");
+	return (uint32_t)SDL_AtomicGet(&ta->usedImages);
+}
+
+/**
+ * Copies a sub image into its reserved cell, a row at a time.  Writes to
+ * different cells may happen concurrently.
+ *
+ * Assumes both textures are unflipped.
+ */
+void cnTextureAtlas_Write(CnTextureAtlas* ta, uint32_t subImageId, const CnImageRGBA8* subImage)
+{
+	CN_ASSERT(ta != NULL, "Cannot write to a null texture atlas.");
 	CN_ASSERT(subImage != NULL, "Cannot add a null image to a texture atlas.");
-	CN_ASSERT(ta->usedImages < ta->totalImages, "CnTextureAtlas is full.");
+	CN_ASSERT(subImageId < ta->totalImages, "SubImage %" PRIu32 " is outside of "
+		"range of texture atlas: %" PRIu32, subImageId, ta->totalImages);
 
 	// Find the (row, col) of the image within the texture atlas.
-	CnRowColu32 cell = cnTextureAtlas_SubImageGrid(ta, ta->usedImages);
+	CnRowColu32 cell = cnTextureAtlas_SubImageGrid(ta, subImageId);
 
 	// TODO: COMPLETE HACK TO GET IT TO WORK.
 	cell.row = ta->gridSize.height - cell.row - 1;
 
-//	CN_TRACE(LogSysMain, "Loading subimage: row %" PRIu32 " col %" PRIu32, cell.row, cell.col);
-
 	// The "real" offset within the image is the number of completed rows to get
 	// to the row, and the number of columns left to get there.
 	const uint32_t destStart = cell.row * ta->backingSizePixels.width * subImage->height + cell.col * subImage->width;
 
 	const uint32_t bytesPerPixel = 4; // RGBA
+	const uint32_t destEnd = destStart + (subImage->height - 1) * ta->backingSizePixels.width + subImage->width;
+	CN_ASSERT(bytesPerPixel * destEnd <= ta->image.pixels.size, "Writing off the edge of the image.");
+	CN_ASSERT(bytesPerPixel * subImage->width * subImage->height <= subImage->pixels.size,
+		"Reading off the edge of the image.");
+
+	// Destination rows cause offset shifts of the whole of the backing width.
+	const size_t rowSize = bytesPerPixel * subImage->width;
 	for (uint32_t y = 0; y < subImage->height; ++y) {
-		for (uint32_t x = 0; x < subImage->width; ++x) {
-//			CN_TRACE(LogSysMain, "Writing pixel (%" PRIu32 " , %" PRIu32 ")", x, y);
-			const uint32_t srcOffset = x + y * subImage->width;
+		const uint32_t srcOffset = y * subImage->width;
+		const uint32_t destOffset = destStart + y * ta->backingSizePixels.width;
+		memcpy(&ta->image.pixels.contents[bytesPerPixel * destOffset],
+			&subImage->pixels.contents[bytesPerPixel * srcOffset], rowSize);
+	}
+}
 
-			// Destination rows cause offset shifts of the whole of the backing width.
-			const uint32_t destOffset = destStart + x + y * ta->backingSizePixels.width;
+uint32_t cnTextureAtlas_Insert(CnTextureAtlas* ta, CnImageRGBA8* subImage)
+{
+	CN_ASSERT(subImage != NULL, "Cannot add a null image to a texture atlas.");
 
-			CN_ASSERT(bytesPerPixel * destOffset < ta->image.pixels.size, "Writing off the edge of the image.");
-			CN_ASSERT(bytesPerPixel * srcOffset < subImage->pixels.size, "Reading off the edge of the image.");
+	const uint32_t subImageId = cnTextureAtlas_Reserve(ta, 1);
+	cnTextureAtlas_Write(ta, subImageId, subImage);
+	return subImageId;
+}
 
-			uint32_t* dest = (uint32_t*)&ta->image.pixels.contents[bytesPerPixel*destOffset];
-			uint32_t* src = (uint32_t*)&subImage->pixels.contents[bytesPerPixel*srcOffset];
-			*dest = *src;
+/**
+ * Inserts several sub images into consecutive cells, returning the id of the
+ * first.  The cells are reserved together, so concurrent bulk inserts don't
+ * interleave.
+ */
+uint32_t cnTextureAtlas_InsertBulk(CnTextureAtlas* ta, const CnImageRGBA8* subImages, uint32_t numImages)
+{
+	CN_ASSERT(subImages != NULL, "Cannot add null images to a texture atlas.");
 
-			CN_ASSERT(*src == 0 || *src == 0xFFFFFFFF, "Unexpected subtexture value: %X", *src);
-		}
+	const uint32_t first = cnTextureAtlas_Reserve(ta, numImages);
+	for (uint32_t i = 0; i < numImages; ++i) {
+		cnTextureAtlas_Write(ta, first + i, &subImages[i]);
 	}
-	return ta->usedImages++;
+	return first;
 }
 
 void cnTextureAtlas_TexCoordForSubImage(CnTextureAtlas* ta, CnFloat2* output, uint32_t subImageId)
@@ -102,3 +148,21 @@ void cnTextureAtlas_TexCoordForSubImage(CnTextureAtlas* ta, CnFloat2* output, ui
 	output[2] = cnFloat2_Make(rowCol.col * dx, (rowCol.row + 1.0f) * dy);
 	output[3] = cnFloat2_Make((rowCol.col + 1.0f) * dx, (rowCol.row + 1.0f) * dy);
 }
+
+/**
+ * Provides a row of a sub image within the atlas, as it is laid out for upload
+ * with Y=0 as the bottom row.  Rows of the sub image are numbered from the top,
+ * so sub images can be written in place without flipping the atlas afterwards.
+ */
+uint32_t* cnTextureAtlas_FlippedSubImageRow(CnTextureAtlas* ta, uint32_t subImageId, uint32_t y)
+{
+	CN_ASSERT(ta != NULL, "Cannot get a row from a null texture atlas.");
+	CN_ASSERT(subImageId < ta->totalImages, "SubImage %" PRIu32 " is outside of "
+		"range of texture atlas: %" PRIu32, subImageId, ta->totalImages);
+	CN_ASSERT(y < ta->subImageSizePixels.height, "Row %" PRIu32 " is outside of the sub image.", y);
+
+	const CnRowColu32 cell = cnTextureAtlas_SubImageGrid(ta, subImageId);
+	const uint32_t pixelRow = cell.row * ta->subImageSizePixels.height + (ta->subImageSizePixels.height - y - 1);
+	const uint32_t offset = pixelRow * ta->backingSizePixels.width + cell.col * ta->subImageSizePixels.width;
+	return (uint32_t*)ta->image.pixels.contents + offset;
+}
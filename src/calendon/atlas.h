@@ -3,6 +3,7 @@
 
 #include <calendon/cn.h>
 
+#include <calendon/compat-sdl.h>
 #include <calendon/image.h>
 #include <calendon/math2.h>
 #include <calendon/row-col.h>
@@ -13,10 +14,14 @@ extern "C" {
 
 /**
  * A texture atlas which assumes that all images are the same size.
+ *
+ * Sub images are placed by reserving cells and then writing them.  Reserving
+ * is atomic, and writes to different cells touch separate pixels, so several
+ * threads may insert into the same atlas at once.
  */
 typedef struct {
 	CnImageRGBA8 image;
-	uint32_t usedImages;
+	SDL_atomic_t usedImages;
 	uint32_t totalImages;
 
 	/** The dimensions of each subimage making up the texture atlas. */
@@ -32,8 +37,13 @@ typedef struct {
 CN_TEST_API void        cnTextureAtlas_Allocate(CnTextureAtlas* ta, CnDimension2u32 subImageSize, uint32_t numImages);
 CN_TEST_API void        cnTextureAtlas_Free(CnTextureAtlas* ta);
 CN_TEST_API CnRowColu32 cnTextureAtlas_SubImageGrid(CnTextureAtlas* ta, uint32_t subImageId);
+CN_TEST_API uint32_t    cnTextureAtlas_Reserve(CnTextureAtlas* ta, uint32_t numImages);
+CN_TEST_API uint32_t    cnTextureAtlas_UsedImages(CnTextureAtlas* ta);
+CN_TEST_API void        cnTextureAtlas_Write(CnTextureAtlas* ta, uint32_t subImageId, const CnImageRGBA8* subImage);
 CN_TEST_API uint32_t    cnTextureAtlas_Insert(CnTextureAtlas* ta, CnImageRGBA8* subImage);
+CN_TEST_API uint32_t    cnTextureAtlas_InsertBulk(CnTextureAtlas* ta, const CnImageRGBA8* subImages, uint32_t numImages);
 CN_TEST_API void        cnTextureAtlas_TexCoordForSubImage(CnTextureAtlas* ta, CnFloat2* output, uint32_t subImageId);
+CN_TEST_API uint32_t*   cnTextureAtlas_FlippedSubImageRow(CnTextureAtlas* ta, uint32_t subImageId, uint32_t y);
 
 #ifdef __cplusplus
 }
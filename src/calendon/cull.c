@@ -0,0 +1,80 @@
+#include "cull.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define CN_CULL_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define CN_CULL_SSE2 0
+#endif
+
+/**
+ * Bounds are visible if they overlap the area by more than just touching an
+ * edge.  Bounds with NaN components are never visible.
+ */
+bool cnCull_IsVisible(CnAABB2 area, CnAABB2 bounds)
+{
+	return bounds.min.x < area.max.x
+		&& bounds.min.y < area.max.y
+		&& area.min.x < bounds.max.x
+		&& area.min.y < bounds.max.y;
+}
+
+#if CN_CULL_SSE2
+/**
+ * Tests one AABB per comparison.  Negating the max corner of the bounds and
+ * the min corner of the area turns all four tests into "less than", so bounds
+ * are visible when all four lanes of `(min, -max) < (area max, -area min)`
+ * are set.
+ */
+static uint32_t cnCull_AABB2sSSE2(CnAABB2 area, const CnAABB2* bounds, uint32_t numBounds, uint32_t* visible,
+	uint32_t* numVisible)
+{
+	CN_STATIC_ASSERT(sizeof(CnAABB2) == 4 * sizeof(float), "CnAABB2 must be four packed floats");
+
+	const __m128 negateMax = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, (int)0x80000000, 0, 0));
+	const __m128 limit = _mm_xor_ps(_mm_set_ps(area.min.y, area.min.x, area.max.y, area.max.x), negateMax);
+	const float* b = (const float*)bounds;
+
+	uint32_t count = *numVisible;
+	uint32_t i = 0;
+	for (; i + 2 <= numBounds; i += 2) {
+		const __m128 first = _mm_xor_ps(_mm_loadu_ps(b + 4 * i), negateMax);
+		const __m128 second = _mm_xor_ps(_mm_loadu_ps(b + 4 * i + 4), negateMax);
+		const int firstMask = _mm_movemask_ps(_mm_cmplt_ps(first, limit));
+		const int secondMask = _mm_movemask_ps(_mm_cmplt_ps(second, limit));
+
+		// Always write the index, but only advance past it when visible.
+		visible[count] = i;
+		count += (firstMask == 0xF);
+		visible[count] = i + 1;
+		count += (secondMask == 0xF);
+	}
+	*numVisible = count;
+	return i;
+}
+#endif
+
+/**
+ * Tests an array of bounds against an area, writing the indices of the
+ * visible bounds in order.
+ *
+ * @param visible space for `numBounds` indices
+ * @return the number of visible bounds
+ */
+uint32_t cnCull_AABB2s(CnAABB2 area, const CnAABB2* bounds, uint32_t numBounds, uint32_t* visible)
+{
+	CN_ASSERT(numBounds == 0 || bounds != NULL, "Cannot cull null bounds.");
+	CN_ASSERT(numBounds == 0 || visible != NULL, "Cannot write visible indices to a null pointer.");
+
+	uint32_t numVisible = 0;
+	uint32_t done = 0;
+#if CN_CULL_SSE2
+	done = cnCull_AABB2sSSE2(area, bounds, numBounds, visible, &numVisible);
+#endif
+	for (uint32_t i = done; i < numBounds; ++i) {
+		if (cnCull_IsVisible(area, bounds[i])) {
+			visible[numVisible++] = i;
+		}
+	}
+	return numVisible;
+}
@@ -0,0 +1,35 @@
+#ifndef CN_CULL_H
+#define CN_CULL_H
+
+/**
+ * @file cull.h
+ *
+ * Rejects things which can't be seen before they're drawn, by testing their
+ * bounds against the area the camera sees.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/math2.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Counts of bounds tested against the camera during a frame, and how many of
+ * those were rejected.
+ */
+typedef struct {
+	uint32_t tested;
+	uint32_t culled;
+} CnCullStats;
+
+CN_API bool     cnCull_IsVisible(CnAABB2 area, CnAABB2 bounds);
+CN_API uint32_t cnCull_AABB2s(CnAABB2 area, const CnAABB2* bounds, uint32_t numBounds, uint32_t* visible);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_CULL_H */
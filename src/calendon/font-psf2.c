@@ -2,11 +2,16 @@
 
 #include <calendon/cn.h>
 
+#include <calendon/assets.h>
+#include <calendon/assets-archive.h>
 #include <calendon/assets-fileio.h>
+#include <calendon/image-cache.h>
 #include <calendon/log.h>
 
 #include <string.h>
 
+extern CnLogHandle LogSysAssets;
+
 //https://www.win.tue.nl/~aeb/linux/kbd/font-formats-1.html
 static uint8_t psf2Magic[4] = { 0x72, 0xb5, 0x4a, 0x86 };
 
@@ -38,6 +43,34 @@ typedef struct {
 	uint32_t glyphWidth;
 } CnPSF2Header;
 
+/**
+ * Fonts are cached in the image cache after the atlas is built, as:
+ * - `CnPSF2CacheHeader`
+ * - `CnGraphemeMap`
+ * - the atlas pixels, flipped for upload
+ */
+static const uint8_t psf2CacheMagic[4] = { 'C', 'N', 'F', 'A' };
+
+#define PSF2_CACHE_VERSION 1
+
+typedef struct {
+	uint8_t magic[4];
+	uint32_t version;
+	uint32_t numGlyphs;
+	uint32_t glyphWidth;
+	uint32_t glyphHeight;
+
+	/** Detects changes to the layout of the grapheme map. */
+	uint32_t mapSize;
+
+	uint64_t nameHash;
+	uint64_t sourceSize;
+	uint64_t sourceModifiedTime;
+	uint8_t reserved[16];
+} CnPSF2CacheHeader;
+
+CN_STATIC_ASSERT(sizeof(CnPSF2CacheHeader) == 64, "Unexpected CnPSF2CacheHeader size");
+
 static void cnFont_PSF2PrintHeader(const CnPSF2Header *header)
 {
 	CN_TRACE(LogSysMain, "Version is %" PRIu32, header->version);
@@ -114,88 +147,86 @@ static void cnFont_PSF2ReadUnicodeTableIntoGlyphMap(CnGraphemeMap* map,
 		PRIiPTR, (intptr_t)(unicodeTableEnd - cursor));
 }
 
+/**
+ * Pixels for each bit of every possible bitmap byte, most significant bit
+ * first, so a byte of glyph bitmap expands with a single 32 byte copy.
+ */
+#define CN_PSF2_BIT(byte, bit) ((((byte) >> (bit)) & 1) ? 0xFFFFFFFFu : 0u)
+#define CN_PSF2_BYTE(b) { CN_PSF2_BIT(b, 7), CN_PSF2_BIT(b, 6), CN_PSF2_BIT(b, 5), CN_PSF2_BIT(b, 4), \
+	CN_PSF2_BIT(b, 3), CN_PSF2_BIT(b, 2), CN_PSF2_BIT(b, 1), CN_PSF2_BIT(b, 0) }
+#define CN_PSF2_BYTES_4(b) CN_PSF2_BYTE(b), CN_PSF2_BYTE((b) + 1), CN_PSF2_BYTE((b) + 2), CN_PSF2_BYTE((b) + 3)
+#define CN_PSF2_BYTES_16(b) CN_PSF2_BYTES_4(b), CN_PSF2_BYTES_4((b) + 4), CN_PSF2_BYTES_4((b) + 8), \
+	CN_PSF2_BYTES_4((b) + 12)
+#define CN_PSF2_BYTES_64(b) CN_PSF2_BYTES_16(b), CN_PSF2_BYTES_16((b) + 16), CN_PSF2_BYTES_16((b) + 32), \
+	CN_PSF2_BYTES_16((b) + 48)
+
+static const uint32_t psf2ExpandedBytes[256][8] = {
+	CN_PSF2_BYTES_64(0), CN_PSF2_BYTES_64(64), CN_PSF2_BYTES_64(128), CN_PSF2_BYTES_64(192)
+};
+
+/**
+ * Expands glyphs directly into the atlas, already flipped for upload.
+ */
 static void cnFont_PSF2ReadAndAllocateTextureAtlas(const CnPSF2Header* header, CnTextureAtlas* atlas)
 {
 	CN_ASSERT(header != NULL, "Cannot read a null CnPSF2Header.");
 	CN_ASSERT(atlas != NULL, "Cannot read a PSF2 header into a null texture texture.");
 
-	const uint8_t* bitmapCursor = (uint8_t*)header + header->bitmapOffset;
-
 	const CnDimension2u32 glyphSize = {
 		.width = header->glyphWidth,
 		.height = header->glyphHeight };
 
 	cnTextureAtlas_Allocate(atlas, glyphSize, header->numGlyphs);
-	memset(atlas->image.pixels.contents, 0, atlas->image.pixels.size);
 
-	CnImageRGBA8 glyphImage;
-	cnImageRGBA8_AllocateSized(&glyphImage, glyphSize);
-	uint32_t* imageCursor = (uint32_t*)glyphImage.pixels.contents;
-	const uint32_t* const imageEnd = (uint32_t*)((uint8_t*)imageCursor + glyphImage.pixels.size);
+	// Cells past the last glyph are never written.
+	memset(atlas->image.pixels.contents, 0, atlas->image.pixels.size);
 
 	// The bitmap for a glyph is stored as height consecutive pixel rows,
 	// where each pixel row consists of width bits followed by some filler
 	// bits in order to fill an integral number of (8-bit) bytes.
-	//
-	// Parse all characters.
+	const uint32_t bytesPerRow = header->glyphWidth / 8;
+	cnTextureAtlas_Reserve(atlas, header->numGlyphs);
 	for (uint32_t i = 0; i < header->numGlyphs; ++i) {
-		imageCursor = (uint32_t*)glyphImage.pixels.contents;
-		memset(imageCursor, 0, glyphImage.pixels.size);
-
-		// Parse all rows of the next character.
+		const uint8_t* bitmapCursor = (const uint8_t*)header + header->bitmapOffset + i * header->bytesPerGlyph;
 		for (uint32_t row = 0; row < header->glyphHeight; ++row) {
-			// Parse the next row.
-			for (uint32_t col = 0; col < (header->glyphWidth / 8); ++col) {
-				const uint8_t nextByte = *bitmapCursor;
-				for (int32_t bit = 7; bit >= 0; --bit) {
-					if ((1 << bit) & nextByte) {
-						//printf("X");
-						// Set all the bits to 1.
-						*imageCursor = (uint32_t)~0;
-					}
-					else {
-						//printf(" ");
-					}
-					++imageCursor;
-				}
+			uint32_t* pixels = cnTextureAtlas_FlippedSubImageRow(atlas, i, row);
+			for (uint32_t col = 0; col < bytesPerRow; ++col) {
+				memcpy(pixels, psf2ExpandedBytes[*bitmapCursor], sizeof(psf2ExpandedBytes[0]));
+				pixels += 8;
 				++bitmapCursor;
-				//printf("_");
 			}
-			//printf("\n");
 		}
-
-		CN_ASSERT(imageCursor == imageEnd, "Didn't count every pixel");
-
-		cnTextureAtlas_Insert(atlas, &glyphImage);
 	}
-	cnImageRGBA8_Free(&glyphImage);
 }
 
 /**
- * Creates the suitable elements needed to display a font.  This includes maps
- * for determining which glyphs to use, and the appropriate texture with which
- * to draw the font.
- *
- * Font loading resolves many questions related to the font:
- * - Which characters are supported by the font?
- * - Which glyphs should be drawn by a given string?
- * - How many glyphs are in a string?
- * - What is the width and height of a given string?
+ * Builds the atlas and grapheme map for a font from its file, without using
+ * the cache.
  */
-bool cnFont_PSF2Allocate(CnFontPSF2* font, const char* path)
+bool cnFont_PSF2Build(CnFontPSF2* font, const char* path)
 {
-	CnDynamicBuffer fileBuffer;
-	if (!cnAssets_ReadFile(path, CnFileTypeBinary, &fileBuffer)) {
+	// The font file is only read while building the atlas and grapheme map.
+	CnFileView fileView;
+	if (!cnAssets_MapFile(path, &fileView)) {
 		CN_FATAL_ERROR("Unable to load font from %s", path);
+		return false;
+	}
+
+	if (fileView.size < sizeof(CnPSF2Header)) {
+		CN_ERROR(LogSysMain, "Font is too small to be a PSF2 font: %s", path);
+		cnAssets_UnmapFile(&fileView);
+		return false;
 	}
 
-	const CnPSF2Header* const header = (CnPSF2Header*)fileBuffer.contents;
+	const CnPSF2Header* const header = (const CnPSF2Header*)fileView.contents;
 
 	// Check magic bytes to ensure that it's the correct file format.
-	if (memcpy(psf2Magic, header->magic, 4) == 0) {
+	if (memcmp(psf2Magic, header->magic, 4) != 0) {
 		CN_ERROR(LogSysMain, "Bad Magic Found: %x %x %x %x Expected: %x %x %x %x",
 			header->magic[0], header->magic[1], header->magic[2], header->magic[3],
 			psf2Magic[0], psf2Magic[1], psf2Magic[2], psf2Magic[3]);
+		cnAssets_UnmapFile(&fileView);
+		return false;
 	}
 	cnFont_PSF2PrintHeader(header);
 
@@ -216,14 +247,156 @@ bool cnFont_PSF2Allocate(CnFontPSF2* font, const char* path)
 		// If there is no unicode table, there is no way to determine which
 		// glypheme maps to which glyph.
 		CN_TRACE(LogSysMain, "No unicode table");
+		cnTextureAtlas_Free(&font->atlas);
+		cnAssets_UnmapFile(&fileView);
 		return false;
 	}
-	const uint8_t* const bitmapStart = (uint8_t*)header + header->bitmapOffset;
+	const uint8_t* const bitmapStart = (const uint8_t*)header + header->bitmapOffset;
 	const uint32_t bitmapSize = header->bytesPerGlyph * header->numGlyphs;
 	const uint8_t* const unicodeTableStart = bitmapStart + bitmapSize;
-	const uint8_t* const unicodeTableEnd = (uint8_t*)fileBuffer.contents + fileBuffer.size;
+	const uint8_t* const unicodeTableEnd = fileView.contents + fileView.size;
 	cnFont_PSF2ReadUnicodeTableIntoGlyphMap(&font->map, unicodeTableStart, unicodeTableEnd);
-	cnDynamicBuffer_Free(&fileBuffer);
+	cnAssets_UnmapFile(&fileView);
+	return true;
+}
+
+/**
+ * Fills a font from its cache entry, if the cache has an entry which is up to
+ * date with the font file.
+ */
+bool cnFont_PSF2LoadCached(CnFontPSF2* font, const char* name, const char* path)
+{
+	CN_ASSERT_PTR(font);
+	CN_ASSERT_PTR(name);
+	CN_ASSERT_PTR(path);
+
+	uint64_t sourceSize, sourceModifiedTime;
+	if (!cnImageCache_IsOpen() || !cnAssets_FileStamp(path, &sourceSize, &sourceModifiedTime)) {
+		return false;
+	}
+
+	const uint64_t nameHash = cnArchive_HashName(name);
+	CnPathBuffer cachePath;
+	if (!cnImageCache_EntryPath(nameHash, "psf2atlas", &cachePath) || !cnPathBuffer_IsFile(&cachePath)) {
+		return false;
+	}
+
+	CnFileView file;
+	if (!cnAssets_MapFile(cachePath.str, &file)) {
+		return false;
+	}
+
+	const CnPSF2CacheHeader* header = (const CnPSF2CacheHeader*)file.contents;
+	bool valid = file.size >= sizeof(CnPSF2CacheHeader)
+		&& memcmp(header->magic, psf2CacheMagic, sizeof(psf2CacheMagic)) == 0
+		&& header->version == PSF2_CACHE_VERSION
+		&& header->mapSize == sizeof(CnGraphemeMap)
+		&& header->nameHash == nameHash
+		&& header->sourceSize == sourceSize
+		&& header->sourceModifiedTime == sourceModifiedTime
+		&& header->numGlyphs > 0 && header->glyphWidth > 0 && header->glyphHeight > 0;
+
+	if (valid) {
+		font->glyphSize.width = header->glyphWidth;
+		font->glyphSize.height = header->glyphHeight;
+		cnTextureAtlas_Allocate(&font->atlas, font->glyphSize, header->numGlyphs);
+
+		const uint8_t* map = file.contents + sizeof(CnPSF2CacheHeader);
+		const uint8_t* pixels = map + sizeof(CnGraphemeMap);
+		valid = (uint64_t)file.size == sizeof(CnPSF2CacheHeader) + sizeof(CnGraphemeMap)
+			+ (uint64_t)font->atlas.image.pixels.size;
+		if (valid) {
+			memcpy(&font->map, map, sizeof(CnGraphemeMap));
+			memcpy(font->atlas.image.pixels.contents, pixels, font->atlas.image.pixels.size);
+			cnTextureAtlas_Reserve(&font->atlas, header->numGlyphs);
+		}
+		else {
+			cnTextureAtlas_Free(&font->atlas);
+		}
+	}
+
+	if (!valid) {
+		CN_TRACE(LogSysAssets, "Stale font cache entry for %s", name);
+	}
+	cnAssets_UnmapFile(&file);
+	return valid;
+}
+
+/**
+ * Writes a built font to the cache, replacing any existing entry.
+ */
+bool cnFont_PSF2StoreCached(const CnFontPSF2* font, const char* name, const char* path)
+{
+	CN_ASSERT_PTR(font);
+	CN_ASSERT_PTR(name);
+	CN_ASSERT_PTR(path);
+
+	if (!cnImageCache_IsOpen()) {
+		return false;
+	}
+
+	CnPSF2CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, psf2CacheMagic, sizeof(header.magic));
+	header.version = PSF2_CACHE_VERSION;
+	header.numGlyphs = font->atlas.totalImages;
+	header.glyphWidth = font->glyphSize.width;
+	header.glyphHeight = font->glyphSize.height;
+	header.mapSize = sizeof(CnGraphemeMap);
+	header.nameHash = cnArchive_HashName(name);
+	if (!cnAssets_FileStamp(path, &header.sourceSize, &header.sourceModifiedTime)) {
+		return false;
+	}
+
+	CnPathBuffer cachePath;
+	if (!cnImageCache_EntryPath(header.nameHash, "psf2atlas", &cachePath)) {
+		return false;
+	}
+
+	const void* parts[3] = { &header, &font->map, font->atlas.image.pixels.contents };
+	const size_t sizes[3] = { sizeof(header), sizeof(CnGraphemeMap), font->atlas.image.pixels.size };
+	if (!cnImageCache_WriteEntry(&cachePath, parts, sizes, 3)) {
+		return false;
+	}
+
+	CN_TRACE(LogSysAssets, "Cached %s as %s", name, cachePath.str);
+	return true;
+}
+
+/**
+ * Creates the suitable elements needed to display a font.  This includes maps
+ * for determining which glyphs to use, and the appropriate texture with which
+ * to draw the font.  The atlas is flipped, ready for upload.
+ *
+ * Font loading resolves many questions related to the font:
+ * - Which characters are supported by the font?
+ * - Which glyphs should be drawn by a given string?
+ * - How many glyphs are in a string?
+ * - What is the width and height of a given string?
+ *
+ * Built fonts are cached, so later loads skip building the atlas.
+ */
+bool cnFont_PSF2Allocate(CnFontPSF2* font, const char* path)
+{
+	CN_ASSERT_PTR(font);
+	CN_ASSERT_PTR(path);
+
+	const char* name = cnAssets_NameForPath(path);
+	if (!name) {
+		name = path;
+	}
+
+	if (cnFont_PSF2LoadCached(font, name, path)) {
+		return true;
+	}
+
+	if (!cnFont_PSF2Build(font, path)) {
+		return false;
+	}
+
+	if (cnImageCache_IsOpen()) {
+		cnFont_PSF2StoreCached(font, name, path);
+	}
 	return true;
 }
 
@@ -29,6 +29,10 @@ typedef struct {
 CN_API bool cnFont_PSF2Allocate(CnFontPSF2* font, const char* path);
 CN_API void cnFont_PSF2Free(CnFontPSF2* font);
 
+CN_API bool cnFont_PSF2Build(CnFontPSF2* font, const char* path);
+CN_API bool cnFont_PSF2LoadCached(CnFontPSF2* font, const char* name, const char* path);
+CN_API bool cnFont_PSF2StoreCached(const CnFontPSF2* font, const char* name, const char* path);
+
 #ifdef __cplusplus
 }
 #endif
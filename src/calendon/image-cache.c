@@ -0,0 +1,359 @@
+#include "image-cache.h"
+
+#include <calendon/assets.h>
+#include <calendon/assets-archive.h>
+#include <calendon/compat-sdl.h>
+#include <calendon/log.h>
+#include <calendon/path.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+	#include <direct.h>
+#endif
+
+extern CnLogHandle LogSysAssets;
+
+static const uint8_t cnImageCache_Magic[4] = { 'C', 'N', 'I', 'C' };
+
+static bool imageCacheOpen = false;
+static CnPathBuffer imageCacheDir;
+
+/**
+ * Load stats, updated from whichever threads are loading images.  Times
+ * would overflow an int after about half an hour of loading, so are kept as
+ * 64-bit totals behind a spin lock.
+ */
+static SDL_atomic_t imageCacheHits;
+static SDL_atomic_t imageCacheMisses;
+static SDL_SpinLock imageTimesLock;
+static uint64_t imageDecodeMicros;
+static uint64_t imageMipMicros;
+
+static void cnImageCache_AddTime(uint64_t* total, uint64_t micros)
+{
+	SDL_AtomicLock(&imageTimesLock);
+	*total += micros;
+	SDL_AtomicUnlock(&imageTimesLock);
+}
+
+/**
+ * Starts caching decoded images in the given directory, creating it if it
+ * doesn't already exist.
+ */
+bool cnImageCache_Open(const char* directory)
+{
+	CN_ASSERT_PTR(directory);
+
+	if (!cnPath_IsDir(directory)) {
+#ifdef _WIN32
+		const int result = _mkdir(directory);
+#else
+		const int result = mkdir(directory, 0755);
+#endif
+		if (result != 0) {
+			return false;
+		}
+	}
+
+	if (!cnPathBuffer_Set(&imageCacheDir, directory)) {
+		return false;
+	}
+	imageCacheOpen = true;
+	return true;
+}
+
+void cnImageCache_Close(void)
+{
+	CnImageLoadStats stats;
+	cnImageCache_LoadStats(&stats);
+	CN_TRACE(LogSysAssets, "Image loads: %" PRIu32 " cache hits, %" PRIu32 " misses, %" PRIu64 " us decoding, "
+		"%" PRIu64 " us building mips", stats.cacheHits, stats.cacheMisses, stats.decodeMicros, stats.mipMicros);
+
+	imageCacheOpen = false;
+	cnPathBuffer_Clear(&imageCacheDir);
+}
+
+bool cnImageCache_IsOpen(void)
+{
+	return imageCacheOpen;
+}
+
+/**
+ * Provides the path of a cache file for an asset.  Other decoded assets, such
+ * as font atlases, are cached alongside images with their own extension.
+ */
+bool cnImageCache_EntryPath(uint64_t nameHash, const char* extension, CnPathBuffer* path)
+{
+	CN_ASSERT_PTR(extension);
+	CN_ASSERT_PTR(path);
+
+	if (!imageCacheOpen) {
+		return false;
+	}
+
+	char fileName[32];
+	if (snprintf(fileName, sizeof(fileName), "%016" PRIx64 ".%s", nameHash, extension) >= (int)sizeof(fileName)) {
+		return false;
+	}
+
+	*path = imageCacheDir;
+	return cnPathBuffer_Join(path, fileName);
+}
+
+/**
+ * Maps the cached pixels for an image, if the cache has an entry which is up
+ * to date with the source image.
+ *
+ * @param name the asset name of the image, which identifies the cache entry
+ * @param sourcePath the source image file, used to detect stale entries
+ * @return true if `image` has been filled from the cache
+ */
+bool cnImageCache_Map(CnCachedImage* image, const char* name, const char* sourcePath)
+{
+	CN_ASSERT_PTR(image);
+	CN_ASSERT_PTR(name);
+	CN_ASSERT_PTR(sourcePath);
+
+	if (!imageCacheOpen) {
+		return false;
+	}
+
+	uint64_t sourceSize, sourceModifiedTime;
+	if (!cnAssets_FileStamp(sourcePath, &sourceSize, &sourceModifiedTime)) {
+		return false;
+	}
+
+	const uint64_t nameHash = cnArchive_HashName(name);
+	CnPathBuffer cachePath;
+	if (!cnImageCache_EntryPath(nameHash, "rgba8", &cachePath) || !cnPathBuffer_IsFile(&cachePath)) {
+		return false;
+	}
+
+	CnFileView file;
+	if (!cnAssets_MapFile(cachePath.str, &file)) {
+		return false;
+	}
+
+	const CnImageCacheHeader* header = (const CnImageCacheHeader*)file.contents;
+	bool valid = file.size >= sizeof(CnImageCacheHeader)
+		&& memcmp(header->magic, cnImageCache_Magic, sizeof(cnImageCache_Magic)) == 0
+		&& header->version == CN_IMAGE_CACHE_VERSION
+		&& header->nameHash == nameHash
+		&& header->sourceSize == sourceSize
+		&& header->sourceModifiedTime == sourceModifiedTime
+		&& header->width > 0 && header->height > 0 && header->numLevels > 0;
+
+	const CnDimension2u32 size = valid ? (CnDimension2u32) { header->width, header->height } : (CnDimension2u32) { 1, 1 };
+	valid = valid
+		&& header->numLevels <= cnImageMips_NumLevels(size)
+		&& (uint64_t)file.size == sizeof(CnImageCacheHeader) + 4 * (uint64_t)header->width * header->height
+			+ cnImageMips_TailSize(size, header->numLevels);
+	if (!valid) {
+		CN_TRACE(LogSysAssets, "Stale image cache entry for %s", name);
+		cnAssets_UnmapFile(&file);
+		return false;
+	}
+
+	memset(&image->decoded, 0, sizeof(CnImageRGBA8));
+	memset(&image->builtMips, 0, sizeof(CnDynamicBuffer));
+	image->file = file;
+	image->pixels = file.contents + sizeof(CnImageCacheHeader);
+	image->width = header->width;
+	image->height = header->height;
+	image->numLevels = header->numLevels;
+	image->mips = header->numLevels > 1 ? image->pixels + 4 * (size_t)header->width * header->height : NULL;
+	return true;
+}
+
+/**
+ * Writes the parts of a cache entry one after another, replacing any existing
+ * entry.
+ */
+bool cnImageCache_WriteEntry(const CnPathBuffer* path, const void* const* parts, const size_t* sizes,
+	uint32_t numParts)
+{
+	CN_ASSERT_PTR(path);
+	CN_ASSERT_PTR(parts);
+	CN_ASSERT_PTR(sizes);
+
+	// Entries may be cached from several loading threads at once.
+	char tempPath[CN_MAX_TERMINATED_PATH];
+	if (snprintf(tempPath, sizeof(tempPath), "%s.%lu.tmp", path->str,
+		(unsigned long)SDL_ThreadID()) >= (int)sizeof(tempPath))
+	{
+		return false;
+	}
+
+	// Write to a temporary file and move it into place, so a partially written
+	// entry is never mapped.
+	FILE* file = fopen(tempPath, "wb");
+	if (!file) {
+		CN_WARN(LogSysAssets, "Unable to write cache entry: %s", tempPath);
+		return false;
+	}
+
+	bool written = true;
+	for (uint32_t i = 0; written && i < numParts; ++i) {
+		written = sizes[i] == 0 || fwrite(parts[i], 1, sizes[i], file) == sizes[i];
+	}
+	fclose(file);
+
+	remove(path->str);
+	if (!written || rename(tempPath, path->str) != 0) {
+		CN_WARN(LogSysAssets, "Unable to write cache entry: %s", path->str);
+		remove(tempPath);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Writes a decoded image to the cache, replacing any existing entry.
+ *
+ * @param mips the tail of the image's mip chain, or NULL if `numLevels` is 1
+ */
+bool cnImageCache_Store(const CnImageRGBA8* image, const uint8_t* mips, uint32_t numLevels,
+	const char* name, const char* sourcePath)
+{
+	CN_ASSERT_PTR(image);
+	CN_ASSERT(numLevels > 0, "Images have at least one level.");
+	CN_ASSERT(numLevels == 1 || mips != NULL, "Missing mips for %" PRIu32 " levels.", numLevels);
+	CN_ASSERT_PTR(name);
+	CN_ASSERT_PTR(sourcePath);
+
+	if (!imageCacheOpen) {
+		return false;
+	}
+
+	CnImageCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, cnImageCache_Magic, sizeof(header.magic));
+	header.version = CN_IMAGE_CACHE_VERSION;
+	header.width = image->width;
+	header.height = image->height;
+	header.numLevels = numLevels;
+	header.nameHash = cnArchive_HashName(name);
+	if (!cnAssets_FileStamp(sourcePath, &header.sourceSize, &header.sourceModifiedTime)) {
+		return false;
+	}
+
+	CnPathBuffer cachePath;
+	if (!cnImageCache_EntryPath(header.nameHash, "rgba8", &cachePath)) {
+		return false;
+	}
+	const CnDimension2u32 size = { image->width, image->height };
+	const void* parts[3] = { &header, image->pixels.contents, mips };
+	const size_t sizes[3] = { sizeof(header), 4 * (size_t)image->width * image->height,
+		cnImageMips_TailSize(size, numLevels) };
+	if (!cnImageCache_WriteEntry(&cachePath, parts, sizes, 3)) {
+		return false;
+	}
+
+	CN_TRACE(LogSysAssets, "Cached %s as %s", name, cachePath.str);
+	return true;
+}
+
+static uint64_t cnImageCache_MicrosSince(uint64_t start)
+{
+	return (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Provides the pixels for an image asset, from the cache if possible.  On a
+ * cache miss the image is decoded and written to the cache for next time.
+ *
+ * @param withMips build a full mip chain if the cache doesn't have one
+ */
+bool cnImageCache_Load(CnCachedImage* image, const char* sourcePath, bool withMips)
+{
+	CN_ASSERT_PTR(image);
+	CN_ASSERT_PTR(sourcePath);
+
+	const char* name = cnAssets_NameForPath(sourcePath);
+	if (!name) {
+		name = sourcePath;
+	}
+
+	if (cnImageCache_Map(image, name, sourcePath)) {
+		const CnDimension2u32 size = { image->width, image->height };
+		if (!withMips || image->numLevels == cnImageMips_NumLevels(size)) {
+			SDL_AtomicIncRef(&imageCacheHits);
+			return true;
+		}
+		cnImageCache_Release(image);
+	}
+	SDL_AtomicIncRef(&imageCacheMisses);
+
+	memset(&image->file, 0, sizeof(CnFileView));
+	memset(&image->builtMips, 0, sizeof(CnDynamicBuffer));
+
+	const uint64_t decodeStart = SDL_GetPerformanceCounter();
+	if (!cnImageRGBA8_Allocate(&image->decoded, sourcePath)) {
+		return false;
+	}
+	const uint64_t decodeMicros = cnImageCache_MicrosSince(decodeStart);
+	cnImageCache_AddTime(&imageDecodeMicros, decodeMicros);
+
+	image->pixels = (const uint8_t*)image->decoded.pixels.contents;
+	image->width = image->decoded.width;
+	image->height = image->decoded.height;
+	image->numLevels = 1;
+	image->mips = NULL;
+
+	uint64_t mipMicros = 0;
+	if (withMips) {
+		const CnDimension2u32 size = { image->width, image->height };
+		const uint32_t numLevels = cnImageMips_NumLevels(size);
+		if (numLevels > 1) {
+			const uint64_t mipStart = SDL_GetPerformanceCounter();
+			cnDynamicBuffer_Allocate(&image->builtMips, cnImageMips_TailSize(size, numLevels));
+			cnImageMips_Build((uint8_t*)image->builtMips.contents, image->pixels, size, numLevels);
+			image->mips = (const uint8_t*)image->builtMips.contents;
+			image->numLevels = numLevels;
+			mipMicros = cnImageCache_MicrosSince(mipStart);
+			cnImageCache_AddTime(&imageMipMicros, mipMicros);
+		}
+	}
+	CN_TRACE(LogSysAssets, "Loaded %s: decode %" PRIu64 " us, mips %" PRIu64 " us", name,
+		decodeMicros, mipMicros);
+
+	if (imageCacheOpen) {
+		cnImageCache_Store(&image->decoded, image->mips, image->numLevels, name, sourcePath);
+	}
+	return true;
+}
+
+void cnImageCache_Release(CnCachedImage* image)
+{
+	CN_ASSERT_PTR(image);
+
+	if (image->file.contents) {
+		cnAssets_UnmapFile(&image->file);
+	}
+	else {
+		cnImageRGBA8_Free(&image->decoded);
+	}
+	if (image->builtMips.contents) {
+		cnDynamicBuffer_Free(&image->builtMips);
+	}
+	image->pixels = NULL;
+	image->mips = NULL;
+	image->width = 0;
+	image->height = 0;
+	image->numLevels = 0;
+}
+
+void cnImageCache_LoadStats(CnImageLoadStats* stats)
+{
+	CN_ASSERT_PTR(stats);
+
+	stats->cacheHits = (uint32_t)SDL_AtomicGet(&imageCacheHits);
+	stats->cacheMisses = (uint32_t)SDL_AtomicGet(&imageCacheMisses);
+	SDL_AtomicLock(&imageTimesLock);
+	stats->decodeMicros = imageDecodeMicros;
+	stats->mipMicros = imageMipMicros;
+	SDL_AtomicUnlock(&imageTimesLock);
+}
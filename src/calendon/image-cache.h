@@ -0,0 +1,103 @@
+#ifndef CN_IMAGE_CACHE_H
+#define CN_IMAGE_CACHE_H
+
+/**
+ * @file image-cache.h
+ *
+ * Decoding PNGs dominates image load times, so decoded images are cached on
+ * disk as raw, already flipped RGBA8 which is memory mapped and uploaded as-is
+ * on later loads.
+ *
+ * Each cached image is a single file in the cache directory, named by the hash
+ * of its asset name:
+ * - `CnImageCacheHeader`
+ * - `width * height` RGBA8 pixels, with Y=0 as the bottom row
+ * - the tail of the mip chain, if the entry has more than one level
+ *
+ * Entries are keyed by the size and modification time of the source, and are
+ * replaced when the source changes.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/assets-fileio.h>
+#include <calendon/image.h>
+#include <calendon/image-mips.h>
+#include <calendon/path.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CN_IMAGE_CACHE_VERSION 2
+
+typedef struct {
+	uint8_t magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint64_t nameHash;
+	uint64_t sourceSize;
+	uint64_t sourceModifiedTime;
+
+	/** Mip levels stored, including the full size image. */
+	uint32_t numLevels;
+
+	/** Pads the header so pixels start 64 byte aligned in the mapping. */
+	uint8_t reserved[20];
+} CnImageCacheHeader;
+
+CN_STATIC_ASSERT(sizeof(CnImageCacheHeader) == 64, "Unexpected CnImageCacheHeader size");
+
+/**
+ * Pixels of an image either mapped from the cache, or decoded from the source
+ * image if it wasn't cached.  Release with `cnImageCache_Release`.
+ */
+typedef struct {
+	/** RGBA8 pixels, with Y=0 as the bottom row. */
+	const uint8_t* pixels;
+	uint32_t width, height;
+
+	/** Mip levels available, including the full size image. */
+	uint32_t numLevels;
+
+	/** The tail of the mip chain, when there is more than one level. */
+	const uint8_t* mips;
+
+	/** The cache mapping, when the pixels came from the cache. */
+	CnFileView file;
+
+	/** The decoded image and its mips, when the pixels were not cached. */
+	CnImageRGBA8 decoded;
+	CnDynamicBuffer builtMips;
+} CnCachedImage;
+
+/**
+ * Totals for images loaded through the cache, to show where load time goes.
+ */
+typedef struct {
+	uint32_t cacheHits;
+	uint32_t cacheMisses;
+	uint64_t decodeMicros;
+	uint64_t mipMicros;
+} CnImageLoadStats;
+
+CN_API bool cnImageCache_Open(const char* directory);
+CN_API void cnImageCache_Close(void);
+CN_API bool cnImageCache_IsOpen(void);
+CN_API bool cnImageCache_EntryPath(uint64_t nameHash, const char* extension, CnPathBuffer* path);
+CN_API bool cnImageCache_WriteEntry(const CnPathBuffer* path, const void* const* parts, const size_t* sizes,
+	uint32_t numParts);
+
+CN_API bool cnImageCache_Map(CnCachedImage* image, const char* name, const char* sourcePath);
+CN_API bool cnImageCache_Store(const CnImageRGBA8* image, const uint8_t* mips, uint32_t numLevels,
+	const char* name, const char* sourcePath);
+CN_API bool cnImageCache_Load(CnCachedImage* image, const char* sourcePath, bool withMips);
+CN_API void cnImageCache_Release(CnCachedImage* image);
+CN_API void cnImageCache_LoadStats(CnImageLoadStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_IMAGE_CACHE_H */
@@ -0,0 +1,725 @@
+#include "image-kernels.h"
+
+#include <calendon/compat-sdl.h>
+#include <calendon/memory.h>
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define CN_IMAGE_KERNELS_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define CN_IMAGE_KERNELS_SSE2 0
+#endif
+
+/*
+ * AVX2 kernels are compiled for the AVX2 target individually, so the rest of
+ * the library still runs on CPUs without AVX2.
+ */
+#if CN_IMAGE_KERNELS_SSE2 && (defined(__GNUC__) || defined(_MSC_VER))
+	#define CN_IMAGE_KERNELS_AVX2 1
+	#include <immintrin.h>
+	#ifdef __GNUC__
+		#define CN_TARGET_AVX2 __attribute__((target("avx2")))
+	#else
+		#define CN_TARGET_AVX2
+	#endif
+#else
+	#define CN_IMAGE_KERNELS_AVX2 0
+#endif
+
+static CnImageKernelLevel imageKernelsMaxLevel = CnImageKernelLevelAVX2;
+
+/**
+ * The most capable kernels supported by both the build and the CPU.
+ */
+CnImageKernelLevel cnImageKernels_Level(void)
+{
+	CnImageKernelLevel level = CnImageKernelLevelScalar;
+#if CN_IMAGE_KERNELS_SSE2
+	if (SDL_HasSSE2()) {
+		level = CnImageKernelLevelSSE2;
+	}
+#endif
+#if CN_IMAGE_KERNELS_AVX2
+	if (SDL_HasAVX2()) {
+		level = CnImageKernelLevelAVX2;
+	}
+#endif
+	return level < imageKernelsMaxLevel ? level : imageKernelsMaxLevel;
+}
+
+/**
+ * Limits the kernels used, to compare implementations.
+ */
+void cnImageKernels_SetMaxLevel(CnImageKernelLevel level)
+{
+	CN_ASSERT(level <= CnImageKernelLevelAVX2, "Unknown image kernel level: %i", (int)level);
+	imageKernelsMaxLevel = level;
+}
+
+static uint32_t cnImageKernels_PackRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	// Pack in memory order, regardless of endianness.
+	const uint8_t bytes[4] = { r, g, b, a };
+	uint32_t packed;
+	memcpy(&packed, bytes, sizeof(packed));
+	return packed;
+}
+
+/**
+ * Scales a channel by alpha, rounding exactly as `c * a / 255` would.
+ */
+static uint8_t cnImageKernels_MulAlpha(uint32_t c, uint32_t a)
+{
+	const uint32_t t = c * a + 128;
+	return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+//
+// Clear
+//
+static void cnImageKernels_FillScalar(uint32_t* pixels, uint32_t numPixels, uint32_t value)
+{
+	for (uint32_t i = 0; i < numPixels; ++i) {
+		pixels[i] = value;
+	}
+}
+
+#if CN_IMAGE_KERNELS_SSE2
+static uint32_t cnImageKernels_FillSSE2(uint32_t* pixels, uint32_t numPixels, uint32_t value)
+{
+	const __m128i fill = _mm_set1_epi32((int)value);
+	uint32_t i = 0;
+	for (; i + 4 <= numPixels; i += 4) {
+		_mm_storeu_si128((__m128i*)(pixels + i), fill);
+	}
+	return i;
+}
+#endif
+
+#if CN_IMAGE_KERNELS_AVX2
+CN_TARGET_AVX2
+static uint32_t cnImageKernels_FillAVX2(uint32_t* pixels, uint32_t numPixels, uint32_t value)
+{
+	const __m256i fill = _mm256_set1_epi32((int)value);
+	uint32_t i = 0;
+	for (; i + 8 <= numPixels; i += 8) {
+		_mm256_storeu_si256((__m256i*)(pixels + i), fill);
+	}
+	return i;
+}
+#endif
+
+void cnImageRGBA8_ClearRGBA(CnImageRGBA8* image, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	CN_ASSERT(image != NULL, "Cannot clear a null image.");
+
+	uint32_t* pixels = (uint32_t*)image->pixels.contents;
+	const uint32_t numPixels = image->pixels.size / 4;
+	const uint32_t value = cnImageKernels_PackRGBA(r, g, b, a);
+
+	uint32_t done = 0;
+	switch (cnImageKernels_Level()) {
+#if CN_IMAGE_KERNELS_AVX2
+		case CnImageKernelLevelAVX2:
+			done = cnImageKernels_FillAVX2(pixels, numPixels, value);
+			break;
+#endif
+#if CN_IMAGE_KERNELS_SSE2
+		case CnImageKernelLevelSSE2:
+			done = cnImageKernels_FillSSE2(pixels, numPixels, value);
+			break;
+#endif
+		default:
+			break;
+	}
+	cnImageKernels_FillScalar(pixels + done, numPixels - done, value);
+}
+
+//
+// Flip
+//
+static void cnImageKernels_SwapScalar(uint8_t* a, uint8_t* b, size_t size)
+{
+	for (size_t i = 0; i < size; ++i) {
+		const uint8_t temp = a[i];
+		a[i] = b[i];
+		b[i] = temp;
+	}
+}
+
+#if CN_IMAGE_KERNELS_SSE2
+static size_t cnImageKernels_SwapSSE2(uint8_t* a, uint8_t* b, size_t size)
+{
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		const __m128i fromA = _mm_loadu_si128((const __m128i*)(a + i));
+		const __m128i fromB = _mm_loadu_si128((const __m128i*)(b + i));
+		_mm_storeu_si128((__m128i*)(a + i), fromB);
+		_mm_storeu_si128((__m128i*)(b + i), fromA);
+	}
+	return i;
+}
+#endif
+
+#if CN_IMAGE_KERNELS_AVX2
+CN_TARGET_AVX2
+static size_t cnImageKernels_SwapAVX2(uint8_t* a, uint8_t* b, size_t size)
+{
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		const __m256i fromA = _mm256_loadu_si256((const __m256i*)(a + i));
+		const __m256i fromB = _mm256_loadu_si256((const __m256i*)(b + i));
+		_mm256_storeu_si256((__m256i*)(a + i), fromB);
+		_mm256_storeu_si256((__m256i*)(b + i), fromA);
+	}
+	return i;
+}
+#endif
+
+/**
+ * Flips an image vertically in place, by swapping rows from the top and
+ * bottom.
+ */
+void cnImageRGBA8_Flip(CnImageRGBA8* image)
+{
+	CN_ASSERT(image != NULL, "Cannot load flip a null image.");
+	CN_ASSERT(image->pixels.size > 0, "No pixels to flip.");
+	CN_ASSERT(image->width > 0, "Cannot flip an image with no width.");
+	CN_ASSERT(image->height > 0, "Cannot flip an image with no height.");
+
+	// Assume RGBA8 encoding.
+	const uint32_t pixelSize = 4 * sizeof(uint8_t);
+
+	const uint32_t expectedPixelStorageSize = pixelSize * image->width * image->height;
+	CN_ASSERT(expectedPixelStorageSize == image->pixels.size,
+		"Excessive storage for pixels found %" PRIu32 ", not matching resolution "
+		"%" PRIu32 "(%" PRIu32 ", %" PRIu32 ")", expectedPixelStorageSize,
+		image->pixels.size, image->width, image->height);
+
+	const uint32_t rowSize = pixelSize * image->width;
+	const CnImageKernelLevel level = cnImageKernels_Level();
+	for (uint32_t i = 0; i < image->height / 2; ++i) {
+		uint8_t* top = (uint8_t*)image->pixels.contents + rowSize * i;
+		uint8_t* bottom = (uint8_t*)image->pixels.contents + rowSize * (image->height - i - 1);
+
+		size_t done = 0;
+		switch (level) {
+#if CN_IMAGE_KERNELS_AVX2
+			case CnImageKernelLevelAVX2:
+				done = cnImageKernels_SwapAVX2(top, bottom, rowSize);
+				break;
+#endif
+#if CN_IMAGE_KERNELS_SSE2
+			case CnImageKernelLevelSSE2:
+				done = cnImageKernels_SwapSSE2(top, bottom, rowSize);
+				break;
+#endif
+			default:
+				break;
+		}
+		cnImageKernels_SwapScalar(top + done, bottom + done, rowSize - done);
+	}
+}
+
+//
+// Blit
+//
+
+/**
+ * Copies a rectangle of pixels between images.  Rows are contiguous, so each
+ * is a single `memcpy`, which is already vectorized.
+ */
+void cnImageRGBA8_Blit(CnImageRGBA8* dest, CnRowColu32 destPosition, const CnImageRGBA8* src,
+	CnRowColu32 srcPosition, CnDimension2u32 size)
+{
+	CN_ASSERT_PTR(dest);
+	CN_ASSERT_PTR(src);
+	CN_ASSERT(destPosition.col + size.width <= dest->width && destPosition.row + size.height <= dest->height,
+		"Blit writes outside of the destination image.");
+	CN_ASSERT(srcPosition.col + size.width <= src->width && srcPosition.row + size.height <= src->height,
+		"Blit reads outside of the source image.");
+
+	const size_t rowSize = 4 * (size_t)size.width;
+	for (uint32_t y = 0; y < size.height; ++y) {
+		uint8_t* to = (uint8_t*)dest->pixels.contents
+			+ 4 * ((size_t)(destPosition.row + y) * dest->width + destPosition.col);
+		const uint8_t* from = (const uint8_t*)src->pixels.contents
+			+ 4 * ((size_t)(srcPosition.row + y) * src->width + srcPosition.col);
+		memmove(to, from, rowSize);
+	}
+}
+
+//
+// Premultiply
+//
+static void cnImageKernels_PremultiplyScalar(uint8_t* pixels, uint32_t numPixels)
+{
+	for (uint32_t i = 0; i < numPixels; ++i) {
+		uint8_t* pixel = pixels + 4 * i;
+		const uint32_t alpha = pixel[3];
+		pixel[0] = cnImageKernels_MulAlpha(pixel[0], alpha);
+		pixel[1] = cnImageKernels_MulAlpha(pixel[1], alpha);
+		pixel[2] = cnImageKernels_MulAlpha(pixel[2], alpha);
+	}
+}
+
+#if CN_IMAGE_KERNELS_SSE2
+/**
+ * Scales two pixels widened to 16 bits by their alphas.  Alpha is scaled by
+ * 255, which leaves it unchanged.
+ */
+static __m128i cnImageKernels_PremultiplyWideSSE2(__m128i wide)
+{
+	const __m128i keepColor = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+	const __m128i opaque = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+	__m128i alpha = _mm_shufflelo_epi16(wide, _MM_SHUFFLE(3, 3, 3, 3));
+	alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+	alpha = _mm_or_si128(_mm_and_si128(alpha, keepColor), opaque);
+
+	const __m128i t = _mm_add_epi16(_mm_mullo_epi16(wide, alpha), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static uint32_t cnImageKernels_PremultiplySSE2(uint8_t* pixels, uint32_t numPixels)
+{
+	const __m128i zero = _mm_setzero_si128();
+	uint32_t i = 0;
+	for (; i + 4 <= numPixels; i += 4) {
+		const __m128i packed = _mm_loadu_si128((const __m128i*)(pixels + 4 * i));
+		const __m128i low = cnImageKernels_PremultiplyWideSSE2(_mm_unpacklo_epi8(packed, zero));
+		const __m128i high = cnImageKernels_PremultiplyWideSSE2(_mm_unpackhi_epi8(packed, zero));
+		_mm_storeu_si128((__m128i*)(pixels + 4 * i), _mm_packus_epi16(low, high));
+	}
+	return i;
+}
+#endif
+
+#if CN_IMAGE_KERNELS_AVX2
+CN_TARGET_AVX2
+static __m256i cnImageKernels_PremultiplyWideAVX2(__m256i wide)
+{
+	const __m256i keepColor = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+	const __m256i opaque = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+	__m256i alpha = _mm256_shufflelo_epi16(wide, _MM_SHUFFLE(3, 3, 3, 3));
+	alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+	alpha = _mm256_or_si256(_mm256_and_si256(alpha, keepColor), opaque);
+
+	const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(wide, alpha), _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+CN_TARGET_AVX2
+static uint32_t cnImageKernels_PremultiplyAVX2(uint8_t* pixels, uint32_t numPixels)
+{
+	// Unpacking and packing both work within 128-bit lanes, so pixels end up
+	// back where they started.
+	const __m256i zero = _mm256_setzero_si256();
+	uint32_t i = 0;
+	for (; i + 8 <= numPixels; i += 8) {
+		const __m256i packed = _mm256_loadu_si256((const __m256i*)(pixels + 4 * i));
+		const __m256i low = cnImageKernels_PremultiplyWideAVX2(_mm256_unpacklo_epi8(packed, zero));
+		const __m256i high = cnImageKernels_PremultiplyWideAVX2(_mm256_unpackhi_epi8(packed, zero));
+		_mm256_storeu_si256((__m256i*)(pixels + 4 * i), _mm256_packus_epi16(low, high));
+	}
+	return i;
+}
+#endif
+
+/**
+ * Multiplies color channels by alpha, for blending with premultiplied alpha.
+ */
+void cnImageRGBA8_Premultiply(CnImageRGBA8* image)
+{
+	CN_ASSERT_PTR(image);
+
+	uint8_t* pixels = (uint8_t*)image->pixels.contents;
+	const uint32_t numPixels = image->width * image->height;
+
+	uint32_t done = 0;
+	switch (cnImageKernels_Level()) {
+#if CN_IMAGE_KERNELS_AVX2
+		case CnImageKernelLevelAVX2:
+			done = cnImageKernels_PremultiplyAVX2(pixels, numPixels);
+			break;
+#endif
+#if CN_IMAGE_KERNELS_SSE2
+		case CnImageKernelLevelSSE2:
+			done = cnImageKernels_PremultiplySSE2(pixels, numPixels);
+			break;
+#endif
+		default:
+			break;
+	}
+	cnImageKernels_PremultiplyScalar(pixels + 4 * done, numPixels - done);
+}
+
+//
+// Swizzle
+//
+static void cnImageKernels_SwizzleScalar(uint8_t* pixels, uint32_t numPixels, const uint8_t order[4])
+{
+	for (uint32_t i = 0; i < numPixels; ++i) {
+		uint8_t* pixel = pixels + 4 * i;
+		const uint8_t original[4] = { pixel[0], pixel[1], pixel[2], pixel[3] };
+		pixel[0] = original[order[0]];
+		pixel[1] = original[order[1]];
+		pixel[2] = original[order[2]];
+		pixel[3] = original[order[3]];
+	}
+}
+
+#if CN_IMAGE_KERNELS_AVX2
+CN_TARGET_AVX2
+static uint32_t cnImageKernels_SwizzleAVX2(uint8_t* pixels, uint32_t numPixels, const uint8_t order[4])
+{
+	int8_t shuffle[32];
+	for (int8_t i = 0; i < 32; ++i) {
+		shuffle[i] = (int8_t)((i & ~3) + order[i & 3]);
+	}
+	const __m256i mask = _mm256_loadu_si256((const __m256i*)shuffle);
+
+	uint32_t i = 0;
+	for (; i + 8 <= numPixels; i += 8) {
+		const __m256i packed = _mm256_loadu_si256((const __m256i*)(pixels + 4 * i));
+		_mm256_storeu_si256((__m256i*)(pixels + 4 * i), _mm256_shuffle_epi8(packed, mask));
+	}
+	return i;
+}
+#endif
+
+/**
+ * Reorders the channels of every pixel, where output channel `i` is taken from
+ * channel `order[i]`.  For example, { 2, 1, 0, 3 } converts RGBA to BGRA.
+ *
+ * SSE2 has no byte shuffle, so only AVX2 has a vectorized swizzle.
+ */
+void cnImageRGBA8_Swizzle(CnImageRGBA8* image, const uint8_t order[4])
+{
+	CN_ASSERT_PTR(image);
+	CN_ASSERT_PTR(order);
+	CN_ASSERT(order[0] < 4 && order[1] < 4 && order[2] < 4 && order[3] < 4,
+		"Swizzle channels must be between 0 and 3.");
+
+	uint8_t* pixels = (uint8_t*)image->pixels.contents;
+	const uint32_t numPixels = image->width * image->height;
+
+	uint32_t done = 0;
+#if CN_IMAGE_KERNELS_AVX2
+	if (cnImageKernels_Level() == CnImageKernelLevelAVX2) {
+		done = cnImageKernels_SwizzleAVX2(pixels, numPixels, order);
+	}
+#endif
+	cnImageKernels_SwizzleScalar(pixels + 4 * done, numPixels - done, order);
+}
+
+//
+// Downsample
+//
+static void cnImageKernels_DownsampleRowScalar(uint8_t* out, const uint8_t* row0, const uint8_t* row1,
+	uint32_t first, uint32_t numOut, uint32_t srcWidth)
+{
+	for (uint32_t x = first; x < numOut; ++x) {
+		const uint32_t left = 2 * x;
+		const uint32_t right = left + 1 < srcWidth ? left + 1 : left;
+		for (uint32_t c = 0; c < 4; ++c) {
+			const uint32_t sum = (uint32_t)row0[4 * left + c] + row0[4 * right + c]
+				+ row1[4 * left + c] + row1[4 * right + c];
+			out[4 * x + c] = (uint8_t)((sum + 2) >> 2);
+		}
+	}
+}
+
+#if CN_IMAGE_KERNELS_SSE2
+/**
+ * Averages each pair of adjacent pixels over two rows, two output pixels at a
+ * time.  Requires the source to be at least two pixels wide.
+ */
+static uint32_t cnImageKernels_DownsampleRowSSE2(uint8_t* out, const uint8_t* row0, const uint8_t* row1,
+	uint32_t numOut)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+	uint32_t x = 0;
+	for (; x + 2 <= numOut; x += 2) {
+		const __m128i top = _mm_loadu_si128((const __m128i*)(row0 + 8 * x));
+		const __m128i bottom = _mm_loadu_si128((const __m128i*)(row1 + 8 * x));
+
+		// Sum vertically, with pixels 0-1 in low and pixels 2-3 in high.
+		const __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+		const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+		// Sum horizontally into the lower four lanes of each.
+		const __m128i lowSum = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+		const __m128i highSum = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+
+		__m128i sums = _mm_unpacklo_epi64(lowSum, highSum);
+		sums = _mm_srli_epi16(_mm_add_epi16(sums, rounding), 2);
+		_mm_storel_epi64((__m128i*)(out + 4 * x), _mm_packus_epi16(sums, sums));
+	}
+	return x;
+}
+#endif
+
+#if CN_IMAGE_KERNELS_AVX2
+CN_TARGET_AVX2
+static uint32_t cnImageKernels_DownsampleRowAVX2(uint8_t* out, const uint8_t* row0, const uint8_t* row1,
+	uint32_t numOut)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i rounding = _mm256_set1_epi16(2);
+	uint32_t x = 0;
+	for (; x + 4 <= numOut; x += 4) {
+		const __m256i top = _mm256_loadu_si256((const __m256i*)(row0 + 8 * x));
+		const __m256i bottom = _mm256_loadu_si256((const __m256i*)(row1 + 8 * x));
+
+		// The same as SSE2, within each 128-bit lane.
+		const __m256i low = _mm256_add_epi16(_mm256_unpacklo_epi8(top, zero), _mm256_unpacklo_epi8(bottom, zero));
+		const __m256i high = _mm256_add_epi16(_mm256_unpackhi_epi8(top, zero), _mm256_unpackhi_epi8(bottom, zero));
+		const __m256i lowSum = _mm256_add_epi16(low, _mm256_srli_si256(low, 8));
+		const __m256i highSum = _mm256_add_epi16(high, _mm256_srli_si256(high, 8));
+
+		__m256i sums = _mm256_unpacklo_epi64(lowSum, highSum);
+		sums = _mm256_srli_epi16(_mm256_add_epi16(sums, rounding), 2);
+
+		// Each lane holds two output pixels in its lower half.
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(sums, sums), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm_storeu_si128((__m128i*)(out + 4 * x), _mm256_castsi256_si128(packed));
+	}
+	return x;
+}
+#endif
+
+/**
+ * Halves an image with a 2x2 box filter.  The destination must be half the
+ * size of the source, rounded down, but at least one pixel in each dimension.
+ * The last row or column of odd sized images is dropped.
+ */
+void cnImageRGBA8_Downsample(CnImageRGBA8* dest, const CnImageRGBA8* src)
+{
+	CN_ASSERT_PTR(dest);
+	CN_ASSERT_PTR(src);
+
+	const uint32_t outWidth = src->width > 1 ? src->width / 2 : 1;
+	const uint32_t outHeight = src->height > 1 ? src->height / 2 : 1;
+	CN_ASSERT(dest->width == outWidth && dest->height == outHeight,
+		"Downsampled image must be %" PRIu32 "x%" PRIu32, outWidth, outHeight);
+
+	const CnImageKernelLevel level = src->width > 1 ? cnImageKernels_Level() : CnImageKernelLevelScalar;
+	const size_t srcRowSize = 4 * (size_t)src->width;
+	for (uint32_t y = 0; y < outHeight; ++y) {
+		const uint8_t* row0 = (const uint8_t*)src->pixels.contents + srcRowSize * 2 * y;
+		const uint8_t* row1 = 2 * y + 1 < src->height ? row0 + srcRowSize : row0;
+		uint8_t* out = (uint8_t*)dest->pixels.contents + 4 * (size_t)outWidth * y;
+
+		uint32_t done = 0;
+		switch (level) {
+#if CN_IMAGE_KERNELS_AVX2
+			case CnImageKernelLevelAVX2:
+				done = cnImageKernels_DownsampleRowAVX2(out, row0, row1, outWidth);
+				break;
+#endif
+#if CN_IMAGE_KERNELS_SSE2
+			case CnImageKernelLevelSSE2:
+				done = cnImageKernels_DownsampleRowSSE2(out, row0, row1, outWidth);
+				break;
+#endif
+			default:
+				break;
+		}
+		cnImageKernels_DownsampleRowScalar(out, row0, row1, done, outWidth, src->width);
+	}
+}
+
+//
+// Resize
+//
+
+/**
+ * Sample positions are pixel centers, in 16.16 fixed point.
+ */
+static int64_t cnImageKernels_SourcePosition(uint32_t destIndex, uint32_t destSize, uint32_t srcSize)
+{
+	return (((int64_t)(2 * destIndex + 1) * srcSize) << 16) / (2 * (int64_t)destSize) - (1 << 15);
+}
+
+static uint32_t cnImageKernels_NearestIndex(uint32_t destIndex, uint32_t destSize, uint32_t srcSize)
+{
+	return (uint32_t)(((uint64_t)(2 * destIndex + 1) * srcSize) / (2 * (uint64_t)destSize));
+}
+
+typedef struct {
+	uint32_t first;
+	uint32_t second;
+
+	/** Weight of the second sample, out of 256. */
+	uint32_t weight;
+} CnImageKernelsTap;
+
+static CnImageKernelsTap cnImageKernels_BilinearTap(uint32_t destIndex, uint32_t destSize, uint32_t srcSize)
+{
+	int64_t position = cnImageKernels_SourcePosition(destIndex, destSize, srcSize);
+	if (position < 0) {
+		position = 0;
+	}
+	CnImageKernelsTap tap;
+	tap.first = (uint32_t)(position >> 16);
+	if (tap.first >= srcSize - 1) {
+		tap.first = srcSize - 1;
+		tap.second = srcSize - 1;
+		tap.weight = 0;
+	}
+	else {
+		tap.second = tap.first + 1;
+		tap.weight = (uint32_t)((position >> 8) & 0xFF);
+	}
+	return tap;
+}
+
+static void cnImageKernels_NearestRowScalar(uint32_t* out, const uint32_t* row, const uint32_t* columns,
+	uint32_t first, uint32_t numOut)
+{
+	for (uint32_t x = first; x < numOut; ++x) {
+		out[x] = row[columns[x]];
+	}
+}
+
+#if CN_IMAGE_KERNELS_AVX2
+CN_TARGET_AVX2
+static uint32_t cnImageKernels_NearestRowAVX2(uint32_t* out, const uint32_t* row, const uint32_t* columns,
+	uint32_t numOut)
+{
+	uint32_t x = 0;
+	for (; x + 8 <= numOut; x += 8) {
+		const __m256i indices = _mm256_loadu_si256((const __m256i*)(columns + x));
+		_mm256_storeu_si256((__m256i*)(out + x), _mm256_i32gather_epi32((const int*)row, indices, 4));
+	}
+	return x;
+}
+#endif
+
+static uint8_t cnImageKernels_Lerp(uint32_t from, uint32_t to, uint32_t weight)
+{
+	return (uint8_t)((from * (256 - weight) + to * weight) >> 8);
+}
+
+static void cnImageKernels_BilinearRowScalar(uint8_t* out, const uint8_t* row0, const uint8_t* row1,
+	const CnImageKernelsTap* columns, uint32_t rowWeight, uint32_t first, uint32_t numOut)
+{
+	for (uint32_t x = first; x < numOut; ++x) {
+		const CnImageKernelsTap tap = columns[x];
+		for (uint32_t c = 0; c < 4; ++c) {
+			const uint8_t top = cnImageKernels_Lerp(row0[4 * tap.first + c], row0[4 * tap.second + c], tap.weight);
+			const uint8_t bottom = cnImageKernels_Lerp(row1[4 * tap.first + c], row1[4 * tap.second + c], tap.weight);
+			out[4 * x + c] = cnImageKernels_Lerp(top, bottom, rowWeight);
+		}
+	}
+}
+
+#if CN_IMAGE_KERNELS_SSE2
+/**
+ * Blends one output pixel at a time, with all four samples in one register.
+ */
+static uint32_t cnImageKernels_BilinearRowSSE2(uint8_t* out, const uint8_t* row0, const uint8_t* row1,
+	const CnImageKernelsTap* columns, uint32_t rowWeight, uint32_t numOut)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weightDown = _mm_set1_epi16((short)rowWeight);
+	const __m128i weightUp = _mm_set1_epi16((short)(256 - rowWeight));
+	for (uint32_t x = 0; x < numOut; ++x) {
+		const CnImageKernelsTap tap = columns[x];
+		int32_t samples[4];
+		memcpy(&samples[0], row0 + 4 * tap.first, 4);
+		memcpy(&samples[1], row1 + 4 * tap.first, 4);
+		memcpy(&samples[2], row0 + 4 * tap.second, 4);
+		memcpy(&samples[3], row1 + 4 * tap.second, 4);
+
+		// { top, bottom } of each column.
+		const __m128i left = _mm_unpacklo_epi8(
+			_mm_unpacklo_epi32(_mm_cvtsi32_si128(samples[0]), _mm_cvtsi32_si128(samples[1])), zero);
+		const __m128i right = _mm_unpacklo_epi8(
+			_mm_unpacklo_epi32(_mm_cvtsi32_si128(samples[2]), _mm_cvtsi32_si128(samples[3])), zero);
+
+		const __m128i weightRight = _mm_set1_epi16((short)tap.weight);
+		const __m128i weightLeft = _mm_set1_epi16((short)(256 - tap.weight));
+		const __m128i across = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(left, weightLeft),
+			_mm_mullo_epi16(right, weightRight)), 8);
+
+		const __m128i bottom = _mm_srli_si128(across, 8);
+		const __m128i blended = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(across, weightUp),
+			_mm_mullo_epi16(bottom, weightDown)), 8);
+
+		const int32_t pixel = _mm_cvtsi128_si32(_mm_packus_epi16(blended, blended));
+		memcpy(out + 4 * x, &pixel, 4);
+	}
+	return numOut;
+}
+#endif
+
+/**
+ * Scales an image to the size of the destination image.
+ *
+ * Nearest sampling gathers with AVX2.  Bilinear sampling uses SSE2 for both
+ * vectorized levels, since each output pixel blends four scattered samples.
+ */
+void cnImageRGBA8_Resize(CnImageRGBA8* dest, const CnImageRGBA8* src, CnImageFilter filter)
+{
+	CN_ASSERT_PTR(dest);
+	CN_ASSERT_PTR(src);
+	CN_ASSERT(dest->width > 0 && dest->height > 0, "Cannot resize to an empty image.");
+	CN_ASSERT(src->width > 0 && src->height > 0, "Cannot resize an empty image.");
+
+	const CnImageKernelLevel level = cnImageKernels_Level();
+	const size_t srcRowSize = 4 * (size_t)src->width;
+
+	if (filter == CnImageFilterNearest) {
+		CnDynamicBuffer columns;
+		cnDynamicBuffer_Allocate(&columns, dest->width * (uint32_t)sizeof(uint32_t));
+		uint32_t* column = (uint32_t*)columns.contents;
+		for (uint32_t x = 0; x < dest->width; ++x) {
+			column[x] = cnImageKernels_NearestIndex(x, dest->width, src->width);
+		}
+
+		for (uint32_t y = 0; y < dest->height; ++y) {
+			const uint32_t srcRow = cnImageKernels_NearestIndex(y, dest->height, src->height);
+			const uint32_t* row = (const uint32_t*)(src->pixels.contents + srcRowSize * srcRow);
+			uint32_t* out = (uint32_t*)dest->pixels.contents + (size_t)dest->width * y;
+
+			uint32_t done = 0;
+#if CN_IMAGE_KERNELS_AVX2
+			if (level == CnImageKernelLevelAVX2) {
+				done = cnImageKernels_NearestRowAVX2(out, row, column, dest->width);
+			}
+#endif
+			cnImageKernels_NearestRowScalar(out, row, column, done, dest->width);
+		}
+		cnDynamicBuffer_Free(&columns);
+		return;
+	}
+
+	CN_ASSERT(filter == CnImageFilterBilinear, "Unknown image filter: %i", (int)filter);
+
+	CnDynamicBuffer columns;
+	cnDynamicBuffer_Allocate(&columns, dest->width * (uint32_t)sizeof(CnImageKernelsTap));
+	CnImageKernelsTap* column = (CnImageKernelsTap*)columns.contents;
+	for (uint32_t x = 0; x < dest->width; ++x) {
+		column[x] = cnImageKernels_BilinearTap(x, dest->width, src->width);
+	}
+
+	for (uint32_t y = 0; y < dest->height; ++y) {
+		const CnImageKernelsTap rows = cnImageKernels_BilinearTap(y, dest->height, src->height);
+		const uint8_t* row0 = (const uint8_t*)src->pixels.contents + srcRowSize * rows.first;
+		const uint8_t* row1 = (const uint8_t*)src->pixels.contents + srcRowSize * rows.second;
+		uint8_t* out = (uint8_t*)dest->pixels.contents + 4 * (size_t)dest->width * y;
+
+		uint32_t done = 0;
+#if CN_IMAGE_KERNELS_SSE2
+		if (level >= CnImageKernelLevelSSE2) {
+			done = cnImageKernels_BilinearRowSSE2(out, row0, row1, column, rows.weight, dest->width);
+		}
+#endif
+		cnImageKernels_BilinearRowScalar(out, row0, row1, column, rows.weight, done, dest->width);
+	}
+	cnDynamicBuffer_Free(&columns);
+}
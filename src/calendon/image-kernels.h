@@ -0,0 +1,51 @@
+#ifndef CN_IMAGE_KERNELS_H
+#define CN_IMAGE_KERNELS_H
+
+/**
+ * @file image-kernels.h
+ *
+ * Bulk operations on RGBA8 images.  Each kernel has a scalar implementation,
+ * and most also have SSE2 and AVX2 implementations, picked at runtime from
+ * what the CPU supports.  Every implementation of a kernel produces identical
+ * results.
+ *
+ * Rows are addressed in memory order, so row 0 is the first row in memory
+ * regardless of whether the image has been flipped for upload.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/dimension.h>
+#include <calendon/image.h>
+#include <calendon/row-col.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	CnImageKernelLevelScalar,
+	CnImageKernelLevelSSE2,
+	CnImageKernelLevelAVX2
+} CnImageKernelLevel;
+
+typedef enum {
+	CnImageFilterNearest,
+	CnImageFilterBilinear
+} CnImageFilter;
+
+CN_API CnImageKernelLevel cnImageKernels_Level(void);
+CN_TEST_API void          cnImageKernels_SetMaxLevel(CnImageKernelLevel level);
+
+CN_API void cnImageRGBA8_Blit(CnImageRGBA8* dest, CnRowColu32 destPosition, const CnImageRGBA8* src,
+	CnRowColu32 srcPosition, CnDimension2u32 size);
+CN_API void cnImageRGBA8_Premultiply(CnImageRGBA8* image);
+CN_API void cnImageRGBA8_Swizzle(CnImageRGBA8* image, const uint8_t order[4]);
+CN_API void cnImageRGBA8_Downsample(CnImageRGBA8* dest, const CnImageRGBA8* src);
+CN_API void cnImageRGBA8_Resize(CnImageRGBA8* dest, const CnImageRGBA8* src, CnImageFilter filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_IMAGE_KERNELS_H */
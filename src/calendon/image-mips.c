@@ -0,0 +1,80 @@
+#include "image-mips.h"
+
+#include <calendon/image-kernels.h>
+
+/**
+ * The number of levels in a full chain, down to 1x1.
+ */
+uint32_t cnImageMips_NumLevels(CnDimension2u32 size)
+{
+	CN_ASSERT(size.width > 0 && size.height > 0, "Cannot mip an empty image.");
+
+	uint32_t largest = size.width > size.height ? size.width : size.height;
+	uint32_t numLevels = 1;
+	while (largest > 1 && numLevels < CN_MAX_MIP_LEVELS) {
+		largest /= 2;
+		++numLevels;
+	}
+	return numLevels;
+}
+
+CnDimension2u32 cnImageMips_LevelSize(CnDimension2u32 size, uint32_t level)
+{
+	CN_ASSERT(level < CN_MAX_MIP_LEVELS, "Mip level out of range: %" PRIu32, level);
+
+	for (uint32_t i = 0; i < level; ++i) {
+		size.width = size.width > 1 ? size.width / 2 : 1;
+		size.height = size.height > 1 ? size.height / 2 : 1;
+	}
+	return size;
+}
+
+/**
+ * The byte offset of a level after the first within the tail.
+ */
+uint32_t cnImageMips_TailOffset(CnDimension2u32 size, uint32_t level)
+{
+	CN_ASSERT(level > 0, "The full size image isn't part of the tail.");
+
+	uint32_t offset = 0;
+	for (uint32_t i = 1; i < level; ++i) {
+		const CnDimension2u32 levelSize = cnImageMips_LevelSize(size, i);
+		offset += 4 * levelSize.width * levelSize.height;
+	}
+	return offset;
+}
+
+uint32_t cnImageMips_TailSize(CnDimension2u32 size, uint32_t numLevels)
+{
+	return numLevels > 1 ? cnImageMips_TailOffset(size, numLevels) : 0;
+}
+
+/**
+ * Fills the tail with each level after the first, each filtered from the
+ * level before it.
+ *
+ * @param tail at least `cnImageMips_TailSize(size, numLevels)` bytes
+ */
+void cnImageMips_Build(uint8_t* tail, const uint8_t* pixels, CnDimension2u32 size, uint32_t numLevels)
+{
+	CN_ASSERT_PTR(pixels);
+	CN_ASSERT(numLevels <= cnImageMips_NumLevels(size), "Too many mip levels requested: %" PRIu32, numLevels);
+
+	CnImageRGBA8 previous;
+	previous.pixels.contents = (char*)pixels;
+	previous.pixels.size = 4 * size.width * size.height;
+	previous.width = size.width;
+	previous.height = size.height;
+
+	for (uint32_t level = 1; level < numLevels; ++level) {
+		const CnDimension2u32 levelSize = cnImageMips_LevelSize(size, level);
+		CnImageRGBA8 next;
+		next.pixels.contents = (char*)tail + cnImageMips_TailOffset(size, level);
+		next.pixels.size = 4 * levelSize.width * levelSize.height;
+		next.width = levelSize.width;
+		next.height = levelSize.height;
+
+		cnImageRGBA8_Downsample(&next, &previous);
+		previous = next;
+	}
+}
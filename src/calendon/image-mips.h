@@ -0,0 +1,39 @@
+#ifndef CN_IMAGE_MIPS_H
+#define CN_IMAGE_MIPS_H
+
+/**
+ * @file image-mips.h
+ *
+ * Mip chains for RGBA8 images, built on the CPU with a 2x2 box filter.
+ *
+ * Each level is half the size of the previous one, rounded down, but at least
+ * one pixel, matching the sizes OpenGL expects.  Levels after the full size
+ * image are stored one after another, without padding, as the "tail" of the
+ * chain.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/dimension.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Enough levels for a 32768x32768 image.
+ */
+#define CN_MAX_MIP_LEVELS 16
+
+CN_API uint32_t        cnImageMips_NumLevels(CnDimension2u32 size);
+CN_API CnDimension2u32 cnImageMips_LevelSize(CnDimension2u32 size, uint32_t level);
+CN_API uint32_t        cnImageMips_TailOffset(CnDimension2u32 size, uint32_t level);
+CN_API uint32_t        cnImageMips_TailSize(CnDimension2u32 size, uint32_t numLevels);
+CN_API void            cnImageMips_Build(uint8_t* tail, const uint8_t* pixels, CnDimension2u32 size,
+	uint32_t numLevels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_IMAGE_MIPS_H */
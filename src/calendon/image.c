@@ -9,43 +9,102 @@
 
 extern CnLogHandle LogSysAssets;
 
-void cnImageRGBA8_Flip(CnImageRGBA8* image)
+/**
+ * Reads the header of a PNG file, to prepare for decoding it.  The file is
+ * mapped rather than read into memory.
+ */
+bool cnImageDecoder_Open(CnImageDecoder* decoder, const char* fileName)
 {
-	CN_ASSERT(image != NULL, "Cannot load flip a null image.");
-	CN_ASSERT(image->pixels.size > 0, "No pixels to flip.");
-	CN_ASSERT(image->width > 0, "Cannot flip an image with no width.");
-	CN_ASSERT(image->height > 0, "Cannot flip an image with no height.");
+	CN_ASSERT_PTR(decoder);
+	CN_ASSERT(fileName != NULL, "Cannot load an image with a null file name.");
 
-	CnDynamicBuffer flippedImage;
-	cnDynamicBuffer_Allocate(&flippedImage, image->pixels.size);
+	memset(decoder, 0, sizeof(CnImageDecoder));
+
+	// The PNG decoder only reads the file, so map it rather than copying it.
+	if (!cnAssets_MapFile(fileName, &decoder->file)) {
+		CN_WARN(LogSysAssets, "Unable to load image from %s", fileName);
+		return false;
+	}
 
-	// Assume RGBA8 encoding.
-	const uint32_t pixelSize = 4 * sizeof(uint8_t);
+	decoder->context = spng_ctx_new(0);
+	if (!decoder->context) {
+		cnImageDecoder_Close(decoder);
+		return false;
+	}
+	spng_set_png_buffer(decoder->context, decoder->file.contents, decoder->file.size);
 
-	const uint32_t expectedPixelStorageSize = pixelSize * image->width * image->height;
-	CN_ASSERT(expectedPixelStorageSize == image->pixels.size,
-		"Excessive storage for pixels found %" PRIu32 ", not matching resolution "
-		"%" PRIu32 "(%" PRIu32 ", %" PRIu32 ")", expectedPixelStorageSize,
-		image->pixels.size, image->width, image->height);
+	struct spng_ihdr header;
+	const int result = spng_get_ihdr(decoder->context, &header);
+	if (result != 0) {
+		CN_WARN(LogSysAssets, "Unable to read image header from %s: %s", fileName, spng_strerror(result));
+		cnImageDecoder_Close(decoder);
+		return false;
+	}
 
-	const uint32_t rowSize = pixelSize * image->width;
+	if ((uint64_t)header.width * header.height * 4 > UINT32_MAX) {
+		CN_WARN(LogSysAssets, "Image is too large: %s", fileName);
+		cnImageDecoder_Close(decoder);
+		return false;
+	}
 
-	uint8_t* from = NULL;
-	uint8_t* to = NULL;
+	decoder->width = header.width;
+	decoder->height = header.height;
+	return true;
+}
 
-	// Flip one row at a time.
-	for (uint32_t i = 0; i < image->height; ++i) {
-		from = (uint8_t*)flippedImage.contents + rowSize * (image->height - i - 1);
-		to = (uint8_t*)image->pixels.contents + rowSize * i;
-		memcpy(from, to, rowSize);
+/**
+ * Decodes the image as RGBA8, one row at a time, with each row written
+ * directly to its flipped position so Y=0 is the bottom row.
+ */
+bool cnImageDecoder_DecodeRGBA8(CnImageDecoder* decoder, uint8_t* pixels, uint32_t size)
+{
+	CN_ASSERT_PTR(decoder);
+	CN_ASSERT_PTR(pixels);
+	CN_ASSERT(decoder->context != NULL, "Image decoder is not open.");
+
+	const uint32_t rowSize = 4 * decoder->width;
+	if (size < rowSize * decoder->height) {
+		CN_WARN(LogSysAssets, "Buffer of %" PRIu32 " bytes is too small for a %" PRIu32
+			"x%" PRIu32 " image", size, decoder->width, decoder->height);
+		return false;
 	}
 
-	// Swap the buffer content pointers.
-	char* temp = image->pixels.contents;
-	image->pixels.contents = flippedImage.contents;
-	flippedImage.contents = temp;
+	int result = spng_decode_image(decoder->context, NULL, 0, SPNG_FMT_RGBA8, SPNG_DECODE_PROGRESSIVE);
+	if (result != 0) {
+		CN_WARN(LogSysAssets, "Unable to start decoding image: %s", spng_strerror(result));
+		return false;
+	}
 
-	cnDynamicBuffer_Free(&flippedImage);
+	// Interlaced images visit rows once per pass, with each pass filling in
+	// more pixels of the row.
+	struct spng_row_info rowInfo;
+	do {
+		result = spng_get_row_info(decoder->context, &rowInfo);
+		if (result != 0) {
+			break;
+		}
+		uint8_t* row = pixels + rowSize * (decoder->height - rowInfo.row_num - 1);
+		result = spng_decode_row(decoder->context, row, rowSize);
+	} while (result == 0);
+
+	if (result != SPNG_EOI) {
+		CN_WARN(LogSysAssets, "Unable to decode image: %s", spng_strerror(result));
+		return false;
+	}
+	return true;
+}
+
+void cnImageDecoder_Close(CnImageDecoder* decoder)
+{
+	CN_ASSERT_PTR(decoder);
+
+	if (decoder->context) {
+		spng_ctx_free(decoder->context);
+		decoder->context = NULL;
+	}
+	if (decoder->file.contents) {
+		cnAssets_UnmapFile(&decoder->file);
+	}
 }
 
 /**
@@ -58,41 +117,27 @@ bool cnImageRGBA8_Allocate(CnImageRGBA8* image, const char* fileName)
 {
 	CN_ASSERT(image != NULL, "Cannot load data into a null image.");
 	CN_ASSERT(fileName != NULL, "Cannot load an image with a null file name.");
-	CnDynamicBuffer fileBuffer;
 
-	if (!cnAssets_ReadFile(fileName, CnFileTypeBinary, &fileBuffer)) {
-		CN_WARN(LogSysAssets, "Unable to load image from %s", fileName);
+	CnImageDecoder decoder;
+	if (!cnImageDecoder_Open(&decoder, fileName)) {
 		return false;
 	}
 
-	spng_ctx* pngContext = spng_ctx_new(0);
-	spng_set_png_buffer(pngContext, fileBuffer.contents, fileBuffer.size);
-
-	uint32_t format = SPNG_FMT_RGBA8;
-	size_t decodedSize = 0;
-	spng_decoded_image_size(pngContext, format, &decodedSize);
-
-	cnDynamicBuffer_Allocate(&image->pixels, (uint32_t) decodedSize);
-	image->pixels.size = (uint32_t)decodedSize;
-
-	spng_decode_image(pngContext, (uint8_t*)image->pixels.contents, image->pixels.size, format, 0);
-
-	struct spng_ihdr header;
-	spng_get_ihdr(pngContext, &header);
-	spng_ctx_free(pngContext);
-
-	image->width = header.width;
-	image->height = header.height;
-
-	cnImageRGBA8_Flip(image);
+	// Rows are decoded into their flipped positions, so no flip is needed.
+	image->width = decoder.width;
+	image->height = decoder.height;
+	cnDynamicBuffer_Allocate(&image->pixels, 4 * decoder.width * decoder.height);
+	if (!cnImageDecoder_DecodeRGBA8(&decoder, (uint8_t*)image->pixels.contents, image->pixels.size)) {
+		cnDynamicBuffer_Free(&image->pixels);
+		cnImageDecoder_Close(&decoder);
+		return false;
+	}
 
 	CN_TRACE(LogSysAssets, "Loading image: %s", fileName);
-	CN_TRACE(LogSysAssets, "Image size %d, %d", header.width, header.height);
-	CN_TRACE(LogSysAssets, "Output size: %llu", decodedSize);
-	CN_TRACE(LogSysAssets, "CnInput fileContents size: %d", fileBuffer.size);
-
-	cnDynamicBuffer_Free(&fileBuffer);
+	CN_TRACE(LogSysAssets, "Image size %" PRIu32 ", %" PRIu32, image->width, image->height);
+	CN_TRACE(LogSysAssets, "CnInput fileContents size: %" PRIu32, decoder.file.size);
 
+	cnImageDecoder_Close(&decoder);
 	return true;
 }
 
@@ -114,17 +159,6 @@ void cnImageRGBA8_Free(CnImageRGBA8* image)
 	cnDynamicBuffer_Free(&image->pixels);
 }
 
-void cnImageRGBA8_ClearRGBA(CnImageRGBA8* image, uint8_t r, uint8_t b, uint8_t g, uint8_t a)
-{
-	CN_ASSERT(image != NULL, "Cannot clear a null image.");
-
-	uint32_t* pixel = (uint32_t*)image->pixels.contents;
-	const uint32_t numPixels = image->pixels.size / 4;
-	for (uint32_t i = 0; i < numPixels; ++i) {
-		*pixel = (r << 3 | b << 2 | g << 1 | a);
-	}
-}
-
 uint32_t cnImageRGBA8_GetPixelRowCol(CnImageRGBA8* image, CnRowColu32 rowCol)
 {
 	CN_ASSERT(image != NULL, "Cannot get pixels from a null image.");
@@ -3,6 +3,7 @@
 
 #include <calendon/cn.h>
 
+#include <calendon/assets-fileio.h>
 #include <calendon/dimension.h>
 #include <calendon/memory.h>
 #include <calendon/row-col.h>
@@ -30,11 +31,28 @@ typedef struct {
 	uint32_t width, height;
 } CnImageRGBA8;
 
+/**
+ * Decodes a PNG file directly into a caller provided buffer, such as an
+ * image's pixels or a mapped GPU buffer, without intermediate copies.
+ *
+ * Open the decoder to find the image size, decode into a buffer of at least
+ * `width * height * 4` bytes, then close the decoder.
+ */
+typedef struct {
+	struct spng_ctx* context;
+	CnFileView file;
+	uint32_t width, height;
+} CnImageDecoder;
+
+CN_API bool          cnImageDecoder_Open(CnImageDecoder* decoder, const char* fileName);
+CN_API bool          cnImageDecoder_DecodeRGBA8(CnImageDecoder* decoder, uint8_t* pixels, uint32_t size);
+CN_API void          cnImageDecoder_Close(CnImageDecoder* decoder);
+
 CN_API bool          cnImageRGBA8_Allocate(CnImageRGBA8* image, const char* fileName);
 CN_API bool          cnImageRGBA8_AllocateSized(CnImageRGBA8* image, CnDimension2u32 size);
 CN_API void          cnImageRGBA8_Free(CnImageRGBA8* image);
 CN_API void          cnImageRGBA8_Flip(CnImageRGBA8* image);
-CN_API void          cnImageRGBA8_ClearRGBA(CnImageRGBA8* image, uint8_t r, uint8_t b, uint8_t g, uint8_t a);
+CN_API void          cnImageRGBA8_ClearRGBA(CnImageRGBA8* image, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
 CN_API uint32_t      cnImageRGBA8_GetPixelRowCol(CnImageRGBA8* image, CnRowColu32 rowCol);
 CN_TEST_API uint32_t cnImageRGBA8_OffsetForRowCol(CnImageRGBA8* image, CnRowColu32 rowCol, bool flip);
 
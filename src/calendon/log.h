@@ -102,7 +102,7 @@ CN_API void cnLog_Print(CnLogHandle system, CnLogVerbosity verbosity, const char
  */
 #define CN_TRACE(system, msg, ...) CN_LOG(system, CnLogVerbosityTrace, msg, ##__VA_ARGS__)
 
-void            cnLog_PreInit(void);
+CN_TEST_API void cnLog_PreInit(void);
 
 CN_API bool     cnLog_IsReady(void);
 CN_API uint32_t cnLog_RegisterSystem(const char* name);
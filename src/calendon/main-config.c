@@ -2,6 +2,7 @@
 
 #include <calendon/cn.h>
 #include <calendon/path.h>
+#include <calendon/render-thread.h>
 #include <calendon/string.h>
 
 #include <errno.h>
@@ -11,6 +12,10 @@ int32_t cnMain_OptionPrintWorkingDirectory(const CnCommandLineParse* parse, void
 int32_t cnMain_OptionPayload(const CnCommandLineParse* parse, void* c);
 int32_t cnMain_OptionTickLimit(const CnCommandLineParse* parse, void* config);
 int32_t cnMain_OptionHeadless(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionFrameBudget(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionPresentMode(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionCapture(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionRenderThread(const CnCommandLineParse* parse, void* config);
 
 static CnMainConfig s_config;
 static CnCommandLineOption s_options[] = {
@@ -41,6 +46,37 @@ static CnCommandLineOption s_options[] = {
 		NULL,
 		"--headless",
 		cnMain_OptionHeadless
+	},
+	{
+		"\t--frame-budget MILLISECONDS\n"
+		"\t\tLower the resolution frames are drawn at when the GPU takes longer\n"
+		"\t\tthan this to draw them.\n",
+		NULL,
+		"--frame-budget",
+		cnMain_OptionFrameBudget
+	},
+	{
+		"\t--present-mode vsync|adaptive|immediate\n"
+		"\t\tHow finished frames are shown.  Immediate has the least latency,\n"
+		"\t\tbut tears.\n",
+		NULL,
+		"--present-mode",
+		cnMain_OptionPresentMode
+	},
+	{
+		"\t--capture DIRECTORY\n"
+		"\t\tWrite every frame to a QOI file in a directory.\n",
+		NULL,
+		"--capture",
+		cnMain_OptionCapture
+	},
+	{
+		"\t--render-thread 0|1\n"
+		"\t\tSubmit to GL from a separate thread, with the main thread up to\n"
+		"\t\tthis many frames ahead.\n",
+		NULL,
+		"--render-thread",
+		cnMain_OptionRenderThread
 	}
 };
 
@@ -48,7 +84,7 @@ CnCommandLineOptionList cnMain_CommandLineOptionList(void)
 {
 	return (CnCommandLineOptionList) {
 		.options = s_options,
-		.numOptions = 4
+		.numOptions = 8
 	};
 }
 
@@ -62,7 +98,10 @@ void cnMain_SetDefaultConfig(void* config)
 	CnMainConfig* c = (CnMainConfig*)config;
 	memset(c, 0, sizeof(CnMainConfig));
 	c->headless = false;
+	c->presentMode = CnPresentModeVSync;
+	c->renderThreadLatency = -1;
 	cnPathBuffer_Clear(&c->gameLibPath);
+	cnPathBuffer_Clear(&c->captureDirectory);
 }
 
 int32_t cnMain_OptionPrintWorkingDirectory(const CnCommandLineParse* parse, void* config)
@@ -153,3 +192,98 @@ int32_t cnMain_OptionHeadless(const CnCommandLineParse* parse, void* config)
 
 	return 1;
 }
+
+int32_t cnMain_OptionFrameBudget(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide the milliseconds of GPU time to allow per frame.\n");
+		return CnOptionParseError;
+	}
+
+	const char* budgetString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	const double parsedValue = strtod(budgetString, &readCursor);
+	if (*readCursor != '\0' || errno == ERANGE || !(parsedValue > 0.0)) {
+		cnPrint("Frame budget must be a positive number of milliseconds: %s\n", budgetString);
+		return CnOptionParseError;
+	}
+	mainConfig->frameBudgetMicros = (uint64_t)(parsedValue * 1000.0);
+	return 2;
+}
+
+int32_t cnMain_OptionPresentMode(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a present mode: vsync, adaptive or immediate.\n");
+		return CnOptionParseError;
+	}
+
+	const char* mode = cnCommandLineParse_LookAhead(parse, 2);
+	if (strcmp(mode, "vsync") == 0) {
+		mainConfig->presentMode = CnPresentModeVSync;
+	}
+	else if (strcmp(mode, "adaptive") == 0) {
+		mainConfig->presentMode = CnPresentModeAdaptive;
+	}
+	else if (strcmp(mode, "immediate") == 0) {
+		mainConfig->presentMode = CnPresentModeImmediate;
+	}
+	else {
+		cnPrint("Unknown present mode: %s\n", mode);
+		return CnOptionParseError;
+	}
+	return 2;
+}
+
+int32_t cnMain_OptionCapture(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a directory to write captured frames to.\n");
+		return CnOptionParseError;
+	}
+
+	const char* directory = cnCommandLineParse_LookAhead(parse, 2);
+	if (!cnPath_IsDir(directory) || !cnPathBuffer_Set(&mainConfig->captureDirectory, directory)) {
+		cnPrint("Capture directory does not exist: %s\n", directory);
+		return CnOptionParseError;
+	}
+	return 2;
+}
+
+int32_t cnMain_OptionRenderThread(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide the frames of latency for the render thread: 0 or 1.\n");
+		return CnOptionParseError;
+	}
+
+	const char* latencyString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	const int64_t parsedValue = strtoll(latencyString, &readCursor, 10);
+	if (*readCursor != '\0' || parsedValue < 0 || parsedValue > CN_RENDER_THREAD_MAX_LATENCY) {
+		cnPrint("Render thread latency must be 0 or 1 frames: %s\n", latencyString);
+		return CnOptionParseError;
+	}
+	mainConfig->renderThreadLatency = (int32_t)parsedValue;
+	return 2;
+}
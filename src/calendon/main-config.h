@@ -4,6 +4,7 @@
 #include <calendon/command-line-option.h>
 #include <calendon/path.h>
 #include <calendon/behavior.h>
+#include <calendon/render-resources.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +14,16 @@ typedef struct {
 	CnBehavior payload;
 	CnPathBuffer gameLibPath;
 	int64_t tickLimit;
+
+	/** GPU time per frame for dynamic resolution, or zero for none. */
+	uint64_t frameBudgetMicros;
+	CnPresentMode presentMode;
+
+	/** Directory to write captured frames to, or empty to not capture. */
+	CnPathBuffer captureDirectory;
+
+	/** Frames of latency for the render thread, or -1 to not use one. */
+	int32_t renderThreadLatency;
 	bool headless;
 } CnMainConfig;
 
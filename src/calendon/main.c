@@ -6,6 +6,7 @@
 #include <calendon/main-detail.h>
 #include <calendon/tick-limits.h>
 #include <calendon/render.h>
+#include <calendon/render-scale.h>
 #include <calendon/ui.h>
 
 /**
@@ -39,6 +40,16 @@ void cnMain_StartUp(int argc, char** argv)
 	CnMainConfig* config = (CnMainConfig*) cnMain_Config();
 	if (!config->headless) {
 		cnMain_StartUpUI();
+		cnR_SetPresentMode(config->presentMode);
+		if (config->frameBudgetMicros > 0) {
+			cnR_SetDynamicResolution(config->frameBudgetMicros, CN_RENDER_SCALE_DEFAULT_MIN);
+		}
+		if (config->captureDirectory.str[0] != '\0') {
+			cnR_StartCapture(config->captureDirectory.str, CnCaptureFormatQOI);
+		}
+		if (config->renderThreadLatency >= 0) {
+			cnR_StartRenderThread((uint32_t)config->renderThreadLatency);
+		}
 	}
 
 	// If there is a demo to load from file, then use that.
@@ -2,14 +2,20 @@
 
 #include <calendon/cn.h>
 
+#include <calendon/compat-sdl.h>
 #include <calendon/log.h>
 
 static CnLogHandle LogSysMemory;
-static uint32_t s_outstandingDynamicBuffers;
+
+/**
+ * Buffers are allocated and freed by asset loading threads as well as the main
+ * thread, so the count is atomic.
+ */
+static SDL_atomic_t s_outstandingDynamicBuffers;
 
 bool cnMemory_Init(void)
 {
-	s_outstandingDynamicBuffers = 0;
+	SDL_AtomicSet(&s_outstandingDynamicBuffers, 0);
 	LogSysMemory = cnLog_RegisterSystem("Memory");
 	return true;
 }
@@ -28,7 +34,7 @@ void cnDynamicBuffer_Allocate(CnDynamicBuffer* buffer, uint32_t size)
 		CN_ERROR(LogSysMemory, "Unable to allocate %" PRIu32 " bytes for CnDynamicBuffer", size);
 	}
 	buffer->size = size;
-	++s_outstandingDynamicBuffers;
+	SDL_AtomicIncRef(&s_outstandingDynamicBuffers);
 }
 
 void cnDynamicBuffer_Free(CnDynamicBuffer* buffer)
@@ -38,18 +44,16 @@ void cnDynamicBuffer_Free(CnDynamicBuffer* buffer)
 	free(buffer->contents);
 	buffer->contents = NULL;
 
-	if (s_outstandingDynamicBuffers == 0) {
+	if (SDL_AtomicAdd(&s_outstandingDynamicBuffers, -1) <= 0) {
+		SDL_AtomicIncRef(&s_outstandingDynamicBuffers);
 		CN_ERROR(LogSysMemory, "Double free of buffer %p", (void*)buffer);
 	}
-	else {
-		--s_outstandingDynamicBuffers;
-	}
 }
 
 void cnMemory_Shutdown(void)
 {
-	if (s_outstandingDynamicBuffers != 0) {
-		//CN_ERROR(LogSysMemory, "Memory systems leaks: %" PRIu32, s_outstandingDynamicBuffers);
+	if (SDL_AtomicGet(&s_outstandingDynamicBuffers) != 0) {
+		//CN_ERROR(LogSysMemory, "Memory systems leaks: %i", SDL_AtomicGet(&s_outstandingDynamicBuffers));
 	}
 }
 
@@ -0,0 +1,425 @@
+#include "render-async.h"
+
+#include <calendon/assets-fileio.h>
+#include <calendon/compat-sdl.h>
+#include <calendon/font-psf2.h>
+#include <calendon/image-cache.h>
+#include <calendon/log.h>
+#include <calendon/path.h>
+#include <calendon/render-ll.h>
+#include <calendon/render-thread.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+extern uint32_t LogSysRender;
+
+/**
+ * The maximum number of loads which can be in flight at once.
+ */
+#define CN_RENDER_MAX_PENDING_LOADS 64
+
+#define CN_RENDER_MAX_LOAD_WORKERS 4
+
+/**
+ * Load statuses are tracked per resource, so ids beyond this can't be loaded
+ * asynchronously.
+ */
+#define CN_RENDER_MAX_LOAD_RESOURCES 256
+
+typedef enum {
+	CnLoadKindSprite = 1,
+	CnLoadKindFont   = 2
+} CnLoadKind;
+
+/**
+ * Load ids encode the kind of resource and its id, so the status of a load
+ * can be found after the load itself has been retired.
+ */
+#define CN_LOAD_ID_MAKE(kind, resourceId) (((uint32_t)(kind) << 24) | (resourceId))
+#define CN_LOAD_ID_KIND(load) ((load) >> 24)
+#define CN_LOAD_ID_RESOURCE(load) ((load) & 0xFFFFFF)
+
+typedef struct {
+	CnLoadKind kind;
+	uint32_t resourceId;
+	CnPathBuffer path;
+	CnLoadCallbackFn onLoaded;
+	void* userData;
+
+	/** Results of decoding, written by a worker. */
+	bool decoded;
+	uint32_t uploadSize;
+	CnCachedImage image;
+	CnFontPSF2* font;
+} CnLoadJob;
+
+/**
+ * A fixed-size FIFO of indices into `jobs`.
+ */
+typedef struct {
+	uint32_t jobs[CN_RENDER_MAX_PENDING_LOADS];
+	uint32_t head;
+	uint32_t count;
+} CnLoadQueue;
+
+static CnLoadJob jobs[CN_RENDER_MAX_PENDING_LOADS];
+static bool jobInUse[CN_RENDER_MAX_PENDING_LOADS];
+
+/**
+ * Jobs waiting for a worker to decode them, and jobs waiting for the main
+ * thread to upload them.  Both queues are guarded by `loadLock`.
+ */
+static CnLoadQueue decodeQueue;
+static CnLoadQueue uploadQueue;
+
+static SDL_mutex* loadLock;
+static SDL_cond* decodeAvailable;
+static SDL_Thread* workers[CN_RENDER_MAX_LOAD_WORKERS];
+static uint32_t numWorkers;
+static bool workersQuit;
+
+/**
+ * Statuses are only read and written on the main thread.
+ */
+static CnLoadStatus spriteStatus[CN_RENDER_MAX_LOAD_RESOURCES];
+static CnLoadStatus fontStatus[CN_RENDER_MAX_LOAD_RESOURCES];
+
+static uint32_t uploadBudget = CN_RENDER_DEFAULT_UPLOAD_BUDGET;
+
+static void cnLoadQueue_Push(CnLoadQueue* queue, uint32_t job)
+{
+	CN_ASSERT(queue->count < CN_RENDER_MAX_PENDING_LOADS, "Load queue overflow");
+	queue->jobs[(queue->head + queue->count) % CN_RENDER_MAX_PENDING_LOADS] = job;
+	++queue->count;
+}
+
+static uint32_t cnLoadQueue_Pop(CnLoadQueue* queue)
+{
+	CN_ASSERT(queue->count > 0, "Load queue underflow");
+	const uint32_t job = queue->jobs[queue->head];
+	queue->head = (queue->head + 1) % CN_RENDER_MAX_PENDING_LOADS;
+	--queue->count;
+	return job;
+}
+
+static uint32_t cnLoadQueue_Peek(const CnLoadQueue* queue)
+{
+	CN_ASSERT(queue->count > 0, "Load queue is empty");
+	return queue->jobs[queue->head];
+}
+
+/**
+ * Reads and decodes a resource.  Runs on a worker thread, so must not touch GL.
+ */
+static void cnRAsync_Decode(CnLoadJob* job)
+{
+	switch (job->kind) {
+		case CnLoadKindSprite:
+			job->decoded = cnImageCache_Load(&job->image, job->path.str, true);
+			job->uploadSize = job->decoded ? 4 * job->image.width * job->image.height
+				+ cnImageMips_TailSize((CnDimension2u32) { job->image.width, job->image.height },
+					job->image.numLevels) : 0;
+			break;
+		case CnLoadKindFont:
+			job->font = (CnFontPSF2*)malloc(sizeof(CnFontPSF2));
+			if (!job->font) {
+				job->decoded = false;
+				break;
+			}
+			if (!cnFont_PSF2Allocate(job->font, job->path.str)) {
+				free(job->font);
+				job->font = NULL;
+				job->decoded = false;
+				break;
+			}
+			job->decoded = true;
+			job->uploadSize = job->font->atlas.image.pixels.size;
+			break;
+		default:
+			CN_FATAL_ERROR("Unknown load kind: %i", (int)job->kind);
+	}
+}
+
+static int cnRAsync_Worker(void* unused)
+{
+	CN_UNUSED(unused);
+	for (;;) {
+		SDL_LockMutex(loadLock);
+		while (!workersQuit && decodeQueue.count == 0) {
+			SDL_CondWait(decodeAvailable, loadLock);
+		}
+		if (workersQuit) {
+			SDL_UnlockMutex(loadLock);
+			return 0;
+		}
+		const uint32_t jobIndex = cnLoadQueue_Pop(&decodeQueue);
+		SDL_UnlockMutex(loadLock);
+
+		cnRAsync_Decode(&jobs[jobIndex]);
+
+		SDL_LockMutex(loadLock);
+		cnLoadQueue_Push(&uploadQueue, jobIndex);
+		SDL_UnlockMutex(loadLock);
+	}
+}
+
+void cnRAsync_Init(void)
+{
+	memset(jobInUse, 0, sizeof(jobInUse));
+	memset(&decodeQueue, 0, sizeof(decodeQueue));
+	memset(&uploadQueue, 0, sizeof(uploadQueue));
+	memset(spriteStatus, 0, sizeof(spriteStatus));
+	memset(fontStatus, 0, sizeof(fontStatus));
+	uploadBudget = CN_RENDER_DEFAULT_UPLOAD_BUDGET;
+	workersQuit = false;
+
+	loadLock = SDL_CreateMutex();
+	decodeAvailable = SDL_CreateCond();
+	if (!loadLock || !decodeAvailable) {
+		CN_FATAL_ERROR("Unable to create asynchronous load synchronization: %s", SDL_GetError());
+	}
+
+	// Leave a core for the main thread.
+	const int numCores = SDL_GetCPUCount();
+	numWorkers = numCores > 2 ? (uint32_t)(numCores - 1) : 1;
+	if (numWorkers > CN_RENDER_MAX_LOAD_WORKERS) {
+		numWorkers = CN_RENDER_MAX_LOAD_WORKERS;
+	}
+
+	for (uint32_t i = 0; i < numWorkers; ++i) {
+		workers[i] = SDL_CreateThread(cnRAsync_Worker, "CnLoadWorker", NULL);
+		if (!workers[i]) {
+			CN_FATAL_ERROR("Unable to create asynchronous load worker: %s", SDL_GetError());
+		}
+	}
+	CN_TRACE(LogSysRender, "Started %" PRIu32 " load workers", numWorkers);
+}
+
+static void cnRAsync_ReleaseJob(uint32_t jobIndex)
+{
+	CnLoadJob* job = &jobs[jobIndex];
+	if (job->kind == CnLoadKindSprite && job->decoded) {
+		cnImageCache_Release(&job->image);
+	}
+	if (job->font) {
+		free(job->font);
+		job->font = NULL;
+	}
+	jobInUse[jobIndex] = false;
+}
+
+void cnRAsync_Shutdown(void)
+{
+	SDL_LockMutex(loadLock);
+	workersQuit = true;
+	SDL_CondBroadcast(decodeAvailable);
+	SDL_UnlockMutex(loadLock);
+
+	for (uint32_t i = 0; i < numWorkers; ++i) {
+		SDL_WaitThread(workers[i], NULL);
+		workers[i] = NULL;
+	}
+	numWorkers = 0;
+
+	// Discard work which was never uploaded.
+	while (uploadQueue.count > 0) {
+		const uint32_t jobIndex = cnLoadQueue_Pop(&uploadQueue);
+		if (jobs[jobIndex].font) {
+			cnFont_PSF2Free(jobs[jobIndex].font);
+		}
+		cnRAsync_ReleaseJob(jobIndex);
+	}
+
+	SDL_DestroyCond(decodeAvailable);
+	SDL_DestroyMutex(loadLock);
+	decodeAvailable = NULL;
+	loadLock = NULL;
+}
+
+static CnLoadStatus* cnRAsync_StatusFor(CnLoadKind kind, uint32_t resourceId)
+{
+	if (resourceId >= CN_RENDER_MAX_LOAD_RESOURCES) {
+		return NULL;
+	}
+	switch (kind) {
+		case CnLoadKindSprite: return &spriteStatus[resourceId];
+		case CnLoadKindFont:   return &fontStatus[resourceId];
+		default:               return NULL;
+	}
+}
+
+static CnLoadId cnRAsync_Queue(CnLoadKind kind, uint32_t resourceId, const char* path,
+	CnLoadCallbackFn onLoaded, void* userData)
+{
+	CN_ASSERT(loadLock != NULL, "Asynchronous loading is not initialized.");
+
+	CnLoadStatus* status = cnRAsync_StatusFor(kind, resourceId);
+	CN_ASSERT(status != NULL, "Resource id is out of range for asynchronous loading: %" PRIu32, resourceId);
+	CN_ASSERT(*status != CnLoadStatusPending, "Resource %" PRIu32 " is already loading.", resourceId);
+
+	if (!cnAssets_FileExists(path)) {
+		CN_ERROR(LogSysRender, "Cannot load missing resource: %s", path);
+		return 0;
+	}
+
+	uint32_t jobIndex = CN_RENDER_MAX_PENDING_LOADS;
+	for (uint32_t i = 0; i < CN_RENDER_MAX_PENDING_LOADS; ++i) {
+		if (!jobInUse[i]) {
+			jobIndex = i;
+			break;
+		}
+	}
+	if (jobIndex == CN_RENDER_MAX_PENDING_LOADS) {
+		CN_WARN(LogSysRender, "Too many pending loads, cannot load: %s", path);
+		return 0;
+	}
+
+	CnLoadJob* job = &jobs[jobIndex];
+	memset(job, 0, sizeof(CnLoadJob));
+	job->kind = kind;
+	job->resourceId = resourceId;
+	if (!cnPathBuffer_Set(&job->path, path)) {
+		return 0;
+	}
+	job->onLoaded = onLoaded;
+	job->userData = userData;
+	jobInUse[jobIndex] = true;
+	*status = CnLoadStatusPending;
+
+	SDL_LockMutex(loadLock);
+	cnLoadQueue_Push(&decodeQueue, jobIndex);
+	SDL_CondSignal(decodeAvailable);
+	SDL_UnlockMutex(loadLock);
+
+	return CN_LOAD_ID_MAKE(kind, resourceId);
+}
+
+CnLoadId cnRAsync_QueueSprite(CnSpriteId id, const char* path, CnLoadCallbackFn onLoaded, void* userData)
+{
+	// Sprites are drawable right away, with a placeholder.
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_ReserveSprite(commands, id);
+	}
+	else {
+		cnRLL_ReserveSprite(id);
+	}
+	return cnRAsync_Queue(CnLoadKindSprite, id, path, onLoaded, userData);
+}
+
+CnLoadId cnRAsync_QueueFont(CnFontId id, const char* path, CnLoadCallbackFn onLoaded, void* userData)
+{
+	return cnRAsync_Queue(CnLoadKindFont, id, path, onLoaded, userData);
+}
+
+CnLoadStatus cnRAsync_Status(CnLoadId load)
+{
+	const CnLoadStatus* status = cnRAsync_StatusFor((CnLoadKind)CN_LOAD_ID_KIND(load),
+		CN_LOAD_ID_RESOURCE(load));
+	return status ? *status : CnLoadStatusNone;
+}
+
+void cnRAsync_SetUploadBudget(uint32_t bytesPerFrame)
+{
+	uploadBudget = bytesPerFrame;
+}
+
+/**
+ * Every load uploaded in a frame, so they're handed to the render thread
+ * together rather than waiting on it once per load.
+ */
+typedef struct {
+	uint32_t jobs[CN_RENDER_MAX_PENDING_LOADS];
+	bool uploaded[CN_RENDER_MAX_PENDING_LOADS];
+	uint32_t numJobs;
+} CnUploadBatch;
+
+/**
+ * Runs wherever GL is submitted from, which is the render thread if it is
+ * running.
+ */
+static void cnRAsync_UploadToGL(void* data)
+{
+	CnUploadBatch* batch = (CnUploadBatch*)data;
+	for (uint32_t i = 0; i < batch->numJobs; ++i) {
+		CnLoadJob* job = &jobs[batch->jobs[i]];
+		if (!job->decoded) {
+			batch->uploaded[i] = false;
+			continue;
+		}
+		switch (job->kind) {
+			case CnLoadKindSprite:
+				batch->uploaded[i] = cnRLL_UploadSprite(job->resourceId, &job->image, job->path.str);
+				break;
+			case CnLoadKindFont:
+				// The renderer takes ownership of the font's contents.
+				batch->uploaded[i] = cnRLL_UploadPSF2Font(job->resourceId, job->font);
+				break;
+			default:
+				CN_FATAL_ERROR("Unknown load kind: %i", (int)job->kind);
+		}
+	}
+}
+
+static void cnRAsync_Finish(CnLoadJob* job, bool uploaded)
+{
+	if (!uploaded) {
+		CN_ERROR(LogSysRender, "Unable to load: %s", job->path.str);
+	}
+
+	const CnLoadStatus status = uploaded ? CnLoadStatusReady : CnLoadStatusFailed;
+	*cnRAsync_StatusFor(job->kind, job->resourceId) = status;
+	if (job->onLoaded) {
+		job->onLoaded(CN_LOAD_ID_MAKE(job->kind, job->resourceId), status, job->userData);
+	}
+}
+
+/**
+ * Uploads decoded resources to GL, stopping once the upload budget for this
+ * frame is spent.  Must be called on the main thread.
+ */
+void cnRAsync_DrainUploads(void)
+{
+	if (!loadLock) {
+		return;
+	}
+
+	CnUploadBatch batch;
+	batch.numJobs = 0;
+	uint32_t uploadedBytes = 0;
+	bool anyDecoded = false;
+
+	SDL_LockMutex(loadLock);
+	while (uploadQueue.count > 0) {
+		// Always make progress, even if a single resource exceeds the budget.
+		const uint32_t next = cnLoadQueue_Peek(&uploadQueue);
+		if (batch.numJobs > 0 && uploadedBytes + jobs[next].uploadSize > uploadBudget) {
+			break;
+		}
+		cnLoadQueue_Pop(&uploadQueue);
+		batch.jobs[batch.numJobs++] = next;
+		uploadedBytes += jobs[next].uploadSize;
+		anyDecoded = anyDecoded || jobs[next].decoded;
+	}
+	SDL_UnlockMutex(loadLock);
+
+	if (batch.numJobs == 0) {
+		return;
+	}
+
+	if (anyDecoded) {
+		cnRThread_Call(cnRAsync_UploadToGL, &batch);
+	}
+	else {
+		memset(batch.uploaded, 0, sizeof(batch.uploaded));
+	}
+
+	// Callbacks run on the main thread, after the whole batch is uploaded.
+	for (uint32_t i = 0; i < batch.numJobs; ++i) {
+		cnRAsync_Finish(&jobs[batch.jobs[i]], batch.uploaded[i]);
+		cnRAsync_ReleaseJob(batch.jobs[i]);
+	}
+
+	CN_TRACE(LogSysRender, "Uploaded %" PRIu32 " loads (%" PRIu32 " bytes)", batch.numJobs, uploadedBytes);
+}
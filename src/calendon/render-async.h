@@ -0,0 +1,41 @@
+#ifndef CN_RENDER_ASYNC_H
+#define CN_RENDER_ASYNC_H
+
+/**
+ * @file render-async.h
+ *
+ * Asynchronous loading of render resources.
+ *
+ * Reading and decoding happen on a pool of worker threads.  Only the thread
+ * submitting to GL touches it, so decoded resources are queued and uploaded at
+ * the start of the next frame, within a per-frame budget.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/color.h>
+#include <calendon/math2.h>
+#include <calendon/render-resources.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The default number of bytes of texture data to upload per frame.
+ */
+#define CN_RENDER_DEFAULT_UPLOAD_BUDGET (8 * 1024 * 1024)
+
+CN_TEST_API void         cnRAsync_Init(void);
+CN_TEST_API void         cnRAsync_Shutdown(void);
+CN_TEST_API CnLoadId     cnRAsync_QueueSprite(CnSpriteId id, const char* path, CnLoadCallbackFn onLoaded, void* userData);
+CN_TEST_API CnLoadId     cnRAsync_QueueFont(CnFontId id, const char* path, CnLoadCallbackFn onLoaded, void* userData);
+CN_TEST_API CnLoadStatus cnRAsync_Status(CnLoadId load);
+CN_TEST_API void         cnRAsync_SetUploadBudget(uint32_t bytesPerFrame);
+CN_TEST_API void         cnRAsync_DrainUploads(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_RENDER_ASYNC_H */
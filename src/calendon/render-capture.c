@@ -0,0 +1,398 @@
+#include "render-capture.h"
+
+#include <calendon/compat-sdl.h>
+#include <calendon/log.h>
+#include <calendon/path.h>
+
+#include <stdio.h>
+#include <string.h>
+
+extern uint32_t LogSysRender;
+
+typedef struct {
+	CnImageRGBA8 image;
+	uint64_t number;
+} CnCaptureFrame;
+
+/**
+ * Frames are either free, or queued for the worker.  The queue and free list
+ * are guarded by `captureLock`.
+ */
+static CnCaptureFrame frames[CN_CAPTURE_MAX_FRAMES];
+static CnCaptureFrame* freeFrames[CN_CAPTURE_MAX_FRAMES];
+static uint32_t numFreeFrames;
+static CnCaptureFrame* queuedFrames[CN_CAPTURE_MAX_FRAMES];
+static uint32_t queueHead;
+static uint32_t numQueuedFrames;
+
+static SDL_mutex* captureLock;
+static SDL_cond* frameQueued;
+static SDL_Thread* worker;
+static bool workerQuit;
+
+static CnPathBuffer captureDirectory;
+static CnCaptureFormat captureFormat;
+static uint8_t* encodeBuffer;
+static uint64_t nextFrameNumber;
+
+/**
+ * Stats written by the worker are guarded by `captureLock`, the rest are only
+ * touched on the main thread.
+ */
+static CnCaptureStats stats;
+static uint64_t lastReadbackMicros;
+static uint64_t totalReadbackMicros;
+static uint32_t numReadbacks;
+static uint64_t totalEncodeMicros;
+
+//
+// QOI encoding, see https://qoiformat.org/qoi-specification.pdf
+//
+#define CN_QOI_HEADER_SIZE 14
+#define CN_QOI_END_SIZE 8
+#define CN_QOI_OP_INDEX 0x00
+#define CN_QOI_OP_DIFF 0x40
+#define CN_QOI_OP_LUMA 0x80
+#define CN_QOI_OP_RUN 0xC0
+#define CN_QOI_OP_RGB 0xFE
+#define CN_QOI_OP_RGBA 0xFF
+#define CN_QOI_MAX_RUN 62
+
+static uint8_t* cnRCapture_WriteU32BE(uint8_t* out, uint32_t value)
+{
+	out[0] = (uint8_t)(value >> 24);
+	out[1] = (uint8_t)(value >> 16);
+	out[2] = (uint8_t)(value >> 8);
+	out[3] = (uint8_t)value;
+	return out + 4;
+}
+
+/**
+ * The most bytes a QOI image can encode to, when every pixel needs a full
+ * RGBA op.
+ */
+size_t cnRCapture_MaxQOISize(CnDimension2u32 size)
+{
+	return CN_QOI_HEADER_SIZE + (size_t)size.width * size.height * 5 + CN_QOI_END_SIZE;
+}
+
+/**
+ * Encodes an image as QOI, with rows in the same order as in memory.
+ *
+ * @param out space for `cnRCapture_MaxQOISize` bytes
+ * @return the number of bytes encoded
+ */
+size_t cnRCapture_EncodeQOI(const CnImageRGBA8* image, uint8_t* out)
+{
+	CN_ASSERT_PTR(image);
+	CN_ASSERT_PTR(out);
+
+	uint8_t* cursor = out;
+	memcpy(cursor, "qoif", 4);
+	cursor = cnRCapture_WriteU32BE(cursor + 4, image->width);
+	cursor = cnRCapture_WriteU32BE(cursor, image->height);
+	*cursor++ = 4;
+	*cursor++ = 0;
+
+	uint8_t seen[64][4];
+	memset(seen, 0, sizeof(seen));
+	uint8_t prev[4] = { 0, 0, 0, 255 };
+	uint32_t run = 0;
+
+	const uint8_t* pixels = (const uint8_t*)image->pixels.contents;
+	const size_t numPixels = (size_t)image->width * image->height;
+	for (size_t i = 0; i < numPixels; ++i) {
+		const uint8_t* px = pixels + 4 * i;
+		if (memcmp(px, prev, 4) == 0) {
+			++run;
+			if (run == CN_QOI_MAX_RUN || i + 1 == numPixels) {
+				*cursor++ = (uint8_t)(CN_QOI_OP_RUN | (run - 1));
+				run = 0;
+			}
+			continue;
+		}
+		if (run > 0) {
+			*cursor++ = (uint8_t)(CN_QOI_OP_RUN | (run - 1));
+			run = 0;
+		}
+
+		const uint32_t hash = (px[0] * 3u + px[1] * 5u + px[2] * 7u + px[3] * 11u) % 64;
+		if (memcmp(seen[hash], px, 4) == 0) {
+			*cursor++ = (uint8_t)(CN_QOI_OP_INDEX | hash);
+		}
+		else {
+			memcpy(seen[hash], px, 4);
+			if (px[3] == prev[3]) {
+				const int8_t dr = (int8_t)(px[0] - prev[0]);
+				const int8_t dg = (int8_t)(px[1] - prev[1]);
+				const int8_t db = (int8_t)(px[2] - prev[2]);
+				const int8_t drg = (int8_t)(dr - dg);
+				const int8_t dbg = (int8_t)(db - dg);
+				if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+					*cursor++ = (uint8_t)(CN_QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+				}
+				else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+					*cursor++ = (uint8_t)(CN_QOI_OP_LUMA | (dg + 32));
+					*cursor++ = (uint8_t)((drg + 8) << 4 | (dbg + 8));
+				}
+				else {
+					*cursor++ = CN_QOI_OP_RGB;
+					memcpy(cursor, px, 3);
+					cursor += 3;
+				}
+			}
+			else {
+				*cursor++ = CN_QOI_OP_RGBA;
+				memcpy(cursor, px, 4);
+				cursor += 4;
+			}
+		}
+		memcpy(prev, px, 4);
+	}
+
+	memset(cursor, 0, CN_QOI_END_SIZE - 1);
+	cursor[CN_QOI_END_SIZE - 1] = 1;
+	cursor += CN_QOI_END_SIZE;
+	return (size_t)(cursor - out);
+}
+
+/**
+ * Flips a frame read back from GL to be top down, encodes it and writes it
+ * out.  Runs on the worker thread.
+ *
+ * @return the bytes written, or zero on failure
+ */
+static size_t cnRCapture_WriteFrame(CnCaptureFrame* frame)
+{
+	cnImageRGBA8_Flip(&frame->image);
+
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "frame-%06" PRIu64 ".%s", frame->number,
+		captureFormat == CnCaptureFormatQOI ? "qoi" : "pam");
+	CnPathBuffer path = captureDirectory;
+	if (!cnPathBuffer_Join(&path, fileName)) {
+		return 0;
+	}
+
+	FILE* file = fopen(path.str, "wb");
+	if (!file) {
+		CN_WARN(LogSysRender, "Unable to write captured frame: %s", path.str);
+		return 0;
+	}
+
+	size_t size = 0;
+	bool written = false;
+	if (captureFormat == CnCaptureFormatQOI) {
+		size = cnRCapture_EncodeQOI(&frame->image, encodeBuffer);
+		written = fwrite(encodeBuffer, 1, size, file) == size;
+	}
+	else {
+		char header[128];
+		const int headerSize = snprintf(header, sizeof(header),
+			"P7\nWIDTH %" PRIu32 "\nHEIGHT %" PRIu32 "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+			frame->image.width, frame->image.height);
+		size = (size_t)headerSize + frame->image.pixels.size;
+		written = fwrite(header, 1, (size_t)headerSize, file) == (size_t)headerSize
+			&& fwrite(frame->image.pixels.contents, 1, frame->image.pixels.size, file) == frame->image.pixels.size;
+	}
+	fclose(file);
+
+	if (!written) {
+		CN_WARN(LogSysRender, "Unable to write captured frame: %s", path.str);
+		return 0;
+	}
+	return size;
+}
+
+static int cnRCapture_Worker(void* unused)
+{
+	CN_UNUSED(unused);
+	for (;;) {
+		SDL_LockMutex(captureLock);
+		while (!workerQuit && numQueuedFrames == 0) {
+			SDL_CondWait(frameQueued, captureLock);
+		}
+
+		// Frames already queued are still written when stopping.
+		if (numQueuedFrames == 0) {
+			SDL_UnlockMutex(captureLock);
+			return 0;
+		}
+		CnCaptureFrame* frame = queuedFrames[queueHead];
+		queueHead = (queueHead + 1) % CN_CAPTURE_MAX_FRAMES;
+		--numQueuedFrames;
+		SDL_UnlockMutex(captureLock);
+
+		const uint64_t start = SDL_GetPerformanceCounter();
+		const size_t size = cnRCapture_WriteFrame(frame);
+		const uint64_t micros = (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+
+		SDL_LockMutex(captureLock);
+		if (size > 0) {
+			++stats.framesWritten;
+			stats.bytesWritten += size;
+			totalEncodeMicros += micros;
+		}
+		freeFrames[numFreeFrames++] = frame;
+		SDL_UnlockMutex(captureLock);
+	}
+}
+
+/**
+ * Starts writing frames of a given size to numbered files in a directory.
+ */
+bool cnRCapture_Start(const char* directory, CnCaptureFormat format, CnDimension2u32 size)
+{
+	CN_ASSERT_PTR(directory);
+	CN_ASSERT(worker == NULL, "Capture has already started");
+
+	if (!cnPath_IsDir(directory) || !cnPathBuffer_Set(&captureDirectory, directory)) {
+		CN_WARN(LogSysRender, "Capture directory does not exist: %s", directory);
+		return false;
+	}
+
+	captureFormat = format;
+	nextFrameNumber = 0;
+	memset(&stats, 0, sizeof(CnCaptureStats));
+	lastReadbackMicros = 0;
+	totalReadbackMicros = 0;
+	numReadbacks = 0;
+	totalEncodeMicros = 0;
+
+	for (uint32_t i = 0; i < CN_CAPTURE_MAX_FRAMES; ++i) {
+		cnImageRGBA8_AllocateSized(&frames[i].image, size);
+		freeFrames[i] = &frames[i];
+	}
+	numFreeFrames = CN_CAPTURE_MAX_FRAMES;
+	queueHead = 0;
+	numQueuedFrames = 0;
+
+	encodeBuffer = format == CnCaptureFormatQOI ? (uint8_t*)malloc(cnRCapture_MaxQOISize(size)) : NULL;
+	captureLock = SDL_CreateMutex();
+	frameQueued = SDL_CreateCond();
+	workerQuit = false;
+	if ((format == CnCaptureFormatQOI && !encodeBuffer) || !captureLock || !frameQueued) {
+		CN_WARN(LogSysRender, "Unable to start capture: %s", SDL_GetError());
+		cnRCapture_Stop();
+		return false;
+	}
+
+	worker = SDL_CreateThread(cnRCapture_Worker, "CnCaptureWorker", NULL);
+	if (!worker) {
+		CN_WARN(LogSysRender, "Unable to create capture worker: %s", SDL_GetError());
+		cnRCapture_Stop();
+		return false;
+	}
+
+	CN_TRACE(LogSysRender, "Capturing %" PRIu32 "x%" PRIu32 " frames to %s", size.width, size.height,
+		captureDirectory.str);
+	return true;
+}
+
+/**
+ * Writes out frames which have been submitted and stops the worker.
+ */
+void cnRCapture_Stop(void)
+{
+	if (worker) {
+		SDL_LockMutex(captureLock);
+		workerQuit = true;
+		SDL_CondSignal(frameQueued);
+		SDL_UnlockMutex(captureLock);
+		SDL_WaitThread(worker, NULL);
+		worker = NULL;
+
+		CnCaptureStats finalStats;
+		cnRCapture_Stats(&finalStats);
+		CN_TRACE(LogSysRender, "Captured %" PRIu32 " frames, dropped %" PRIu32 ", readback %" PRIu64
+			" us/frame, encode %" PRIu64 " us/frame", finalStats.framesWritten, finalStats.framesDropped,
+			finalStats.averageReadbackMicros, finalStats.averageEncodeMicros);
+	}
+
+	for (uint32_t i = 0; i < CN_CAPTURE_MAX_FRAMES; ++i) {
+		if (frames[i].image.pixels.contents) {
+			cnImageRGBA8_Free(&frames[i].image);
+		}
+	}
+	memset(frames, 0, sizeof(frames));
+	numFreeFrames = 0;
+	numQueuedFrames = 0;
+
+	free(encodeBuffer);
+	encodeBuffer = NULL;
+	if (frameQueued) {
+		SDL_DestroyCond(frameQueued);
+		frameQueued = NULL;
+	}
+	if (captureLock) {
+		SDL_DestroyMutex(captureLock);
+		captureLock = NULL;
+	}
+}
+
+bool cnRCapture_IsActive(void)
+{
+	return worker != NULL;
+}
+
+/**
+ * Provides an image to read a frame into, or NULL if the worker has fallen
+ * behind and the frame should be dropped.
+ */
+CnImageRGBA8* cnRCapture_AcquireFrame(void)
+{
+	CN_ASSERT(worker != NULL, "Capture has not started");
+
+	CnCaptureFrame* frame = NULL;
+	SDL_LockMutex(captureLock);
+	if (numFreeFrames > 0) {
+		frame = freeFrames[--numFreeFrames];
+	}
+	else {
+		++stats.framesDropped;
+	}
+	SDL_UnlockMutex(captureLock);
+	return frame ? &frame->image : NULL;
+}
+
+/**
+ * Queues an acquired image to be written, numbered in the order submitted.
+ */
+void cnRCapture_SubmitFrame(CnImageRGBA8* image)
+{
+	CN_ASSERT_PTR(image);
+	CnCaptureFrame* frame = (CnCaptureFrame*)image;
+	CN_ASSERT(frame >= frames && frame < frames + CN_CAPTURE_MAX_FRAMES, "Submitting an image not from capture");
+
+	SDL_LockMutex(captureLock);
+	frame->number = nextFrameNumber++;
+	queuedFrames[(queueHead + numQueuedFrames) % CN_CAPTURE_MAX_FRAMES] = frame;
+	++numQueuedFrames;
+	SDL_CondSignal(frameQueued);
+	SDL_UnlockMutex(captureLock);
+}
+
+/**
+ * Records the main thread time spent reading back a frame.
+ */
+void cnRCapture_RecordReadback(uint64_t micros)
+{
+	lastReadbackMicros = micros;
+	totalReadbackMicros += micros;
+	++numReadbacks;
+}
+
+void cnRCapture_Stats(CnCaptureStats* result)
+{
+	CN_ASSERT_PTR(result);
+	if (captureLock) {
+		SDL_LockMutex(captureLock);
+	}
+	*result = stats;
+	result->lastReadbackMicros = lastReadbackMicros;
+	result->averageReadbackMicros = numReadbacks > 0 ? totalReadbackMicros / numReadbacks : 0;
+	result->averageEncodeMicros = stats.framesWritten > 0 ? totalEncodeMicros / stats.framesWritten : 0;
+	if (captureLock) {
+		SDL_UnlockMutex(captureLock);
+	}
+}
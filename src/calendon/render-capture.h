@@ -0,0 +1,42 @@
+#ifndef CN_RENDER_CAPTURE_H
+#define CN_RENDER_CAPTURE_H
+
+/**
+ * @file render-capture.h
+ *
+ * Writing captured frames to disk.
+ *
+ * The renderer reads frames back from the GPU into a small pool of images,
+ * which a worker thread flips, encodes and writes out, so the main thread
+ * never waits on encoding or disk.  When every image in the pool is waiting
+ * on the worker, frames are dropped rather than stalling the main thread.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/dimension.h>
+#include <calendon/image.h>
+#include <calendon/render-resources.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CN_CAPTURE_MAX_FRAMES 4
+
+bool          cnRCapture_Start(const char* directory, CnCaptureFormat format, CnDimension2u32 size);
+void          cnRCapture_Stop(void);
+bool          cnRCapture_IsActive(void);
+CnImageRGBA8* cnRCapture_AcquireFrame(void);
+void          cnRCapture_SubmitFrame(CnImageRGBA8* frame);
+void          cnRCapture_RecordReadback(uint64_t micros);
+void          cnRCapture_Stats(CnCaptureStats* stats);
+
+CN_TEST_API size_t cnRCapture_MaxQOISize(CnDimension2u32 size);
+CN_TEST_API size_t cnRCapture_EncodeQOI(const CnImageRGBA8* image, uint8_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_RENDER_CAPTURE_H */
@@ -0,0 +1,431 @@
+#include "render-commands.h"
+
+#include <calendon/render-ll.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CN_RCOMMANDS_INITIAL_COMMANDS 256
+#define CN_RCOMMANDS_INITIAL_DATA 4096
+
+/**
+ * Copied data is aligned so points can be read in place.
+ */
+#define CN_RCOMMANDS_DATA_ALIGNMENT 8
+
+void cnRCommandList_Init(CnRCommandList* list)
+{
+	CN_ASSERT_PTR(list);
+	memset(list, 0, sizeof(CnRCommandList));
+}
+
+void cnRCommandList_Free(CnRCommandList* list)
+{
+	CN_ASSERT_PTR(list);
+	free(list->commands);
+	free(list->data);
+	memset(list, 0, sizeof(CnRCommandList));
+}
+
+/**
+ * Empties a list for recording again, keeping its storage.
+ */
+void cnRCommandList_Clear(CnRCommandList* list)
+{
+	CN_ASSERT_PTR(list);
+	list->numCommands = 0;
+	list->dataSize = 0;
+}
+
+CnRCommand* cnRCommandList_Add(CnRCommandList* list, CnRCommandType type)
+{
+	CN_ASSERT_PTR(list);
+	if (list->numCommands == list->commandCapacity) {
+		const uint32_t capacity = list->commandCapacity == 0
+			? CN_RCOMMANDS_INITIAL_COMMANDS : 2 * list->commandCapacity;
+		CnRCommand* commands = (CnRCommand*)realloc(list->commands, capacity * sizeof(CnRCommand));
+		if (!commands) {
+			CN_FATAL_ERROR("Unable to grow render command list to %" PRIu32 " commands", capacity);
+		}
+		list->commands = commands;
+		list->commandCapacity = capacity;
+	}
+
+	CnRCommand* command = &list->commands[list->numCommands++];
+	command->type = type;
+	return command;
+}
+
+/**
+ * Copies data into the list.
+ *
+ * @return the offset of the copy, which stays valid as the list grows
+ */
+uint32_t cnRCommandList_AddData(CnRCommandList* list, const void* data, uint32_t size)
+{
+	CN_ASSERT_PTR(list);
+	CN_ASSERT(data != NULL || size == 0, "Cannot copy from null data.");
+
+	const uint32_t alignMask = CN_RCOMMANDS_DATA_ALIGNMENT - 1;
+	const uint32_t offset = (list->dataSize + alignMask) & ~alignMask;
+	if (offset + size > list->dataCapacity) {
+		uint32_t capacity = list->dataCapacity == 0 ? CN_RCOMMANDS_INITIAL_DATA : list->dataCapacity;
+		while (offset + size > capacity) {
+			capacity *= 2;
+		}
+		char* grown = (char*)realloc(list->data, capacity);
+		if (!grown) {
+			CN_FATAL_ERROR("Unable to grow render command data to %" PRIu32 " bytes", capacity);
+		}
+		list->data = grown;
+		list->dataCapacity = capacity;
+	}
+
+	if (size > 0) {
+		memcpy(list->data + offset, data, size);
+	}
+	list->dataSize = offset + size;
+	return offset;
+}
+
+/**
+ * Performs every command in the list in the order they were recorded.
+ */
+void cnRCommandList_Replay(const CnRCommandList* list)
+{
+	CN_ASSERT_PTR(list);
+	for (uint32_t i = 0; i < list->numCommands; ++i) {
+		const CnRCommand* command = &list->commands[i];
+		switch (command->type) {
+			case CnRCommandInvoke:
+				command->args.invoke.fn(command->args.invoke.data);
+				break;
+			case CnRCommandStartFrame:
+				cnRLL_StartFrame();
+				break;
+			case CnRCommandEndFrame:
+				cnRLL_EndFrame();
+				break;
+			case CnRCommandClear:
+				cnRLL_Clear(command->args.clearColor);
+				break;
+			case CnRCommandSetViewport:
+				cnRLL_SetViewport(command->args.area);
+				break;
+			case CnRCommandSetCamera:
+				cnRLL_SetCameraAABB2(command->args.area);
+				break;
+			case CnRCommandSetDynamicResolution:
+				cnRLL_SetDynamicResolution(command->args.dynamicResolution.budgetMicros,
+					command->args.dynamicResolution.minScale);
+				break;
+			case CnRCommandSetMaxFramesInFlight:
+				cnRLL_SetMaxFramesInFlight(command->args.count);
+				break;
+			case CnRCommandSetTextureBudget:
+				cnRLL_SetTextureBudget(command->args.bytes);
+				break;
+			case CnRCommandSetSpriteArrays:
+				cnRLL_SetSpriteArrays(command->args.enabled);
+				break;
+			case CnRCommandReserveSprite:
+				cnRLL_ReserveSprite(command->args.id);
+				break;
+			case CnRCommandDrawSprite:
+				cnRLL_DrawSprite(command->args.draw.id, command->args.draw.position, command->args.draw.size);
+				break;
+			case CnRCommandDrawSimpleText: {
+				CnTextDrawParams params = command->args.text.params;
+				cnRLL_DrawSimpleText(command->args.text.id, &params, list->data + command->args.text.offset);
+				break;
+			}
+			case CnRCommandDrawDebugFullScreenRect:
+				cnRLL_DrawDebugFullScreenRect();
+				break;
+			case CnRCommandDrawDebugRect:
+				cnRLL_DrawDebugRect(command->args.rect.center, command->args.rect.dimensions,
+					command->args.rect.color);
+				break;
+			case CnRCommandDrawDebugLine:
+				cnRLL_DrawDebugLine(command->args.line.from.x, command->args.line.from.y,
+					command->args.line.to.x, command->args.line.to.y, command->args.line.color);
+				break;
+			case CnRCommandDrawDebugLineStrip:
+				cnRLL_DrawDebugLineStrip((CnFloat2*)(list->data + command->args.lineStrip.offset),
+					command->args.lineStrip.numPoints, command->args.lineStrip.color);
+				break;
+			case CnRCommandDrawDebugFont:
+				cnRLL_DrawDebugFont(command->args.draw.id, command->args.draw.position, command->args.draw.size);
+				break;
+			case CnRCommandDrawMesh:
+				cnRLL_DrawMesh(command->args.mesh.id, command->args.mesh.transform, command->args.mesh.color);
+				break;
+			case CnRCommandDestroyMesh:
+				cnRLL_DestroyMesh(command->args.id);
+				break;
+			case CnRCommandDestroyLayer:
+				cnRLL_DestroyLayer(command->args.id);
+				break;
+			case CnRCommandMarkLayerDirty:
+				cnRLL_MarkLayerDirty(command->args.id);
+				break;
+			case CnRCommandBeginLayer: {
+				// Whether the layer is drawn was decided when recording, from
+				// the same dirty state.
+				const bool begun = cnRLL_BeginLayer(command->args.id);
+				CN_ASSERT(begun, "Recorded layer %" PRIu32 " was not dirty when replayed", command->args.id);
+				CN_UNUSED(begun);
+				break;
+			}
+			case CnRCommandEndLayer:
+				cnRLL_EndLayer();
+				break;
+			case CnRCommandDrawLayer:
+				cnRLL_DrawLayer(command->args.id);
+				break;
+			case CnRCommandDestroyTilemap:
+				cnRLL_DestroyTilemap(command->args.id);
+				break;
+			case CnRCommandSetTile:
+				cnRLL_SetTile(command->args.tile.id, command->args.tile.position, command->args.tile.tile);
+				break;
+			case CnRCommandDrawTilemap:
+				cnRLL_DrawTilemap(command->args.draw.id, command->args.draw.position, command->args.draw.size);
+				break;
+			case CnRCommandDrawRect:
+				cnRLL_DrawRect(command->args.rect.center, command->args.rect.dimensions, command->args.rect.color,
+					command->args.rect.transform);
+				break;
+			case CnRCommandOutlineRect:
+				cnRLL_OutlineRect(command->args.rect.center, command->args.rect.dimensions, command->args.rect.color,
+					command->args.rect.transform);
+				break;
+			case CnRCommandOutlineCircle:
+				cnRLL_OutlineCircle(command->args.circle.center, command->args.circle.radius,
+					command->args.circle.color, command->args.circle.numSegments);
+				break;
+			case CnRCommandFillScreen:
+				cnRLL_FillScreen(command->args.color);
+				break;
+			default:
+				CN_FATAL_ERROR("Unknown render command: %i", (int)command->type);
+		}
+	}
+}
+
+/**
+ * Records a function to call on the render thread, such as one which creates
+ * a resource.
+ */
+void cnRCommands_Invoke(CnRCommandList* list, CnRInvokeFn fn, void* data)
+{
+	CN_ASSERT_PTR(fn);
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandInvoke);
+	command->args.invoke.fn = fn;
+	command->args.invoke.data = data;
+}
+
+void cnRCommands_StartFrame(CnRCommandList* list)
+{
+	cnRCommandList_Add(list, CnRCommandStartFrame);
+}
+
+void cnRCommands_EndFrame(CnRCommandList* list)
+{
+	cnRCommandList_Add(list, CnRCommandEndFrame);
+}
+
+void cnRCommands_Clear(CnRCommandList* list, CnRGBA8u color)
+{
+	cnRCommandList_Add(list, CnRCommandClear)->args.clearColor = color;
+}
+
+void cnRCommands_SetViewport(CnRCommandList* list, CnAABB2 viewport)
+{
+	cnRCommandList_Add(list, CnRCommandSetViewport)->args.area = viewport;
+}
+
+void cnRCommands_SetCameraAABB2(CnRCommandList* list, CnAABB2 area)
+{
+	cnRCommandList_Add(list, CnRCommandSetCamera)->args.area = area;
+}
+
+void cnRCommands_SetDynamicResolution(CnRCommandList* list, uint64_t budgetMicros, float minScale)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandSetDynamicResolution);
+	command->args.dynamicResolution.budgetMicros = budgetMicros;
+	command->args.dynamicResolution.minScale = minScale;
+}
+
+void cnRCommands_SetMaxFramesInFlight(CnRCommandList* list, uint32_t frames)
+{
+	cnRCommandList_Add(list, CnRCommandSetMaxFramesInFlight)->args.count = frames;
+}
+
+void cnRCommands_SetTextureBudget(CnRCommandList* list, uint64_t bytes)
+{
+	cnRCommandList_Add(list, CnRCommandSetTextureBudget)->args.bytes = bytes;
+}
+
+void cnRCommands_SetSpriteArrays(CnRCommandList* list, bool enabled)
+{
+	cnRCommandList_Add(list, CnRCommandSetSpriteArrays)->args.enabled = enabled;
+}
+
+void cnRCommands_ReserveSprite(CnRCommandList* list, CnSpriteId id)
+{
+	cnRCommandList_Add(list, CnRCommandReserveSprite)->args.id = id;
+}
+
+void cnRCommands_DrawSprite(CnRCommandList* list, CnSpriteId id, CnFloat2 position, CnDimension2f size)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawSprite);
+	command->args.draw.id = id;
+	command->args.draw.position = position;
+	command->args.draw.size = size;
+}
+
+void cnRCommands_DrawSimpleText(CnRCommandList* list, CnFontId id, const CnTextDrawParams* params, const char* text)
+{
+	CN_ASSERT_PTR(params);
+	CN_ASSERT_PTR(text);
+	const uint32_t offset = cnRCommandList_AddData(list, text, (uint32_t)strlen(text) + 1);
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawSimpleText);
+	command->args.text.id = id;
+	command->args.text.params = *params;
+	command->args.text.offset = offset;
+}
+
+void cnRCommands_DrawDebugFullScreenRect(CnRCommandList* list)
+{
+	cnRCommandList_Add(list, CnRCommandDrawDebugFullScreenRect);
+}
+
+void cnRCommands_DrawDebugRect(CnRCommandList* list, CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawDebugRect);
+	command->args.rect.center = center;
+	command->args.rect.dimensions = dimensions;
+	command->args.rect.color = color;
+}
+
+void cnRCommands_DrawDebugLine(CnRCommandList* list, float x1, float y1, float x2, float y2, CnOpaqueColor color)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawDebugLine);
+	command->args.line.from = cnFloat2_Make(x1, y1);
+	command->args.line.to = cnFloat2_Make(x2, y2);
+	command->args.line.color = color;
+}
+
+void cnRCommands_DrawDebugLineStrip(CnRCommandList* list, const CnFloat2* points, uint32_t numPoints,
+	CnOpaqueColor color)
+{
+	CN_ASSERT(points != NULL || numPoints == 0, "Cannot draw a line strip from null points.");
+	const uint32_t offset = cnRCommandList_AddData(list, points, numPoints * (uint32_t)sizeof(CnFloat2));
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawDebugLineStrip);
+	command->args.lineStrip.offset = offset;
+	command->args.lineStrip.numPoints = numPoints;
+	command->args.lineStrip.color = color;
+}
+
+void cnRCommands_DrawDebugFont(CnRCommandList* list, CnFontId id, CnFloat2 center, CnDimension2f size)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawDebugFont);
+	command->args.draw.id = id;
+	command->args.draw.position = center;
+	command->args.draw.size = size;
+}
+
+void cnRCommands_DrawMesh(CnRCommandList* list, CnMeshId id, CnFloat4x4 transform, CnOpaqueColor color)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawMesh);
+	command->args.mesh.id = id;
+	command->args.mesh.transform = transform;
+	command->args.mesh.color = color;
+}
+
+void cnRCommands_DestroyMesh(CnRCommandList* list, CnMeshId id)
+{
+	cnRCommandList_Add(list, CnRCommandDestroyMesh)->args.id = id;
+}
+
+void cnRCommands_DestroyLayer(CnRCommandList* list, CnLayerId id)
+{
+	cnRCommandList_Add(list, CnRCommandDestroyLayer)->args.id = id;
+}
+
+void cnRCommands_MarkLayerDirty(CnRCommandList* list, CnLayerId id)
+{
+	cnRCommandList_Add(list, CnRCommandMarkLayerDirty)->args.id = id;
+}
+
+void cnRCommands_BeginLayer(CnRCommandList* list, CnLayerId id)
+{
+	cnRCommandList_Add(list, CnRCommandBeginLayer)->args.id = id;
+}
+
+void cnRCommands_EndLayer(CnRCommandList* list)
+{
+	cnRCommandList_Add(list, CnRCommandEndLayer);
+}
+
+void cnRCommands_DrawLayer(CnRCommandList* list, CnLayerId id)
+{
+	cnRCommandList_Add(list, CnRCommandDrawLayer)->args.id = id;
+}
+
+void cnRCommands_DestroyTilemap(CnRCommandList* list, CnTilemapId id)
+{
+	cnRCommandList_Add(list, CnRCommandDestroyTilemap)->args.id = id;
+}
+
+void cnRCommands_SetTile(CnRCommandList* list, CnTilemapId id, CnRowColu32 position, CnTile tile)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandSetTile);
+	command->args.tile.id = id;
+	command->args.tile.position = position;
+	command->args.tile.tile = tile;
+}
+
+void cnRCommands_DrawTilemap(CnRCommandList* list, CnTilemapId id, CnFloat2 origin, CnDimension2f tileSize)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawTilemap);
+	command->args.draw.id = id;
+	command->args.draw.position = origin;
+	command->args.draw.size = tileSize;
+}
+
+void cnRCommands_DrawRect(CnRCommandList* list, CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color,
+	CnFloat4x4 transform)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandDrawRect);
+	command->args.rect.center = center;
+	command->args.rect.dimensions = dimensions;
+	command->args.rect.color = color;
+	command->args.rect.transform = transform;
+}
+
+void cnRCommands_OutlineRect(CnRCommandList* list, CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color,
+	CnFloat4x4 transform)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandOutlineRect);
+	command->args.rect.center = center;
+	command->args.rect.dimensions = dimensions;
+	command->args.rect.color = color;
+	command->args.rect.transform = transform;
+}
+
+void cnRCommands_OutlineCircle(CnRCommandList* list, CnFloat2 center, float radius, CnOpaqueColor color,
+	uint32_t numSegments)
+{
+	CnRCommand* command = cnRCommandList_Add(list, CnRCommandOutlineCircle);
+	command->args.circle.center = center;
+	command->args.circle.radius = radius;
+	command->args.circle.color = color;
+	command->args.circle.numSegments = numSegments;
+}
+
+void cnRCommands_FillScreen(CnRCommandList* list, CnOpaqueColor color)
+{
+	cnRCommandList_Add(list, CnRCommandFillScreen)->args.color = color;
+}
@@ -0,0 +1,192 @@
+#ifndef CN_RENDER_COMMANDS_H
+#define CN_RENDER_COMMANDS_H
+
+/**
+ * @file render-commands.h
+ *
+ * Recorded render commands.
+ *
+ * When the renderer runs on its own thread, render calls made on the main
+ * thread are recorded into a command list and replayed against the low level
+ * renderer later.  Text and points are copied into the list, so callers can
+ * reuse them as soon as the call returns.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/color.h>
+#include <calendon/dimension.h>
+#include <calendon/math2.h>
+#include <calendon/math4.h>
+#include <calendon/render-resources.h>
+#include <calendon/row-col.h>
+#include <calendon/tilemap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*CnRInvokeFn)(void* data);
+
+typedef enum {
+	CnRCommandInvoke,
+	CnRCommandStartFrame,
+	CnRCommandEndFrame,
+	CnRCommandClear,
+	CnRCommandSetViewport,
+	CnRCommandSetCamera,
+	CnRCommandSetDynamicResolution,
+	CnRCommandSetMaxFramesInFlight,
+	CnRCommandSetTextureBudget,
+	CnRCommandSetSpriteArrays,
+	CnRCommandReserveSprite,
+	CnRCommandDrawSprite,
+	CnRCommandDrawSimpleText,
+	CnRCommandDrawDebugFullScreenRect,
+	CnRCommandDrawDebugRect,
+	CnRCommandDrawDebugLine,
+	CnRCommandDrawDebugLineStrip,
+	CnRCommandDrawDebugFont,
+	CnRCommandDrawMesh,
+	CnRCommandDestroyMesh,
+	CnRCommandDestroyLayer,
+	CnRCommandMarkLayerDirty,
+	CnRCommandBeginLayer,
+	CnRCommandEndLayer,
+	CnRCommandDrawLayer,
+	CnRCommandDestroyTilemap,
+	CnRCommandSetTile,
+	CnRCommandDrawTilemap,
+	CnRCommandDrawRect,
+	CnRCommandOutlineRect,
+	CnRCommandOutlineCircle,
+	CnRCommandFillScreen
+} CnRCommandType;
+
+/**
+ * A single recorded call.  Variable length arguments are stored in the data of
+ * the list, at `offset`.
+ */
+typedef struct {
+	CnRCommandType type;
+	union {
+		struct {
+			CnRInvokeFn fn;
+			void* data;
+		} invoke;
+		struct {
+			uint32_t id;
+			CnFloat2 position;
+			CnDimension2f size;
+		} draw;
+		struct {
+			uint32_t id;
+			CnTextDrawParams params;
+			uint32_t offset;
+		} text;
+		struct {
+			CnFloat2 center;
+			CnDimension2f dimensions;
+			CnOpaqueColor color;
+			CnFloat4x4 transform;
+		} rect;
+		struct {
+			CnFloat2 center;
+			float radius;
+			CnOpaqueColor color;
+			uint32_t numSegments;
+		} circle;
+		struct {
+			CnFloat2 from;
+			CnFloat2 to;
+			CnOpaqueColor color;
+		} line;
+		struct {
+			uint32_t offset;
+			uint32_t numPoints;
+			CnOpaqueColor color;
+		} lineStrip;
+		struct {
+			uint32_t id;
+			CnFloat4x4 transform;
+			CnOpaqueColor color;
+		} mesh;
+		struct {
+			uint32_t id;
+			CnRowColu32 position;
+			CnTile tile;
+		} tile;
+		struct {
+			uint64_t budgetMicros;
+			float minScale;
+		} dynamicResolution;
+		CnAABB2 area;
+		CnRGBA8u clearColor;
+		CnOpaqueColor color;
+		uint64_t bytes;
+		uint32_t id;
+		uint32_t count;
+		bool enabled;
+	} args;
+} CnRCommand;
+
+typedef struct {
+	CnRCommand* commands;
+	uint32_t numCommands;
+	uint32_t commandCapacity;
+
+	char* data;
+	uint32_t dataSize;
+	uint32_t dataCapacity;
+} CnRCommandList;
+
+CN_TEST_API void        cnRCommandList_Init(CnRCommandList* list);
+CN_TEST_API void        cnRCommandList_Free(CnRCommandList* list);
+CN_TEST_API void        cnRCommandList_Clear(CnRCommandList* list);
+CN_TEST_API CnRCommand* cnRCommandList_Add(CnRCommandList* list, CnRCommandType type);
+CN_TEST_API uint32_t    cnRCommandList_AddData(CnRCommandList* list, const void* data, uint32_t size);
+CN_TEST_API void        cnRCommandList_Replay(const CnRCommandList* list);
+
+CN_TEST_API void cnRCommands_Invoke(CnRCommandList* list, CnRInvokeFn fn, void* data);
+void cnRCommands_StartFrame(CnRCommandList* list);
+void cnRCommands_EndFrame(CnRCommandList* list);
+void cnRCommands_Clear(CnRCommandList* list, CnRGBA8u color);
+void cnRCommands_SetViewport(CnRCommandList* list, CnAABB2 viewport);
+void cnRCommands_SetCameraAABB2(CnRCommandList* list, CnAABB2 area);
+void cnRCommands_SetDynamicResolution(CnRCommandList* list, uint64_t budgetMicros, float minScale);
+void cnRCommands_SetMaxFramesInFlight(CnRCommandList* list, uint32_t frames);
+void cnRCommands_SetTextureBudget(CnRCommandList* list, uint64_t bytes);
+void cnRCommands_SetSpriteArrays(CnRCommandList* list, bool enabled);
+void cnRCommands_ReserveSprite(CnRCommandList* list, CnSpriteId id);
+void cnRCommands_DrawSprite(CnRCommandList* list, CnSpriteId id, CnFloat2 position, CnDimension2f size);
+CN_TEST_API void cnRCommands_DrawSimpleText(CnRCommandList* list, CnFontId id, const CnTextDrawParams* params,
+	const char* text);
+void cnRCommands_DrawDebugFullScreenRect(CnRCommandList* list);
+void cnRCommands_DrawDebugRect(CnRCommandList* list, CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color);
+void cnRCommands_DrawDebugLine(CnRCommandList* list, float x1, float y1, float x2, float y2, CnOpaqueColor color);
+CN_TEST_API void cnRCommands_DrawDebugLineStrip(CnRCommandList* list, const CnFloat2* points, uint32_t numPoints,
+	CnOpaqueColor color);
+void cnRCommands_DrawDebugFont(CnRCommandList* list, CnFontId id, CnFloat2 center, CnDimension2f size);
+void cnRCommands_DrawMesh(CnRCommandList* list, CnMeshId id, CnFloat4x4 transform, CnOpaqueColor color);
+void cnRCommands_DestroyMesh(CnRCommandList* list, CnMeshId id);
+void cnRCommands_DestroyLayer(CnRCommandList* list, CnLayerId id);
+void cnRCommands_MarkLayerDirty(CnRCommandList* list, CnLayerId id);
+void cnRCommands_BeginLayer(CnRCommandList* list, CnLayerId id);
+void cnRCommands_EndLayer(CnRCommandList* list);
+void cnRCommands_DrawLayer(CnRCommandList* list, CnLayerId id);
+void cnRCommands_DestroyTilemap(CnRCommandList* list, CnTilemapId id);
+void cnRCommands_SetTile(CnRCommandList* list, CnTilemapId id, CnRowColu32 position, CnTile tile);
+void cnRCommands_DrawTilemap(CnRCommandList* list, CnTilemapId id, CnFloat2 origin, CnDimension2f tileSize);
+void cnRCommands_DrawRect(CnRCommandList* list, CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color,
+	CnFloat4x4 transform);
+void cnRCommands_OutlineRect(CnRCommandList* list, CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color,
+	CnFloat4x4 transform);
+void cnRCommands_OutlineCircle(CnRCommandList* list, CnFloat2 center, float radius, CnOpaqueColor color,
+	uint32_t numSegments);
+void cnRCommands_FillScreen(CnRCommandList* list, CnOpaqueColor color);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_RENDER_COMMANDS_H */
@@ -12,29 +12,55 @@
 #include <calendon/cn.h>
 
 #include <calendon/assets.h>
+#include <calendon/assets-archive.h>
 #include <calendon/assets-fileio.h>
 #include <calendon/color.h>
 #include <calendon/compat-gl.h>
 #include <calendon/compat-sdl.h>
 #include <calendon/font-psf2.h>
 #include <calendon/image.h>
+#include <calendon/image-cache.h>
 #include <calendon/log.h>
 #include <calendon/math4.h>
 #include <calendon/memory.h>
 #include <calendon/path.h>
+#include <calendon/render-capture.h>
 #include <calendon/render-ll.h>
 #include <calendon/render-resources.h>
+#include <calendon/render-scale.h>
+#include <calendon/residency.h>
+#include <calendon/tilemap.h>
+
+#include <math.h>
+#include <stddef.h>
 
 /*
- * A macro to provide OpenGL error checking and reporting.
+ * A macro to provide OpenGL error checking and reporting.  When the driver
+ * reports errors through a debug message callback, polling for errors is
+ * skipped, since each poll waits on the driver.
  */
 #if CN_DEBUG
-	#define CN_ASSERT_NO_GL_ERROR() cnRLL_CheckGLError(__FILE__, __LINE__)
+	#define CN_ASSERT_NO_GL_ERROR() do { \
+			if (!debugOutputEnabled) { \
+				cnRLL_CheckGLError(__FILE__, __LINE__); \
+			} \
+		} while (0)
 	void cnRLL_CheckGLError(const char* file, int line);
+	static bool debugOutputEnabled = false;
 #else
 	#define CN_ASSERT_NO_GL_ERROR()
 #endif
 
+/*
+ * Validation which queries GL objects round trips to the driver, so is left
+ * out of release builds.
+ */
+#if CN_DEBUG
+	#define RLL_DEBUG_ASSERT(condition, message, ...) CN_ASSERT(condition, message, ##__VA_ARGS__)
+#else
+	#define RLL_DEBUG_ASSERT(condition, message, ...)
+#endif
+
 const char* cnRLL_GLTypeToString(GLenum type);
 void cnRLL_PrintProgram(GLuint program);
 void cnRLL_PrintGLVersion(void);
@@ -75,9 +101,58 @@ CN_DECLARE_HANDLE_TYPE(CnFontId, cnRLL_, Font, 8);
  */
 static GLuint spriteTextures[MaxSpriteId];
 
+/**
+ * Same-sized sprites can share a `GL_TEXTURE_2D_ARRAY`, one sprite per layer,
+ * so runs of them draw in a single call without the padding and bleeding
+ * issues of packing them into an atlas.
+ */
+#define RLL_MAX_SPRITE_ARRAYS 8
+#define RLL_SPRITE_ARRAY_LAYERS 16
+
+typedef struct {
+	GLuint texture;
+	CnDimension2u32 size;
+	uint32_t numLevels;
+	uint32_t usedLayers;
+} CnSpriteArray;
+
+static bool useSpriteArrays = false;
+static CnSpriteArray spriteArrays[RLL_MAX_SPRITE_ARRAYS];
+
+/**
+ * One more than the index into `spriteArrays` of the array holding each
+ * sprite, or 0 for sprites with their own texture.
+ */
+static uint32_t spriteArraySlots[MaxSpriteId];
+static uint32_t spriteLayers[MaxSpriteId];
+
+/**
+ * Sprites used as tilesets, which tilemaps draw as 2D textures, so they are
+ * never uploaded into an array.
+ */
+static bool spriteIsTileset[MaxSpriteId];
+
 static GLuint fontTextures[MaxFontId];
 static CnFontPSF2 fonts[MaxFontId];
 
+/**
+ * Where each sprite was loaded from, to reload it after being evicted.  Fonts
+ * keep their atlas in memory, so are reloaded from there.
+ */
+static CnPathBuffer spritePaths[MaxSpriteId];
+
+/**
+ * Sprites, fonts and sprite arrays share a residency table, each in their own
+ * range of entries.  Sprite arrays are pinned, since they're shared.
+ */
+#define RLL_RESIDENCY_SPRITE(id) (id)
+#define RLL_RESIDENCY_FONT(id) (MaxSpriteId + (id))
+#define RLL_RESIDENCY_SPRITE_ARRAY(index) (MaxSpriteId + MaxFontId + (index))
+static CnResidency textureResidency;
+
+CN_STATIC_ASSERT(RLL_RESIDENCY_SPRITE_ARRAY(RLL_MAX_SPRITE_ARRAYS) <= CN_RESIDENCY_MAX_ENTRIES,
+	"Not enough residency entries for every texture");
+
 /**
  * The maximum length of shader information logs which can be read.
  */
@@ -95,6 +170,8 @@ enum {
 	CnVertexFormatP4 = 0,
 	CnVertexFormatP2 = 1,
 	CnVertexFormatP2T2Interleaved = 2,
+	CnVertexFormatSpriteBatch = 3,
+	CnVertexFormatTilemap = 4,
 	CnVertexFormatMax
 };
 static CnVertexFormat vertexFormats[CnVertexFormatMax];
@@ -106,23 +183,88 @@ enum {
 	CnProgramIndexSprite = 0,
 	CnProgramIndexFullScreen,
 	CnProgramIndexSolidPolygon,
+	CnProgramIndexSpriteArray,
+	CnProgramIndexGlyph,
+	CnProgramIndexLayer,
+	CnProgramIndexTilemap,
 	CnProgramIndexMax
 };
 static CnProgram programs[CnProgramIndexMax];
 
 /**
- * The total number of glyphs which can be drawn at once.
+ * Batched sprites and glyphs store positions as 16-bit fixed point offsets
+ * from the start of their batch, to halve the size of positions.  Each step is
+ * an eighth of a pixel at the current camera and viewport, so positions are
+ * as precise as floats on screen however far the camera is zoomed, and a
+ * batch reaches about 4096 pixels from its start.  Batches are drawn early if
+ * something is too far from the start to be offset.  The shaders scale
+ * positions back by `PositionStep`.
+ */
+#define RLL_POSITION_SUBPIXELS 8.0f
+#define RLL_UNORM16_ONE 65535
+
+/**
+ * World units in one step of a packed position, set with the camera and
+ * viewport.
+ */
+static CnFloat2 positionStep;
+
+typedef struct {
+	int16_t x;
+	int16_t y;
+} CnPackedPosition;
+
+static bool cnRLL_PackPosition(CnFloat2 origin, CnFloat2 position, CnPackedPosition* packed)
+{
+	const float x = floorf((position.x - origin.x) / positionStep.x + 0.5f);
+	const float y = floorf((position.y - origin.y) / positionStep.y + 0.5f);
+	if (x < INT16_MIN || x > INT16_MAX || y < INT16_MIN || y > INT16_MAX) {
+		return false;
+	}
+	packed->x = (int16_t)x;
+	packed->y = (int16_t)y;
+	return true;
+}
+
+/**
+ * The total number of glyphs which can be drawn at once.  Each glyph is an
+ * instance, with UVs worked out from its index in the font atlas.
  */
-#define RLL_MAX_GLYPHS_PER_DRAW 180
-#define RLL_VERTICES_PER_GLYPH 6
-#define RLL_MAX_GLYPH_VERTICES_PER_DRAW (RLL_VERTICES_PER_GLYPH * RLL_MAX_GLYPHS_PER_DRAW)
-#define RLL_GLYPH_BUFFER_SIZE (2 * 2 * sizeof(float) * RLL_MAX_GLYPH_VERTICES_PER_DRAW)
-static CnFloat2 glyphVertices[RLL_MAX_GLYPH_VERTICES_PER_DRAW];
-static CnFloat2 glyphTexCoords[RLL_MAX_GLYPH_VERTICES_PER_DRAW];
+#define RLL_MAX_GLYPHS_PER_DRAW 1024
+typedef struct {
+	CnPackedPosition position;
+	uint16_t glyphIndex;
+	uint16_t padding;
+	CnRGBA8u color;
+} CnGlyphInstance;
+CN_STATIC_ASSERT(sizeof(CnGlyphInstance) == 12, "Unexpected glyph instance size");
+static CnGlyphInstance glyphInstances[RLL_MAX_GLYPHS_PER_DRAW];
+static CnFloat2 glyphBatchOrigin;
 static uint32_t usedGlyphs = 0;
 static CnVertexFormat glyphFormat;
 static GLuint glyphBuffer;
 
+/**
+ * Sprites drawn from texture arrays are batched, and drawn together when a
+ * sprite from a different array is drawn, or anything else is drawn.
+ */
+#define RLL_MAX_SPRITES_PER_BATCH 256
+#define RLL_VERTICES_PER_SPRITE 6
+typedef struct {
+	CnPackedPosition position;
+	uint16_t texCoord[2];
+	uint16_t layer;
+	uint16_t padding;
+} CnSpriteBatchVertex;
+CN_STATIC_ASSERT(sizeof(CnSpriteBatchVertex) == 12, "Unexpected sprite batch vertex size");
+static CnSpriteBatchVertex spriteBatchVertices[RLL_VERTICES_PER_SPRITE * RLL_MAX_SPRITES_PER_BATCH];
+static CnFloat2 spriteBatchOrigin;
+static uint32_t spriteBatchSize = 0;
+static uint32_t spriteBatchArray = 0;
+static GLuint spriteBatchBuffer;
+static void cnRLL_FlushSpriteBatch(void);
+static void cnRLL_EvictTexture(uint32_t entry, void* userData);
+
 /**
  * Associates a name along with an indexed location, and type information.
  */
@@ -152,7 +294,11 @@ enum {
 	CnAttributeSemanticNamePosition3 = 0,
 	CnAttributeSemanticNamePosition4 = 0,
 	CnAttributeSemanticNameTexCoord2 = 1,
-	CnAttributeSemanticNameTypes = 5,
+	CnAttributeSemanticNameLayer = 2,
+	CnAttributeSemanticNameInstancePosition2 = 3,
+	CnAttributeSemanticNameGlyphIndex = 4,
+	CnAttributeSemanticNameColor4 = 5,
+	CnAttributeSemanticNameTypes = 9,
 	CnAttributeSemanticNameUnknown
 };
 
@@ -165,32 +311,46 @@ static CnSemanticMapping attributeSemanticNames[] = {
 	{ "Position2", CnAttributeSemanticNamePosition2, GL_FLOAT, 2 },
 	{ "Position3", CnAttributeSemanticNamePosition3, GL_FLOAT, 3 },
 	{ "Position4", CnAttributeSemanticNamePosition4, GL_FLOAT, 4 },
-	{ "TexCoord2", CnAttributeSemanticNameTexCoord2, GL_FLOAT, 2 }
+	{ "TexCoord2", CnAttributeSemanticNameTexCoord2, GL_FLOAT, 2 },
+	{ "Layer", CnAttributeSemanticNameLayer, GL_FLOAT, 1 },
+	{ "InstancePosition2", CnAttributeSemanticNameInstancePosition2, GL_FLOAT, 2 },
+	{ "GlyphIndex", CnAttributeSemanticNameGlyphIndex, GL_FLOAT, 1 },
+	{ "Color4", CnAttributeSemanticNameColor4, GL_FLOAT, 4 }
 };
 
 CN_STATIC_ASSERT(CnAttributeSemanticNameTypes == CN_ARRAY_SIZE(attributeSemanticNames),
 				 "Number of attribute semantic names doesn't match data array");
 
 enum {
-	CnUniformNameProjection = 0,
-	CnUniformNameModelView = 1,
-	CnUniformNameViewModel = 1,
-	CnUniformNameTexture = 2,
-	CnUniformNameTexture2D0 = 2,
-	CnUniformNamePolygonColor = 3,
-	CnUniformNameTypes = 6,
+	CnUniformNameModelView = 0,
+	CnUniformNameViewModel = 0,
+	CnUniformNameTexture = 1,
+	CnUniformNameTexture2D0 = 1,
+	CnUniformNamePolygonColor = 2,
+	CnUniformNameTextureArray = 3,
+	CnUniformNameGlyphSize = 4,
+	CnUniformNameAtlasGrid = 5,
+	CnUniformNameBatchOrigin = 6,
+	CnUniformNameTileSize = 7,
+	CnUniformNamePositionStep = 8,
+	CnUniformNameTypes = 11,
 	CnUniformNameUnknown
 };
 
 // TODO: Naming misnomer, uniform->semanticName doesn't map into this array,
 // it maps into the uniform storage.
 static CnSemanticMapping UniformNames[] = {
-	{ "Projection",   CnUniformNameProjection,   GL_FLOAT_MAT4, 1 },
 	{ "ModelView",    CnUniformNameModelView,    GL_FLOAT_MAT4, 1 },
 	{ "ViewModel",    CnUniformNameViewModel,    GL_FLOAT_MAT4, 1 },
 	{ "Texture",      CnUniformNameTexture,      GL_SAMPLER_2D, 1 },
 	{ "Texture2D0",   CnUniformNameTexture2D0,   GL_SAMPLER_2D, 1 },
-	{ "PolygonColor", CnUniformNamePolygonColor, GL_FLOAT_VEC4, 1 }
+	{ "PolygonColor", CnUniformNamePolygonColor, GL_FLOAT_VEC4, 1 },
+	{ "TextureArray", CnUniformNameTextureArray, GL_SAMPLER_2D_ARRAY, 1 },
+	{ "GlyphSize",    CnUniformNameGlyphSize,    GL_FLOAT_VEC2, 1 },
+	{ "AtlasGrid",    CnUniformNameAtlasGrid,    GL_FLOAT_VEC2, 1 },
+	{ "BatchOrigin",  CnUniformNameBatchOrigin,  GL_FLOAT_VEC2, 1 },
+	{ "TileSize",     CnUniformNameTileSize,     GL_FLOAT_VEC2, 1 },
+	{ "PositionStep", CnUniformNamePositionStep, GL_FLOAT_VEC2, 1 }
 };
 
 CN_STATIC_ASSERT(CnUniformNameTypes == CN_ARRAY_SIZE(UniformNames),
@@ -208,6 +368,18 @@ typedef union {
 typedef CnAnyGLValue CnUniformStorage[CnUniformNameTypes];
 static CnUniformStorage uniformStorage;
 
+/**
+ * Values shared by every program for the current view, in the std140 layout
+ * of the "View" uniform block in the shaders.  These are uploaded when they
+ * change, rather than applied to each program on every draw.
+ */
+#define RLL_VIEW_BLOCK_BINDING 0
+typedef struct {
+	CnFloat4x4 projection;
+} CnViewBlock;
+CN_STATIC_ASSERT(sizeof(CnViewBlock) == 64, "View block does not match std140 layout");
+static GLuint viewBlockBuffer;
+
 uint32_t cnRLL_LookupAttributeSemanticName(const char* name)
 {
 	CN_ASSERT(name != NULL, "Cannot lookup a null attribute name.");
@@ -270,6 +442,7 @@ void cnRLL_ApplyUniform(CnUniform* u, CnUniformStorage storage)
 				&uniformStorage[u->storageLocation].f44.m[0][0]);
 			break;
 		case GL_SAMPLER_2D:
+		case GL_SAMPLER_2D_ARRAY:
 			glUniform1i(u->location, storage[u->storageLocation].i);
 			break;
 		default:
@@ -323,28 +496,183 @@ void cnRLL_RegisterProgram(uint32_t index, GLuint program)
 	GLint numActiveUniforms;
 	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numActiveUniforms);
 	CN_TRACE(LogSysRender, "Active Uniforms: %d", numActiveUniforms);
+	uint32_t numUniforms = 0;
 	for (GLint i = 0; i < numActiveUniforms; ++i) {
 		GLint size;
 		GLenum type;
+		CnUniform* u = &p->uniforms[numUniforms];
 		glGetActiveUniform(program, (GLuint)i, CN_RLL_MAX_UNIFORM_NAME_LENGTH,
-			NULL, &size, &type, p->uniforms[i].name);
+			NULL, &size, &type, u->name);
 		CN_TRACE(LogSysRender, "[%d]: %s '%s'   %d", i, cnRLL_GLTypeToString(type),
-			p->uniforms[i].name, size);
+			u->name, size);
+
+		// Uniforms in blocks are sourced from their buffer.
+		const GLuint uniformIndex = (GLuint)i;
+		GLint blockIndex;
+		glGetActiveUniformsiv(program, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+		if (blockIndex != -1) {
+			continue;
+		}
 
-		uint32_t storageLocation = cnRLL_LookupUniformStorageLocation(p->uniforms[i].name);
+		uint32_t storageLocation = cnRLL_LookupUniformStorageLocation(u->name);
 		CN_ASSERT(storageLocation < CnUniformNameTypes, "Couldn't find uniform "
-			"semantic name for %s", p->uniforms[i].name);
-		p->uniforms[i].size = size;
-		p->uniforms[i].type = type;
-		p->uniforms[i].location = glGetUniformLocation(p->id, p->uniforms[i].name);
-		p->uniforms[i].storageLocation = storageLocation;
+			"semantic name for %s", u->name);
+		u->size = size;
+		u->type = type;
+		u->location = glGetUniformLocation(p->id, u->name);
+		u->storageLocation = storageLocation;
+		++numUniforms;
+	}
+	p->numUniforms = numUniforms;
+
+	const GLuint viewBlock = glGetUniformBlockIndex(program, "View");
+	if (viewBlock != GL_INVALID_INDEX) {
+		glUniformBlockBinding(program, viewBlock, RLL_VIEW_BLOCK_BINDING);
 	}
-	p->numUniforms = numActiveUniforms;
 
 	CN_ASSERT_NO_GL_ERROR();
 }
 
-static void cnRLL_ApplyVertexAttribute(CnVertexFormat* f, uint32_t semanticName, uint32_t location)
+/**
+ * Vertex array objects are baked on first use for every combination of
+ * program, vertex format and buffer which gets drawn, so a draw only needs to
+ * bind one.
+ */
+#define RLL_MAX_VERTEX_ARRAYS 32
+typedef struct {
+	GLuint program;
+	const CnVertexFormat* format;
+	GLuint buffer;
+	GLuint vao;
+} CnVertexArray;
+static CnVertexArray vertexArrays[RLL_MAX_VERTEX_ARRAYS];
+static uint32_t numVertexArrays = 0;
+
+/**
+ * Geometry uploaded once and drawn by handle.  Each mesh has its own vertex
+ * array, made when it is created.  Mesh ids are one more than their slot, so
+ * zero is never a valid mesh.
+ */
+#define RLL_MAX_MESHES 256
+typedef struct {
+	GLuint buffer;
+	GLuint vao;
+	GLenum mode;
+	uint32_t numVertices;
+} CnMesh;
+static CnMesh meshes[RLL_MAX_MESHES];
+
+/**
+ * Offscreen targets the size of the backing canvas, for content which is drawn
+ * once and composited every frame until it changes.  Like meshes, layer ids
+ * are one more than their slot.
+ */
+typedef struct {
+	GLuint framebuffer;
+	GLuint texture;
+	bool dirty;
+} CnLayer;
+static CnLayer layers[RLL_MAX_LAYERS];
+static CnLayerId activeLayer = 0;
+
+/**
+ * Below full render scale, frames are drawn into the lower left of a scene
+ * target the size of the backing canvas, and upscaled to the window at the
+ * end of the frame.  The target is kept at full size, so changing scale never
+ * reallocates it.
+ */
+static CnRenderScale renderScaleController;
+static float renderScale = 1.0f;
+static GLuint sceneFramebuffer;
+static GLuint sceneTexture;
+
+/**
+ * The framebuffer which frames are drawn into outside of layers.
+ */
+static GLuint cnRLL_SceneFramebuffer(void)
+{
+	return renderScale < 1.0f ? sceneFramebuffer : 0;
+}
+
+/**
+ * GPU time of each frame is measured with timer queries, read back a few
+ * frames later so the CPU never waits on them.
+ */
+#define RLL_FRAME_QUERIES 4
+static GLuint frameQueries[RLL_FRAME_QUERIES];
+static uint32_t nextFrameQuery;
+static uint32_t numPendingFrameQueries;
+static bool frameQueryActive;
+
+/**
+ * Drivers may queue several frames ahead of the GPU, each adding a frame of
+ * latency between input and display.  A fence after each frame bounds how
+ * many frames may be in flight, by waiting on the oldest before starting
+ * another.
+ */
+#define RLL_MAX_FRAMES_IN_FLIGHT 4
+#define RLL_DEFAULT_FRAMES_IN_FLIGHT 2
+typedef struct {
+	GLsync fence;
+
+	/**
+	 * Latency is measured on the GL clock, from when the frame was started to
+	 * when the GPU reached the timestamp query recorded after it.
+	 */
+	GLint64 startNanos;
+	GLuint finishQuery;
+} CnFrameInFlight;
+static CnFrameInFlight framesInFlight[RLL_MAX_FRAMES_IN_FLIGHT];
+static uint32_t nextFrameInFlight;
+static uint32_t numFramesInFlight;
+static uint32_t maxFramesInFlight = RLL_DEFAULT_FRAMES_IN_FLIGHT;
+static GLint64 frameStartNanos;
+static CnFrameStats frameStats;
+
+/**
+ * Captured frames are read into pixel pack buffers, which are mapped a few
+ * frames later once the GPU has filled them, so reading back never stalls.
+ */
+#define RLL_CAPTURE_BUFFERS 3
+typedef struct {
+	GLuint buffer;
+	GLsync fence;
+} CnCaptureReadback;
+static CnCaptureReadback captureReadbacks[RLL_CAPTURE_BUFFERS];
+static uint32_t nextCaptureReadback;
+static uint32_t numPendingCaptureReadbacks;
+
+/**
+ * Each chunk of a tilemap gets a static vertex buffer, built the first time
+ * the chunk is seen and rebuilt when its tiles change.  Tilemap ids are one
+ * more than their slot.
+ */
+#define RLL_MAX_TILEMAPS 4
+typedef struct {
+	GLuint buffer;
+	GLuint vao;
+	uint32_t numVertices;
+} CnTilemapChunkBuffer;
+
+typedef struct {
+	CnTilemap map;
+	CnSpriteId tileset;
+	CnDimension2u32 tilesetGrid;
+	CnDynamicBuffer chunkBufferStorage;
+	CnTilemapChunkBuffer* chunkBuffers;
+	bool used;
+} CnTilemapDraw;
+static CnTilemapDraw tilemaps[RLL_MAX_TILEMAPS];
+static CnTilemapVertex tilemapVertices[CN_TILEMAP_CHUNK_TILES * CN_TILEMAP_VERTICES_PER_TILE];
+
+/**
+ * Tiles are neighbors in the tileset, so filtering or sampling smaller mips
+ * would blend in the edges of other tiles.  Tilesets are sampled from their
+ * base level without filtering, whatever the sprite's texture uses.
+ */
+static GLuint tilesetSampler;
+
+static void cnRLL_ApplyVertexAttribute(const CnVertexFormat* f, uint32_t semanticName, uint32_t location)
 {
 	CN_ASSERT(f != NULL, "Cannot apply a vertex attribute from a null format");
 	CN_ASSERT(semanticName < CnAttributeSemanticNameUnknown, "Unknown semantic name ID: %"
@@ -362,45 +690,136 @@ static void cnRLL_ApplyVertexAttribute(CnVertexFormat* f, uint32_t semanticName,
 		attribute->stride,
 		(void*)attribute->offset
 		);
+	glVertexAttribDivisor(location, attribute->divisor);
 
 	CN_ASSERT_NO_GL_ERROR();
 }
 
 /**
- * Set uniforms according to global uniform storage, and enable attribute
- * pointers.
+ * Binds the vertex array object to draw the given buffer with a program,
+ * creating it if this combination hasn't been drawn before.
  */
-static void cnRLL_EnableProgramForVertexFormat(uint32_t id, CnVertexFormat* format)
+static void cnRLL_BindVertexArray(const CnProgram* p, const CnVertexFormat* format, GLuint buffer)
 {
-	CnProgram* p = &programs[id];
-	CN_ASSERT(glIsProgram(p->id), "%" PRIu32 " is not a valid program.", id);
-	CN_ASSERT(format != NULL, "Cannot enable program %" PRIu32 " for a null vertex format.", id);
-
-	glUseProgram(p->id);
-	CN_ASSERT_NO_GL_ERROR();
+	for (uint32_t i = 0; i < numVertexArrays; ++i) {
+		const CnVertexArray* v = &vertexArrays[i];
+		if (v->program == p->id && v->format == format && v->buffer == buffer) {
+			glBindVertexArray(v->vao);
+			return;
+		}
+	}
 
+	CN_ASSERT(numVertexArrays < RLL_MAX_VERTEX_ARRAYS, "Too many vertex arrays: %" PRIu32, numVertexArrays);
+	CnVertexArray* v = &vertexArrays[numVertexArrays++];
+	v->program = p->id;
+	v->format = format;
+	v->buffer = buffer;
+	glGenVertexArrays(1, &v->vao);
+	glBindVertexArray(v->vao);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
 	for (uint32_t i = 0; i < p->numAttributes; ++i) {
 		cnRLL_ApplyVertexAttribute(format, p->attributes[i].semanticName, p->attributes[i].location);
 	}
+	CN_TRACE(LogSysRender, "Created vertex array %" PRIu32 " for program %u and buffer %u",
+		numVertexArrays - 1, p->id, buffer);
+	CN_ASSERT_NO_GL_ERROR();
+}
 
+/**
+ * Applies one uniform from global uniform storage to the program in use, for
+ * values which change between draws with the same program.
+ */
+static void cnRLL_ApplyProgramUniform(CnProgram* p, uint32_t storageLocation)
+{
 	for (uint32_t i = 0; i < p->numUniforms; ++i) {
-		cnRLL_ApplyUniform(&p->uniforms[i], uniformStorage);
+		if (p->uniforms[i].storageLocation == storageLocation) {
+			cnRLL_ApplyUniform(&p->uniforms[i], uniformStorage);
+		}
 	}
 }
 
 /**
- * Turns off vertex attributes associated with the given program.
+ * Uses a program with uniforms set according to global uniform storage.
  */
-void cnRLL_DisableProgram(uint32_t id)
+static CnProgram* cnRLL_UseProgram(uint32_t id)
 {
+	// Everything drawn goes through here, so batched sprites are drawn first to
+	// keep draw order.
+	if (id != CnProgramIndexSpriteArray) {
+		cnRLL_FlushSpriteBatch();
+	}
+
 	CnProgram* p = &programs[id];
-	for (uint32_t i = 0; i < p->numAttributes; ++i) {
-		glDisableVertexAttribArray(p->attributes[i].location);
+	RLL_DEBUG_ASSERT(glIsProgram(p->id), "%" PRIu32 " is not a valid program.", id);
+
+	glUseProgram(p->id);
+	CN_ASSERT_NO_GL_ERROR();
+
+	for (uint32_t i = 0; i < p->numUniforms; ++i) {
+		cnRLL_ApplyUniform(&p->uniforms[i], uniformStorage);
 	}
+	return p;
 }
 
-bool cnRLL_CreateProgram(GLuint vertexShader, GLuint fragmentShader, GLuint* program,
-	uint32_t programIndex);
+/**
+ * Set uniforms according to global uniform storage, and bind the vertex array
+ * for drawing the buffer with the vertex format.
+ */
+static void cnRLL_EnableProgramForVertexFormat(uint32_t id, const CnVertexFormat* format, GLuint buffer)
+{
+	CN_ASSERT(format != NULL, "Cannot enable program %" PRIu32 " for a null vertex format.", id);
+	const CnProgram* p = cnRLL_UseProgram(id);
+
+	// Flushing sprites may have bound another buffer, and callers upload to
+	// this one after enabling.
+	cnRLL_BindVertexArray(p, format, buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+/**
+ * Linked programs are cached alongside decoded images.  Entries are named by
+ * the shader file names, and keyed by the driver and the shader sources.
+ */
+#define RLL_PROGRAM_CACHE_VERSION 1
+
+typedef struct {
+	uint8_t magic[4];
+	uint32_t version;
+	uint64_t sourceHash;
+	uint32_t binaryFormat;
+	uint32_t binaryLength;
+	uint8_t reserved[8];
+} CnProgramCacheHeader;
+
+CN_STATIC_ASSERT(sizeof(CnProgramCacheHeader) == 32, "Unexpected CnProgramCacheHeader size");
+
+static const uint8_t programCacheMagic[4] = { 'C', 'N', 'P', 'B' };
+
+typedef struct {
+	const char* vertexShader;
+	const char* fragmentShader;
+	uint32_t programIndex;
+} CnProgramSource;
+
+/**
+ * A program being loaded by `cnRLL_LoadShaders`.
+ */
+typedef struct {
+	CnDynamicBuffer vertexSource;
+	CnDynamicBuffer fragmentSource;
+	bool hasSources;
+
+	uint64_t sourceHash;
+	CnPathBuffer cachePath;
+	bool hasCachePath;
+	bool cached;
+
+	GLuint vertexShader;
+	GLuint fragmentShader;
+	GLuint program;
+} CnProgramBuild;
+
+static bool cnRLL_FinishProgram(CnProgramBuild* build, uint32_t programIndex);
 void cnRLL_FillBuffers(void);
 void cnRLL_InitSprites(void);
 void cnRLL_LoadShaders(void);
@@ -554,34 +973,93 @@ static CnFloat4x4 cnRLL_OrthoProjection(CnAABB2 bounds)
 	return cnFloat4x4_Multiply(trans, scale);
 }
 
-static bool cnRLL_CreateShader(GLuint* shader, const char* source, const uint32_t sourceLength)
+static void cnRLL_CompileShader(GLuint shader, const CnDynamicBuffer* source)
 {
-	const GLchar* sources[] = { source };
-	const GLint sizes[] = { sourceLength };
-	glShaderSource(*shader, 1, sources, sizes);
-	glCompileShader(*shader);
+	const GLchar* sources[] = { source->contents };
+	const GLint sizes[] = { (GLint)source->size };
+	glShaderSource(shader, 1, sources, sizes);
+	glCompileShader(shader);
+}
 
+/**
+ * Checks the results of compiling a shader, which may block until the
+ * compilation finishes.
+ */
+static bool cnRLL_CheckShader(GLuint shader, const char* fileName)
+{
 	GLint compileResult = GL_FALSE;
-	glGetShaderiv(*shader, GL_COMPILE_STATUS, &compileResult);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compileResult);
 	if (!compileResult) {
-		CN_ERROR(LogSysRender, "Unable to compile shader: %s", source);
+		CN_ERROR(LogSysRender, "Unable to compile shader: %s", fileName);
 		return false;
 	}
 
 	GLint infoLogLength;
-	glGetShaderiv(*shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
 	if (infoLogLength > 0) {
 		if (MAX_INFO_LOG_LENGTH < infoLogLength) {
 			CN_ERROR(LogSysRender, "Info log buffer is too small to hold all output");
 			return false;
 		}
 		char infoLog[MAX_INFO_LOG_LENGTH];
-		glGetShaderInfoLog(*shader, MAX_INFO_LOG_LENGTH, NULL, infoLog);
-		CN_TRACE(LogSysRender, "Compilation results for %s", infoLog);
+		glGetShaderInfoLog(shader, MAX_INFO_LOG_LENGTH, NULL, infoLog);
+		CN_TRACE(LogSysRender, "Compilation results for %s: %s", fileName, infoLog);
 	}
 	return true;
 }
 
+#if CN_DEBUG
+static void APIENTRY cnRLL_OnDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei length, const GLchar* message, const void* userParam)
+{
+	CN_UNUSED(source);
+	CN_UNUSED(length);
+	CN_UNUSED(userParam);
+
+	// Drivers report some API errors, like invalid enums, at lower severities,
+	// but these are the errors polling with glGetError would have caught.
+	if (type == GL_DEBUG_TYPE_ERROR) {
+		CN_ERROR(LogSysRender, "OpenGL error %u (type 0x%x): %s", id, type, message);
+		return;
+	}
+
+	switch (severity) {
+		case GL_DEBUG_SEVERITY_HIGH:
+			CN_ERROR(LogSysRender, "OpenGL error %u (type 0x%x): %s", id, type, message);
+			break;
+		case GL_DEBUG_SEVERITY_MEDIUM:
+			CN_WARN(LogSysRender, "OpenGL warning %u (type 0x%x): %s", id, type, message);
+			break;
+		case GL_DEBUG_SEVERITY_LOW:
+			CN_TRACE(LogSysRender, "OpenGL message %u (type 0x%x): %s", id, type, message);
+			break;
+		default:
+			// Notifications are too frequent to be useful.
+			break;
+	}
+}
+
+/**
+ * Has the driver report errors as they happen through `GL_KHR_debug`, rather
+ * than polling for them after calls.  Output is synchronous so breaking on an
+ * error stops in the call which caused it.
+ */
+static void cnRLL_InitDebugOutput(void)
+{
+	if (!SDL_GL_ExtensionSupported("GL_KHR_debug")) {
+		CN_TRACE(LogSysRender, "GL_KHR_debug is not supported, polling for OpenGL errors");
+		return;
+	}
+
+	glEnable(GL_DEBUG_OUTPUT);
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	glDebugMessageCallback(cnRLL_OnDebugMessage, NULL);
+	cnRLL_CheckGLError(__FILE__, __LINE__);
+	debugOutputEnabled = true;
+	CN_TRACE(LogSysRender, "Reporting OpenGL errors through GL_KHR_debug");
+}
+#endif
+
 void cnRLL_InitGL(void)
 {
 	LogSysRender = cnLog_RegisterSystem("Render");
@@ -591,6 +1069,9 @@ void cnRLL_InitGL(void)
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+#if CN_DEBUG
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#endif
 	gl = SDL_GL_CreateContext(window);
 	if (gl == NULL) {
 		CN_FATAL_ERROR("Unable to create OpenGL context: %s", SDL_GetError());
@@ -601,32 +1082,40 @@ void cnRLL_InitGL(void)
 	glewInit();
 #endif
 
+#if CN_DEBUG
+	cnRLL_InitDebugOutput();
+#endif
+
 	CN_TRACE(LogSysRender, "OpenGL renderer initialized");
 	cnRLL_PrintGLVersion();
 }
 
-void cnRLL_ConfigureVSync(void)
-{
-	// VSync causes the draw to stall until the frame is displayed.
-	// This might be more useful if/when drawing gets moved to it's own thread.
-	const bool useVSync = true;
-	if (useVSync) {
-		SDL_GL_SetSwapInterval(1);
-	}
-	else {
-		SDL_GL_SetSwapInterval(0);
-	}
-}
-
 /**
- * Even if VAOs aren't used, a dummy VAO must be bound.
+ * Sets how frames are shown, returning the mode actually used.
  */
-void cnRLL_InitDummyVAO(void)
+CnPresentMode cnRLL_SetPresentMode(CnPresentMode mode)
 {
-	static GLuint vao;
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	CN_ASSERT_NO_GL_ERROR();
+	switch (mode) {
+		case CnPresentModeImmediate:
+			if (SDL_GL_SetSwapInterval(0) == 0) {
+				return CnPresentModeImmediate;
+			}
+			CN_WARN(LogSysRender, "Immediate present mode is unsupported, using vsync: %s", SDL_GetError());
+			break;
+		case CnPresentModeAdaptive:
+			if (SDL_GL_SetSwapInterval(-1) == 0) {
+				return CnPresentModeAdaptive;
+			}
+			CN_WARN(LogSysRender, "Adaptive present mode is unsupported, using vsync: %s", SDL_GetError());
+			break;
+		case CnPresentModeVSync:
+			break;
+		default:
+			CN_ERROR(LogSysRender, "Unknown present mode: %i", (int)mode);
+	}
+
+	SDL_GL_SetSwapInterval(1);
+	return CnPresentModeVSync;
 }
 
 void cnRLL_InitVertexFormats(void)
@@ -681,22 +1170,79 @@ void cnRLL_InitVertexFormats(void)
 	}
 
 	{
-		CnVertexFormat*v = &glyphFormat;
+		CnVertexFormat* v = &vertexFormats[CnVertexFormatSpriteBatch];
 		CnVertexFormatAttribute* p2 = &v->attributes[CnAttributeSemanticNamePosition2];
 		p2->semanticName = CnAttributeSemanticNamePosition2;
-		p2->componentType = GL_FLOAT;
+		p2->componentType = GL_SHORT;
 		p2->numComponents = 2;
 		p2->normalized = GL_FALSE;
-		p2->stride = 0;
-		p2->offset = 0;
+		p2->stride = sizeof(CnSpriteBatchVertex);
+		p2->offset = offsetof(CnSpriteBatchVertex, position);
 
 		CnVertexFormatAttribute* t2 = &v->attributes[CnAttributeSemanticNameTexCoord2];
 		t2->semanticName = CnAttributeSemanticNameTexCoord2;
-		t2->componentType = GL_FLOAT;
+		t2->componentType = GL_UNSIGNED_SHORT;
 		t2->numComponents = 2;
-		t2->normalized = GL_FALSE;
-		t2->stride = 0;
-		t2->offset = sizeof(float) * 2 * RLL_MAX_GLYPHS_PER_DRAW * RLL_VERTICES_PER_GLYPH;
+		t2->normalized = GL_TRUE;
+		t2->stride = sizeof(CnSpriteBatchVertex);
+		t2->offset = offsetof(CnSpriteBatchVertex, texCoord);
+
+		CnVertexFormatAttribute* layer = &v->attributes[CnAttributeSemanticNameLayer];
+		layer->semanticName = CnAttributeSemanticNameLayer;
+		layer->componentType = GL_UNSIGNED_SHORT;
+		layer->numComponents = 1;
+		layer->normalized = GL_FALSE;
+		layer->stride = sizeof(CnSpriteBatchVertex);
+		layer->offset = offsetof(CnSpriteBatchVertex, layer);
+	}
+
+	{
+		CnVertexFormat* v = &vertexFormats[CnVertexFormatTilemap];
+		CnVertexFormatAttribute* p2 = &v->attributes[CnAttributeSemanticNamePosition2];
+		p2->semanticName = CnAttributeSemanticNamePosition2;
+		p2->componentType = GL_SHORT;
+		p2->numComponents = 2;
+		p2->normalized = GL_FALSE;
+		p2->stride = sizeof(CnTilemapVertex);
+		p2->offset = offsetof(CnTilemapVertex, position);
+
+		CnVertexFormatAttribute* t2 = &v->attributes[CnAttributeSemanticNameTexCoord2];
+		t2->semanticName = CnAttributeSemanticNameTexCoord2;
+		t2->componentType = GL_UNSIGNED_SHORT;
+		t2->numComponents = 2;
+		t2->normalized = GL_TRUE;
+		t2->stride = sizeof(CnTilemapVertex);
+		t2->offset = offsetof(CnTilemapVertex, texCoord);
+	}
+
+	{
+		CnVertexFormat* v = &glyphFormat;
+		CnVertexFormatAttribute* p2 = &v->attributes[CnAttributeSemanticNameInstancePosition2];
+		p2->semanticName = CnAttributeSemanticNameInstancePosition2;
+		p2->componentType = GL_SHORT;
+		p2->numComponents = 2;
+		p2->normalized = GL_FALSE;
+		p2->stride = sizeof(CnGlyphInstance);
+		p2->offset = offsetof(CnGlyphInstance, position);
+		p2->divisor = 1;
+
+		CnVertexFormatAttribute* glyph = &v->attributes[CnAttributeSemanticNameGlyphIndex];
+		glyph->semanticName = CnAttributeSemanticNameGlyphIndex;
+		glyph->componentType = GL_UNSIGNED_SHORT;
+		glyph->numComponents = 1;
+		glyph->normalized = GL_FALSE;
+		glyph->stride = sizeof(CnGlyphInstance);
+		glyph->offset = offsetof(CnGlyphInstance, glyphIndex);
+		glyph->divisor = 1;
+
+		CnVertexFormatAttribute* c4 = &v->attributes[CnAttributeSemanticNameColor4];
+		c4->semanticName = CnAttributeSemanticNameColor4;
+		c4->componentType = GL_UNSIGNED_BYTE;
+		c4->numComponents = 4;
+		c4->normalized = GL_TRUE;
+		c4->stride = sizeof(CnGlyphInstance);
+		c4->offset = offsetof(CnGlyphInstance, color);
+		c4->divisor = 1;
 	}
 }
 
@@ -771,13 +1317,33 @@ void cnRLL_FillGlyphBuffer(void)
 	CN_ASSERT_NO_GL_ERROR();
 	glGenBuffers(1, &glyphBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
-	glBufferData(GL_ARRAY_BUFFER, RLL_GLYPH_BUFFER_SIZE, NULL, GL_DYNAMIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glyphInstances), NULL, GL_DYNAMIC_DRAW);
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+void cnRLL_FillSpriteBatchBuffer(void)
+{
+	CN_ASSERT_NO_GL_ERROR();
+	glGenBuffers(1, &spriteBatchBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, spriteBatchBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(spriteBatchVertices), NULL, GL_DYNAMIC_DRAW);
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+void cnRLL_FillViewBlockBuffer(void)
+{
+	CN_ASSERT_NO_GL_ERROR();
+	glGenBuffers(1, &viewBlockBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, viewBlockBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CnViewBlock), NULL, GL_DYNAMIC_DRAW);
 	CN_ASSERT_NO_GL_ERROR();
 }
 
 void cnRLL_FillBuffers(void)
 {
+	cnRLL_FillViewBlockBuffer();
 	cnRLL_FillSpriteBuffer();
+	cnRLL_FillSpriteBatchBuffer();
 	cnRLL_FillFullScreenQuadBuffer();
 	cnRLL_FillDebugQuadBuffer();
 	cnRLL_FillGlyphBuffer();
@@ -789,113 +1355,278 @@ void cnRLL_InitSprites(void)
 	cnRLL_FontInit();
 }
 
-void cnRLL_LoadSimpleShader(const char* vertexShaderFileName,
-	const char* fragmentShaderFileName, uint32_t programIndex)
+/**
+ * Reads the text of a shader asset.
+ */
+static bool cnRLL_ReadShaderSource(const char* fileName, CnDynamicBuffer* buffer)
 {
-	CnPathBuffer fragmentShaderPath;
-	CnPathBuffer vertexShaderPath;
-	CnDynamicBuffer fragmentShaderBuffer;
-	CnDynamicBuffer vertexShaderBuffer;
-
-	// Find the fragment shader.
-	if (!cnAssets_PathBufferFor(fragmentShaderFileName, &fragmentShaderPath)) {
-		CN_ERROR(LogSysRender, "Unable to find asset for fragment shader: %s",
-			fragmentShaderFileName);
+	CnPathBuffer path;
+	if (!cnAssets_PathBufferFor(fileName, &path)) {
+		CN_ERROR(LogSysRender, "Unable to find asset for shader: %s", fileName);
+		return false;
 	}
 
-	if (!cnPath_IsFile(fragmentShaderPath.str)) {
-		CN_ERROR(LogSysRender, "Fragment shader is not a file: %s",
-			fragmentShaderPath.str);
+	if (!cnAssets_FileExists(path.str)) {
+		CN_ERROR(LogSysRender, "Shader is not a file: %s", path.str);
+		return false;
 	}
 
-	if (!cnAssets_ReadFile(fragmentShaderPath.str, CnFileTypeText, &fragmentShaderBuffer)) {
-		CN_ERROR(LogSysRender, "Unable to read fragment shader text");
+	if (!cnAssets_ReadFile(path.str, CnFileTypeText, buffer)) {
+		CN_ERROR(LogSysRender, "Unable to read shader text: %s", path.str);
+		return false;
 	}
+	return true;
+}
 
-	// Find the vertex shader.
-	if (!cnAssets_PathBufferFor(vertexShaderFileName, &vertexShaderPath)) {
-		CN_ERROR(LogSysRender, "Unable to find asset for vertex shader: %s",
-			vertexShaderFileName);
+/**
+ * Continues a 64-bit FNV-1a hash, as used for asset names, over some bytes.
+ */
+static uint64_t cnRLL_HashBytes(uint64_t hash, const void* bytes, size_t size)
+{
+	const uint8_t* cursor = (const uint8_t*)bytes;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= cursor[i];
+		hash *= 0x100000001b3ULL;
 	}
+	return hash;
+}
 
-	if (!cnPath_IsFile(vertexShaderPath.str)) {
-		CN_ERROR(LogSysRender, "Vertex shader is not a file: %s",
-			vertexShaderPath.str);
+/**
+ * Program binaries are only usable by the driver which made them, so the
+ * driver is part of the key for cached programs.
+ */
+static uint64_t cnRLL_DriverHash(void)
+{
+	const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(names); ++i) {
+		const char* value = (const char*)glGetString(names[i]);
+		if (value) {
+			hash = cnRLL_HashBytes(hash, value, strlen(value) + 1);
+		}
 	}
+	return hash;
+}
 
-	if (!cnAssets_ReadFile(vertexShaderPath.str, CnFileTypeText, &vertexShaderBuffer)) {
-		CN_ERROR(LogSysRender, "Unable to read vertex shader text");
+/**
+ * Restores a linked program from its cache entry, if the entry was made from
+ * the same sources by the same driver.
+ */
+static bool cnRLL_LoadProgramBinary(const CnPathBuffer* cachePath, uint64_t sourceHash, GLuint* program)
+{
+	if (!cnPath_IsFile(cachePath->str)) {
+		return false;
 	}
 
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-
-	if (!glIsShader(vertexShader)) {
-		CN_ERROR(LogSysRender, "Unable to allocate space for vertex shader");
+	CnFileView file;
+	if (!cnAssets_MapFile(cachePath->str, &file)) {
+		return false;
 	}
 
-	if (!glIsShader(fragmentShader)) {
-		CN_ERROR(LogSysRender, "Unable to allocate space for fragment shader");
+	const CnProgramCacheHeader* header = (const CnProgramCacheHeader*)file.contents;
+	bool valid = file.size >= sizeof(CnProgramCacheHeader)
+		&& memcmp(header->magic, programCacheMagic, sizeof(programCacheMagic)) == 0
+		&& header->version == RLL_PROGRAM_CACHE_VERSION
+		&& header->sourceHash == sourceHash
+		&& (uint64_t)file.size == sizeof(CnProgramCacheHeader) + (uint64_t)header->binaryLength;
+
+	if (valid) {
+		*program = glCreateProgram();
+		glProgramBinary(*program, header->binaryFormat, file.contents + sizeof(CnProgramCacheHeader),
+			(GLsizei)header->binaryLength);
+
+		// Drivers may reject binaries, such as after an update, which means
+		// compiling from source.
+		GLint linkResult = GL_FALSE;
+		glGetProgramiv(*program, GL_LINK_STATUS, &linkResult);
+		valid = linkResult == GL_TRUE;
+		if (!valid) {
+			glDeleteProgram(*program);
+			*program = 0;
+		}
 	}
 
-	cnRLL_CreateShader(&fragmentShader, fragmentShaderBuffer.contents, fragmentShaderBuffer.size);
-	cnRLL_CreateShader(&vertexShader, vertexShaderBuffer.contents, vertexShaderBuffer.size);
-
-	GLuint program;
-	if (!cnRLL_CreateProgram(vertexShader, fragmentShader, &program, programIndex)) {
-		CN_TRACE(LogSysRender, "Fragment shader %s", fragmentShaderBuffer.contents);
-		CN_TRACE(LogSysRender, "Vertex shader %s", vertexShaderBuffer.contents);
-		CN_ERROR(LogSysRender, "Unable to create shader program");
+	if (!valid) {
+		CN_TRACE(LogSysRender, "Stale program cache entry %s", cachePath->str);
 	}
-	cnDynamicBuffer_Free(&vertexShaderBuffer);
-	cnDynamicBuffer_Free(&fragmentShaderBuffer);
+	cnAssets_UnmapFile(&file);
+	return valid;
 }
 
-void cnRLL_LoadShaders(void)
+/**
+ * Writes a linked program to the cache, replacing any existing entry.
+ */
+static void cnRLL_StoreProgramBinary(const CnPathBuffer* cachePath, uint64_t sourceHash, GLuint program)
 {
-	cnRLL_LoadSimpleShader("shaders/fullscreen_textured_quad.vert",
-		"shaders/uv_as_red_green.frag", CnProgramIndexFullScreen);
-	cnRLL_LoadSimpleShader("shaders/solid_polygon.vert",
-		"shaders/solid_polygon.frag", CnProgramIndexSolidPolygon);
-	cnRLL_LoadSimpleShader("shaders/atlas_sprite.vert",
-		"shaders/atlas_sprite.frag", CnProgramIndexSprite);
+	GLint binaryLength = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0) {
+		return;
+	}
+
+	CnDynamicBuffer binary;
+	cnDynamicBuffer_Allocate(&binary, (uint32_t)binaryLength);
+
+	CnProgramCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, programCacheMagic, sizeof(header.magic));
+	header.version = RLL_PROGRAM_CACHE_VERSION;
+	header.sourceHash = sourceHash;
+
+	GLsizei written = 0;
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(program, binaryLength, &written, &binaryFormat, binary.contents);
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = (uint32_t)written;
+
+	const void* parts[2] = { &header, binary.contents };
+	const size_t sizes[2] = { sizeof(header), (size_t)written };
+	if (written > 0 && cnImageCache_WriteEntry(cachePath, parts, sizes, 2)) {
+		CN_TRACE(LogSysRender, "Cached program as %s", cachePath->str);
+	}
+	cnDynamicBuffer_Free(&binary);
 }
 
-bool cnRLL_CreateProgram(GLuint vertexShader, GLuint fragmentShader, GLuint* program,
-	uint32_t programIndex)
+/**
+ * Compiles and links a program without waiting for the results, which are
+ * checked by `cnRLL_FinishProgram`.
+ */
+static void cnRLL_StartProgram(CnProgramBuild* build)
 {
-	CN_ASSERT_NO_GL_ERROR();
+	build->vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	build->fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
 
-	if (!program) {
-		CN_ERROR(LogSysRender, "program is a NULL ptr");
-		return false;
+	if (!glIsShader(build->vertexShader)) {
+		CN_ERROR(LogSysRender, "Unable to allocate space for vertex shader");
 	}
 
-	if (!glIsShader(vertexShader)) {
-		CN_ERROR(LogSysRender, "Vertex shader doesn't exist");
-		return false;
+	if (!glIsShader(build->fragmentShader)) {
+		CN_ERROR(LogSysRender, "Unable to allocate space for fragment shader");
+	}
+
+	cnRLL_CompileShader(build->fragmentShader, &build->fragmentSource);
+	cnRLL_CompileShader(build->vertexShader, &build->vertexSource);
+
+	build->program = glCreateProgram();
+	glProgramParameteri(build->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glAttachShader(build->program, build->vertexShader);
+	glAttachShader(build->program, build->fragmentShader);
+	glLinkProgram(build->program);
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+static const CnProgramSource programSources[] = {
+	{ "shaders/fullscreen_textured_quad.vert", "shaders/uv_as_red_green.frag", CnProgramIndexFullScreen },
+	{ "shaders/solid_polygon.vert", "shaders/solid_polygon.frag", CnProgramIndexSolidPolygon },
+	{ "shaders/atlas_sprite.vert", "shaders/atlas_sprite.frag", CnProgramIndexSprite },
+	{ "shaders/sprite_array.vert", "shaders/sprite_array.frag", CnProgramIndexSpriteArray },
+	{ "shaders/glyph.vert", "shaders/glyph.frag", CnProgramIndexGlyph },
+	{ "shaders/fullscreen_textured_quad.vert", "shaders/atlas_sprite.frag", CnProgramIndexLayer },
+	{ "shaders/tilemap.vert", "shaders/atlas_sprite.frag", CnProgramIndexTilemap }
+};
+
+/**
+ * Loads every program, from the program cache when possible.  Programs which
+ * aren't cached are all compiled and linked before any results are checked,
+ * so drivers which compile on other threads can overlap the work.
+ */
+void cnRLL_LoadShaders(void)
+{
+	const uint64_t driverHash = cnRLL_DriverHash();
+	CnProgramBuild builds[CN_ARRAY_SIZE(programSources)];
+	memset(builds, 0, sizeof(builds));
+
+	uint32_t numCached = 0;
+	const uint64_t cacheStart = SDL_GetPerformanceCounter();
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(programSources); ++i) {
+		const CnProgramSource* source = &programSources[i];
+		CnProgramBuild* build = &builds[i];
+		build->hasSources = cnRLL_ReadShaderSource(source->vertexShader, &build->vertexSource)
+			&& cnRLL_ReadShaderSource(source->fragmentShader, &build->fragmentSource);
+		if (!build->hasSources) {
+			continue;
+		}
+
+		build->sourceHash = cnRLL_HashBytes(driverHash, build->vertexSource.contents, build->vertexSource.size);
+		build->sourceHash = cnRLL_HashBytes(build->sourceHash, build->fragmentSource.contents,
+			build->fragmentSource.size);
+
+		const uint64_t nameHash = cnRLL_HashBytes(cnArchive_HashName(source->vertexShader),
+			source->fragmentShader, strlen(source->fragmentShader));
+		build->hasCachePath = cnImageCache_EntryPath(nameHash, "glprogram", &build->cachePath);
+		if (build->hasCachePath && cnRLL_LoadProgramBinary(&build->cachePath, build->sourceHash, &build->program)) {
+			cnRLL_RegisterProgram(source->programIndex, build->program);
+			build->cached = true;
+			++numCached;
+		}
 	}
+	const uint64_t cacheMicros = (SDL_GetPerformanceCounter() - cacheStart) * 1000000
+		/ SDL_GetPerformanceFrequency();
+
+	uint32_t numCompiled = 0;
+	const uint64_t compileStart = SDL_GetPerformanceCounter();
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(programSources); ++i) {
+		if (builds[i].hasSources && !builds[i].cached) {
+			cnRLL_StartProgram(&builds[i]);
+		}
+	}
+
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(programSources); ++i) {
+		CnProgramBuild* build = &builds[i];
+		if (build->hasSources && !build->cached) {
+			const bool compiled = cnRLL_CheckShader(build->fragmentShader, programSources[i].fragmentShader)
+				&& cnRLL_CheckShader(build->vertexShader, programSources[i].vertexShader);
+			if (!compiled || !cnRLL_FinishProgram(build, programSources[i].programIndex)) {
+				CN_TRACE(LogSysRender, "Fragment shader %s", build->fragmentSource.contents);
+				CN_TRACE(LogSysRender, "Vertex shader %s", build->vertexSource.contents);
+				CN_ERROR(LogSysRender, "Unable to create shader program");
+				glDeleteProgram(build->program);
+				build->program = 0;
+			}
+			else {
+				if (build->hasCachePath) {
+					cnRLL_StoreProgramBinary(&build->cachePath, build->sourceHash, build->program);
+				}
+				++numCompiled;
+			}
+			glDeleteShader(build->vertexShader);
+			glDeleteShader(build->fragmentShader);
+		}
 
-	if (!glIsShader(fragmentShader)) {
-		CN_ERROR(LogSysRender, "Fragment shader doesn't exist");
+		if (build->vertexSource.contents) {
+			cnDynamicBuffer_Free(&build->vertexSource);
+		}
+		if (build->fragmentSource.contents) {
+			cnDynamicBuffer_Free(&build->fragmentSource);
+		}
 	}
+	const uint64_t compileMicros = (SDL_GetPerformanceCounter() - compileStart) * 1000000
+		/ SDL_GetPerformanceFrequency();
 
-	*program = glCreateProgram();
-	glAttachShader(*program, vertexShader);
-	glAttachShader(*program, fragmentShader);
-	glLinkProgram(*program);
+	CN_TRACE(LogSysRender, "Programs: %" PRIu32 " loaded from cache in %" PRIu64 " us, %" PRIu32
+		" compiled in %" PRIu64 " us", numCached, cacheMicros, numCompiled, compileMicros);
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+/**
+ * Checks that a program started by `cnRLL_StartProgram` linked, and registers
+ * it to the given index.
+ */
+static bool cnRLL_FinishProgram(CnProgramBuild* build, uint32_t programIndex)
+{
+	CN_ASSERT_NO_GL_ERROR();
 
 	GLint linkResult;
-	glGetProgramiv(*program, GL_LINK_STATUS, &linkResult);
+	glGetProgramiv(build->program, GL_LINK_STATUS, &linkResult);
 
 	GLint infoLogLength;
-	glGetProgramiv(*program, GL_INFO_LOG_LENGTH, &infoLogLength);
+	glGetProgramiv(build->program, GL_INFO_LOG_LENGTH, &infoLogLength);
 	if (infoLogLength > 0) {
 		if (MAX_INFO_LOG_LENGTH < infoLogLength) {
 			CN_ERROR(LogSysRender, "Info log is too small to hold all output");
 		}
 		char infoLog[MAX_INFO_LOG_LENGTH];
-		glGetProgramInfoLog(*program, infoLogLength, NULL, infoLog);
+		glGetProgramInfoLog(build->program, infoLogLength, NULL, infoLog);
 		CN_TRACE(LogSysRender, "Link log: %s\n", infoLog);
 	}
 
@@ -904,28 +1635,25 @@ bool cnRLL_CreateProgram(GLuint vertexShader, GLuint fragmentShader, GLuint* pro
 		return false;
 	}
 
-	glDetachShader(*program, vertexShader);
-	glDetachShader(*program, fragmentShader);
+	glDetachShader(build->program, build->vertexShader);
+	glDetachShader(build->program, build->fragmentShader);
 
 #if CN_DEBUG
-	cnRLL_PrintProgram(*program);
+	cnRLL_PrintProgram(build->program);
 #endif
 
 	CN_ASSERT_NO_GL_ERROR();
 
-	if (linkResult == GL_TRUE) {
-		cnRLL_RegisterProgram(programIndex, *program);
-	}
+	cnRLL_RegisterProgram(programIndex, build->program);
 	CN_ASSERT_NO_GL_ERROR();
 
-	return linkResult == GL_TRUE;
+	return true;
 }
 
 void cnRLL_Init(CnDimension2u32 resolution)
 {
 	cnRLL_InitGL();
-	cnRLL_ConfigureVSync();
-	cnRLL_InitDummyVAO();
+	cnRLL_SetPresentMode(CnPresentModeVSync);
 	cnRLL_InitVertexFormats();
 	cnRLL_FillBuffers();
 	cnRLL_InitSprites();
@@ -935,22 +1663,486 @@ void cnRLL_Init(CnDimension2u32 resolution)
 	windowHeight = (GLsizei)resolution.height;
 
 	cnRLL_SetCameraAABB2(cnRLL_BackingCanvasArea());
+	cnResidency_Init(&textureResidency, CN_RESIDENCY_NO_BUDGET);
+	cnRenderScale_Init(&renderScaleController, CN_RENDER_SCALE_NO_BUDGET, 1.0f);
+	glGenQueries(RLL_FRAME_QUERIES, frameQueries);
+	for (uint32_t i = 0; i < RLL_MAX_FRAMES_IN_FLIGHT; ++i) {
+		glGenQueries(1, &framesInFlight[i].finishQuery);
+	}
 }
 
 void cnRLL_Shutdown(void)
 {
+	cnRLL_StopCapture();
+
+	for (uint32_t i = 0; i < MaxSpriteId; ++i) {
+		if (spriteTextures[i] != 0) {
+			glDeleteTextures(1, &spriteTextures[i]);
+			spriteTextures[i] = 0;
+		}
+		spriteArraySlots[i] = 0;
+		spriteIsTileset[i] = false;
+	}
+
+	for (uint32_t i = 0; i < RLL_MAX_SPRITE_ARRAYS; ++i) {
+		if (spriteArrays[i].texture != 0) {
+			glDeleteTextures(1, &spriteArrays[i].texture);
+		}
+		memset(&spriteArrays[i], 0, sizeof(CnSpriteArray));
+	}
+
+	for (uint32_t i = 0; i < MaxFontId; ++i) {
+		if (fontTextures[i] != 0) {
+			glDeleteTextures(1, &fontTextures[i]);
+			fontTextures[i] = 0;
+		}
+		if (textureResidency.entries[RLL_RESIDENCY_FONT(i)].tracked) {
+			cnFont_PSF2Free(&fonts[i]);
+		}
+	}
+
+	cnResidency_Init(&textureResidency, CN_RESIDENCY_NO_BUDGET);
+
+	glBindVertexArray(0);
+	for (uint32_t i = 0; i < RLL_MAX_MESHES; ++i) {
+		if (meshes[i].buffer != 0) {
+			cnRLL_DestroyMesh(i + 1);
+		}
+	}
+	for (uint32_t i = 0; i < RLL_MAX_TILEMAPS; ++i) {
+		if (tilemaps[i].used) {
+			cnRLL_DestroyTilemap(i + 1);
+		}
+	}
+	if (tilesetSampler != 0) {
+		glDeleteSamplers(1, &tilesetSampler);
+		tilesetSampler = 0;
+	}
+	activeLayer = 0;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	for (uint32_t i = 0; i < RLL_MAX_LAYERS; ++i) {
+		if (layers[i].framebuffer != 0) {
+			cnRLL_DestroyLayer(i + 1);
+		}
+	}
+	for (uint32_t i = 0; i < numVertexArrays; ++i) {
+		glDeleteVertexArrays(1, &vertexArrays[i].vao);
+	}
+	numVertexArrays = 0;
+
+	renderScale = 1.0f;
+	if (sceneFramebuffer != 0) {
+		glDeleteFramebuffers(1, &sceneFramebuffer);
+		glDeleteTextures(1, &sceneTexture);
+		sceneFramebuffer = 0;
+		sceneTexture = 0;
+	}
+	glDeleteQueries(RLL_FRAME_QUERIES, frameQueries);
+	numPendingFrameQueries = 0;
+	frameQueryActive = false;
+
+	while (numFramesInFlight > 0) {
+		const uint32_t oldest = (nextFrameInFlight + RLL_MAX_FRAMES_IN_FLIGHT - numFramesInFlight)
+			% RLL_MAX_FRAMES_IN_FLIGHT;
+		glDeleteSync(framesInFlight[oldest].fence);
+		--numFramesInFlight;
+	}
+	for (uint32_t i = 0; i < RLL_MAX_FRAMES_IN_FLIGHT; ++i) {
+		glDeleteQueries(1, &framesInFlight[i].finishQuery);
+		framesInFlight[i].finishQuery = 0;
+	}
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+static uint64_t cnRLL_TicksToMicros(uint64_t ticks)
+{
+	return ticks * 1000000 / SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Hands the oldest pending readback to the capture worker once the GPU has
+ * filled it, waiting for it if requested.
+ *
+ * @return true if the readback was finished
+ */
+static bool cnRLL_FinishCaptureReadback(bool wait)
+{
+	CN_ASSERT(numPendingCaptureReadbacks > 0, "No capture readbacks to finish");
+	const uint32_t oldest = (nextCaptureReadback + RLL_CAPTURE_BUFFERS - numPendingCaptureReadbacks)
+		% RLL_CAPTURE_BUFFERS;
+	CnCaptureReadback* readback = &captureReadbacks[oldest];
+
+	const GLenum result = glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000 : 0);
+	if (result == GL_TIMEOUT_EXPIRED) {
+		return false;
+	}
+	glDeleteSync(readback->fence);
+	readback->fence = 0;
+	--numPendingCaptureReadbacks;
+
+	CnImageRGBA8* frame = cnRCapture_AcquireFrame();
+	if (!frame) {
+		return true;
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+	const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)frame->pixels.size, GL_MAP_READ_BIT);
+	if (pixels) {
+		memcpy(frame->pixels.contents, pixels, frame->pixels.size);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		cnRCapture_SubmitFrame(frame);
+	}
+	else {
+		CN_WARN(LogSysRender, "Unable to map a capture readback buffer");
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return true;
+}
+
+/**
+ * Starts reading the frame in the back buffer into the next pixel pack
+ * buffer, finishing earlier readbacks the GPU is done with.
+ */
+static void cnRLL_CaptureFrame(void)
+{
+	const uint64_t start = SDL_GetPerformanceCounter();
+
+	while (numPendingCaptureReadbacks > 0 && cnRLL_FinishCaptureReadback(false)) {
+	}
+	if (numPendingCaptureReadbacks == RLL_CAPTURE_BUFFERS) {
+		cnRLL_FinishCaptureReadback(true);
+	}
+
+	CnCaptureReadback* readback = &captureReadbacks[nextCaptureReadback];
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glReadBuffer(GL_BACK);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+	glReadPixels(0, 0, windowWidth, windowHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	nextCaptureReadback = (nextCaptureReadback + 1) % RLL_CAPTURE_BUFFERS;
+	++numPendingCaptureReadbacks;
+	CN_ASSERT_NO_GL_ERROR();
+
+	cnRCapture_RecordReadback(cnRLL_TicksToMicros(SDL_GetPerformanceCounter() - start));
+}
+
+/**
+ * Writes every following frame to numbered files in a directory, until
+ * capture is stopped.
+ */
+bool cnRLL_StartCapture(const char* directory, CnCaptureFormat format)
+{
+	CN_ASSERT_PTR(directory);
+	if (cnRCapture_IsActive()) {
+		CN_WARN(LogSysRender, "Capture has already started");
+		return false;
+	}
+
+	const CnDimension2u32 size = { (uint32_t)windowWidth, (uint32_t)windowHeight };
+	if (!cnRCapture_Start(directory, format, size)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < RLL_CAPTURE_BUFFERS; ++i) {
+		glGenBuffers(1, &captureReadbacks[i].buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, captureReadbacks[i].buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, 4 * (GLsizeiptr)windowWidth * windowHeight, NULL, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	nextCaptureReadback = 0;
+	numPendingCaptureReadbacks = 0;
+	CN_ASSERT_NO_GL_ERROR();
+	return true;
+}
+
+/**
+ * Finishes frames still being read back and waits for them to be written.
+ */
+void cnRLL_StopCapture(void)
+{
+	if (!cnRCapture_IsActive()) {
+		return;
+	}
+
+	while (numPendingCaptureReadbacks > 0) {
+		if (!cnRLL_FinishCaptureReadback(true)) {
+			// Give up on frames the GPU never finished.
+			const uint32_t oldest = (nextCaptureReadback + RLL_CAPTURE_BUFFERS - numPendingCaptureReadbacks)
+				% RLL_CAPTURE_BUFFERS;
+			glDeleteSync(captureReadbacks[oldest].fence);
+			--numPendingCaptureReadbacks;
+		}
+	}
+	cnRCapture_Stop();
+
+	for (uint32_t i = 0; i < RLL_CAPTURE_BUFFERS; ++i) {
+		glDeleteBuffers(1, &captureReadbacks[i].buffer);
+		memset(&captureReadbacks[i], 0, sizeof(CnCaptureReadback));
+	}
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+void cnRLL_CaptureStats(CnCaptureStats* stats)
+{
+	cnRCapture_Stats(stats);
+}
+
+/**
+ * Retires the oldest frame in flight once the GPU has finished it, waiting
+ * for it if requested.
+ *
+ * @return true if the frame was retired
+ */
+static bool cnRLL_RetireFrame(bool wait)
+{
+	CN_ASSERT(numFramesInFlight > 0, "No frames in flight to retire");
+	const uint32_t oldest = (nextFrameInFlight + RLL_MAX_FRAMES_IN_FLIGHT - numFramesInFlight)
+		% RLL_MAX_FRAMES_IN_FLIGHT;
+	CnFrameInFlight* frame = &framesInFlight[oldest];
+
+	// Flushing ensures the fence has been submitted, so waiting on it ends.
+	const GLuint64 timeoutNanos = wait ? 1000000000 : 0;
+	const GLenum result = glClientWaitSync(frame->fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNanos);
+	if (result == GL_TIMEOUT_EXPIRED) {
+		if (wait) {
+			CN_WARN(LogSysRender, "Waited over a second for the GPU to finish a frame");
+		}
+		return false;
+	}
+	if (result == GL_WAIT_FAILED) {
+		CN_WARN(LogSysRender, "Waiting on a frame fence failed");
+	}
+
+	// The query was recorded before the fence, so its result is ready without
+	// waiting.
+	GLint64 finishNanos = 0;
+	glGetQueryObjecti64v(frame->finishQuery, GL_QUERY_RESULT, &finishNanos);
+	frameStats.latencyMicros = finishNanos > frame->startNanos
+		? (uint64_t)(finishNanos - frame->startNanos) / 1000 : 0;
+	glDeleteSync(frame->fence);
+	frame->fence = 0;
+	--numFramesInFlight;
+	return true;
+}
+
+/**
+ * Waits until starting another frame would keep the frames in flight within
+ * the limit.
+ */
+static void cnRLL_WaitForFramesInFlight(void)
+{
+	while (numFramesInFlight > 0 && cnRLL_RetireFrame(false)) {
+	}
+	frameStats.framesInFlight = numFramesInFlight;
+
+	const uint64_t waitStart = SDL_GetPerformanceCounter();
+	while (numFramesInFlight >= maxFramesInFlight) {
+		if (!cnRLL_RetireFrame(true)) {
+			break;
+		}
+	}
+	frameStats.waitMicros = cnRLL_TicksToMicros(SDL_GetPerformanceCounter() - waitStart);
+}
+
+/**
+ * Limits how many frames may be submitted before the GPU has finished them.
+ * One frame in flight has the least latency, but leaves the CPU and GPU
+ * taking turns rather than working at the same time.
+ */
+void cnRLL_SetMaxFramesInFlight(uint32_t frames)
+{
+	CN_ASSERT(frames >= 1 && frames <= RLL_MAX_FRAMES_IN_FLIGHT, "Frames in flight must be from 1 to %d: %"
+		PRIu32, RLL_MAX_FRAMES_IN_FLIGHT, frames);
+	maxFramesInFlight = frames;
+}
+
+void cnRLL_FrameStats(CnFrameStats* stats)
+{
+	CN_ASSERT_PTR(stats);
+	*stats = frameStats;
+}
+
+/**
+ * Creates the target frames are drawn into below full render scale.
+ */
+static bool cnRLL_CreateSceneTarget(void)
+{
+	glGenTextures(1, &sceneTexture);
+	glBindTexture(GL_TEXTURE_2D, sceneTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, windowWidth, windowHeight);
+
+	glGenFramebuffers(1, &sceneFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneTexture, 0);
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		CN_WARN(LogSysRender, "Scene framebuffer is incomplete: 0x%x", status);
+		glDeleteFramebuffers(1, &sceneFramebuffer);
+		glDeleteTextures(1, &sceneTexture);
+		sceneFramebuffer = 0;
+		sceneTexture = 0;
+		return false;
+	}
+	CN_ASSERT_NO_GL_ERROR();
+	return true;
+}
+
+/**
+ * Feeds the GPU times of finished frames to the render scale controller,
+ * without waiting on frames the GPU is still drawing.
+ */
+static void cnRLL_ReadFrameQueries(void)
+{
+	while (numPendingFrameQueries > 0) {
+		const uint32_t oldest = (nextFrameQuery + RLL_FRAME_QUERIES - numPendingFrameQueries) % RLL_FRAME_QUERIES;
+		GLint available = 0;
+		glGetQueryObjectiv(frameQueries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			break;
+		}
+
+		GLuint64 nanos = 0;
+		glGetQueryObjectui64v(frameQueries[oldest], GL_QUERY_RESULT, &nanos);
+		--numPendingFrameQueries;
+
+		if (cnRenderScale_AddFrame(&renderScaleController, nanos / 1000)) {
+			CN_TRACE(LogSysRender, "Render scale changed to %.2f",
+				(double)cnRenderScale_Scale(&renderScaleController));
+		}
+	}
+}
+
+/**
+ * Uses the scale picked from recent frame times for the frame being started.
+ */
+static void cnRLL_StartFrameScale(void)
+{
+	if (renderScaleController.budgetMicros == CN_RENDER_SCALE_NO_BUDGET) {
+		renderScale = 1.0f;
+		return;
+	}
+
+	cnRLL_ReadFrameQueries();
+	renderScale = cnRenderScale_Scale(&renderScaleController);
+	if (renderScale < 1.0f && sceneFramebuffer == 0 && !cnRLL_CreateSceneTarget()) {
+		cnRenderScale_Init(&renderScaleController, CN_RENDER_SCALE_NO_BUDGET, 1.0f);
+		renderScale = 1.0f;
+	}
+
+	// Frames are skipped when the GPU is so far behind that every query is
+	// still waiting on results.
+	if (numPendingFrameQueries < RLL_FRAME_QUERIES) {
+		glBeginQuery(GL_TIME_ELAPSED, frameQueries[nextFrameQuery]);
+		frameQueryActive = true;
+	}
+}
+
+/**
+ * Draws frames at a fraction of the backing canvas resolution when they take
+ * longer than a budget of GPU time, and upscales them to the window.  The
+ * backing canvas, viewports and cameras are unchanged, so this is invisible to
+ * what is being drawn other than the loss of detail.
+ *
+ * A budget of zero always draws at full resolution.
+ *
+ * @param minScale the lowest fraction of the resolution to draw at
+ */
+void cnRLL_SetDynamicResolution(uint64_t budgetMicros, float minScale)
+{
+	cnRenderScale_Init(&renderScaleController, budgetMicros, minScale);
+}
+
+float cnRLL_RenderScale(void)
+{
+	return renderScale;
+}
+
+/**
+ * Makes the GL context current on the calling thread.  It must have been
+ * released by the thread it was current on.
+ */
+void cnRLL_AcquireContext(void)
+{
+	if (SDL_GL_MakeCurrent(window, gl) != 0) {
+		CN_ERROR(LogSysRender, "Unable to make GL context current: %s", SDL_GetError());
+	}
+}
+
+void cnRLL_ReleaseContext(void)
+{
+	glFlush();
+	SDL_GL_MakeCurrent(window, NULL);
 }
 
 void cnRLL_StartFrame(void)
 {
 	SDL_GL_MakeCurrent(window, gl);
 	CN_ASSERT_NO_GL_ERROR();
+	cnRLL_WaitForFramesInFlight();
+	glGetInteger64v(GL_TIMESTAMP, &frameStartNanos);
+	cnResidency_StartFrame(&textureResidency);
+	glBindBufferBase(GL_UNIFORM_BUFFER, RLL_VIEW_BLOCK_BINDING, viewBlockBuffer);
+
+	cnRLL_StartFrameScale();
+	glBindFramebuffer(GL_FRAMEBUFFER, cnRLL_SceneFramebuffer());
 }
 
 void cnRLL_EndFrame(void)
 {
+	cnRLL_FlushSpriteBatch();
+
+	if (frameQueryActive) {
+		glEndQuery(GL_TIME_ELAPSED);
+		nextFrameQuery = (nextFrameQuery + 1) % RLL_FRAME_QUERIES;
+		++numPendingFrameQueries;
+		frameQueryActive = false;
+	}
+
+	if (renderScale < 1.0f) {
+		const GLint sceneWidth = (GLint)lroundf((float)windowWidth * renderScale);
+		const GLint sceneHeight = (GLint)lroundf((float)windowHeight * renderScale);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, windowWidth, windowHeight,
+			GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	if (cnRCapture_IsActive()) {
+		cnRLL_CaptureFrame();
+	}
+
+	// Evicting after drawing keeps textures used this frame.
+	cnResidency_Evict(&textureResidency, cnRLL_EvictTexture, NULL);
+
 	CN_ASSERT_NO_GL_ERROR();
 	SDL_GL_SwapWindow(window);
+
+	CN_ASSERT(numFramesInFlight < RLL_MAX_FRAMES_IN_FLIGHT, "Too many frames in flight");
+	CnFrameInFlight* frame = &framesInFlight[nextFrameInFlight];
+	glQueryCounter(frame->finishQuery, GL_TIMESTAMP);
+	frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	frame->startNanos = frameStartNanos;
+	nextFrameInFlight = (nextFrameInFlight + 1) % RLL_MAX_FRAMES_IN_FLIGHT;
+	++numFramesInFlight;
+}
+
+/**
+ * Limits the bytes of sprite and font textures kept on the GPU.  Textures
+ * least recently drawn are evicted at the end of frames in which the budget is
+ * exceeded, and reloaded when next drawn.
+ */
+void cnRLL_SetTextureBudget(uint64_t bytes)
+{
+	cnResidency_SetBudget(&textureResidency, bytes);
+}
+
+void cnRLL_TextureStats(CnResidencyStats* stats)
+{
+	cnResidency_Stats(&textureResidency, stats);
 }
 
 CnDimension2u32 cnRLL_Resolution(void)
@@ -968,21 +2160,57 @@ CnAABB2 cnRLL_Viewport(void)
 	return viewport;
 }
 
+/**
+ * Sets the GL viewport to an area of the backing canvas, in the pixels of the
+ * framebuffer being drawn into.  Layers are always full resolution.
+ */
+static void cnRLL_ApplyViewport(CnAABB2 v)
+{
+	const float scale = activeLayer != 0 ? 1.0f : renderScale;
+	const GLint left = (GLint)lroundf(v.min.x * scale);
+	const GLint bottom = (GLint)lroundf(v.min.y * scale);
+	const GLint right = (GLint)lroundf(v.max.x * scale);
+	const GLint top = (GLint)lroundf(v.max.y * scale);
+	glViewport(left, bottom, right - left, top - bottom);
+}
+
+/**
+ * Matches the step of packed positions to the size of a pixel, for a camera
+ * showing `camera` in the given viewport.  Batches must be drawn first, since
+ * they were packed with the old step.
+ */
+static void cnRLL_UpdatePositionStep(CnAABB2 camera, CnAABB2 v)
+{
+	const float pixelsWide = v.max.x - v.min.x;
+	const float pixelsHigh = v.max.y - v.min.y;
+	const float stepX = (camera.max.x - camera.min.x) / (pixelsWide * RLL_POSITION_SUBPIXELS);
+	const float stepY = (camera.max.y - camera.min.y) / (pixelsHigh * RLL_POSITION_SUBPIXELS);
+
+	// Degenerate views don't draw anything, so any step will do.
+	positionStep.x = isfinite(stepX) && stepX > 0.0f ? stepX : 1.0f / RLL_POSITION_SUBPIXELS;
+	positionStep.y = isfinite(stepY) && stepY > 0.0f ? stepY : 1.0f / RLL_POSITION_SUBPIXELS;
+}
+
 void cnRLL_SetViewport(CnAABB2 v)
 {
 	CN_ASSERT(cnAABB2_FullyContainsAABB2(cnRLL_BackingCanvasArea(), v, 0.0f),
 		"Attempting to draw a viewport not contained on the backing canvas.");
+	cnRLL_FlushSpriteBatch();
 	viewport = v;
-
-	glViewport((GLint)v.min.x, (GLint)v.min.y,
-		(GLsizei)cnAABB2_Width(v), (GLsizei)cnAABB2_Height(v));
+	cnRLL_ApplyViewport(v);
+	cnRLL_UpdatePositionStep(cameraAABB2, v);
 }
 
 void cnRLL_SetCameraAABB2(const CnAABB2 mapSlice)
 {
+	cnRLL_FlushSpriteBatch();
 	cameraAABB2 = mapSlice;
-	uniformStorage[CnUniformNameProjection].f44
-		= cnRLL_OrthoProjection(mapSlice);
+	cnRLL_UpdatePositionStep(mapSlice, viewport);
+
+	CnViewBlock view;
+	view.projection = cnRLL_OrthoProjection(mapSlice);
+	glBindBuffer(GL_UNIFORM_BUFFER, viewBlockBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CnViewBlock), &view);
 }
 
 CnAABB2 cnRLL_CameraAABB2(void)
@@ -993,102 +2221,456 @@ CnAABB2 cnRLL_CameraAABB2(void)
 
 void cnRLL_Clear(CnRGBA8u color)
 {
+	cnRLL_FlushSpriteBatch();
 	glClearColor(color.red, color.green, color.blue, color.alpha);
 	glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void cnRLL_SetFullScreenViewport(void)
 {
-	glViewport(0, 0, windowWidth, windowHeight);
+	cnRLL_FlushSpriteBatch();
+	cnRLL_ApplyViewport(cnRLL_BackingCanvasArea());
 }
 
 CnFloat4x4 cnRLL_MatrixFromTransform(CnTransform2 transform)
 {
-	return cnFloat4x4_Make((float[]) {
-		transform.m[0][0], transform.m[0][1], 0.0f, transform.m[0][2],
-		transform.m[1][0], transform.m[1][1], 0.0f, transform.m[1][2],
-		             0.0f,              0.0f, 1.0f,              0.0f,
-		transform.m[2][0], transform.m[2][1], 0.0f,              1.0f
-	});
+	return cnFloat4x4_Make((float[]) {
+		transform.m[0][0], transform.m[0][1], 0.0f, transform.m[0][2],
+		transform.m[1][0], transform.m[1][1], 0.0f, transform.m[1][2],
+		             0.0f,              0.0f, 1.0f,              0.0f,
+		transform.m[2][0], transform.m[2][1], 0.0f,              1.0f
+	});
+}
+
+/**
+ * Size of the checkerboard shown for sprites which haven't finished loading.
+ */
+#define RLL_PLACEHOLDER_SIZE 8
+
+/**
+ * Gives a sprite a texture name and fills it with a placeholder, so it can be
+ * drawn while its image is still being loaded.
+ */
+void cnRLL_ReserveSprite(CnSpriteId id)
+{
+	CN_ASSERT(id < MaxSpriteId, "Sprite id out of range: %" PRIu32, id);
+	CN_ASSERT_NO_GL_ERROR();
+
+	// Sprites being reloaded into an array keep drawing their old image.
+	if (spriteArraySlots[id] != 0) {
+		return;
+	}
+
+	// Magenta and black, so missing art stands out.
+	uint8_t checkerboard[RLL_PLACEHOLDER_SIZE * RLL_PLACEHOLDER_SIZE * 4];
+	for (uint32_t row = 0; row < RLL_PLACEHOLDER_SIZE; ++row) {
+		for (uint32_t col = 0; col < RLL_PLACEHOLDER_SIZE; ++col) {
+			uint8_t* pixel = &checkerboard[(row * RLL_PLACEHOLDER_SIZE + col) * 4];
+			const uint8_t lit = ((row + col) % 2 == 0) ? 255 : 0;
+			pixel[0] = lit;
+			pixel[1] = 0;
+			pixel[2] = lit;
+			pixel[3] = 255;
+		}
+	}
+
+	if (spriteTextures[id] == 0) {
+		glGenTextures(1, &spriteTextures[id]);
+	}
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, spriteTextures[id]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, RLL_PLACEHOLDER_SIZE, RLL_PLACEHOLDER_SIZE, 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, checkerboard);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// Placeholders have nothing to reload from, so must stay resident.
+	cnResidency_Add(&textureResidency, RLL_RESIDENCY_SPRITE(id), sizeof(checkerboard), true);
+
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+/**
+ * Place sprites loaded from now on into texture arrays shared with other
+ * sprites of the same size, rather than giving each its own texture.
+ */
+void cnRLL_SetSpriteArrays(bool enabled)
+{
+	useSpriteArrays = enabled;
+}
+
+/**
+ * Finds the array to hold sprites of a size, creating one if needed.
+ *
+ * @return one more than the index of the array, or 0 if there is no room
+ */
+static uint32_t cnRLL_FindSpriteArray(CnDimension2u32 size, uint32_t numLevels)
+{
+	for (uint32_t i = 0; i < RLL_MAX_SPRITE_ARRAYS; ++i) {
+		CnSpriteArray* array = &spriteArrays[i];
+		if (array->texture == 0) {
+			glGenTextures(1, &array->texture);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, array->texture);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint)numLevels - 1);
+			for (uint32_t level = 0; level < numLevels; ++level) {
+				const CnDimension2u32 levelSize = cnImageMips_LevelSize(size, level);
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, GL_RGB, (GLsizei)levelSize.width,
+					(GLsizei)levelSize.height, RLL_SPRITE_ARRAY_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			}
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+				numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			CN_ASSERT_NO_GL_ERROR();
+
+			array->size = size;
+			array->numLevels = numLevels;
+			array->usedLayers = 0;
+			const uint64_t layerBytes = 4 * (uint64_t)size.width * size.height + cnImageMips_TailSize(size, numLevels);
+			cnResidency_Add(&textureResidency, RLL_RESIDENCY_SPRITE_ARRAY(i), RLL_SPRITE_ARRAY_LAYERS * layerBytes,
+				true);
+			CN_TRACE(LogSysRender, "Created sprite array for %" PRIu32 "x%" PRIu32 " sprites",
+				size.width, size.height);
+			return i + 1;
+		}
+
+		if (array->size.width == size.width && array->size.height == size.height
+			&& array->numLevels == numLevels && array->usedLayers < RLL_SPRITE_ARRAY_LAYERS) {
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Uploads a sprite into a layer of a texture array shared with other sprites
+ * of the same size.
+ *
+ * @return false if there is no array with room for the sprite
+ */
+static bool cnRLL_UploadSpriteLayer(CnSpriteId id, const CnCachedImage* image)
+{
+	const CnDimension2u32 size = { .width = image->width, .height = image->height };
+
+	// Sprites reloaded at the same size stay in the same layer.
+	uint32_t slot = spriteArraySlots[id];
+	if (slot != 0) {
+		const CnSpriteArray* current = &spriteArrays[slot - 1];
+		if (current->size.width != size.width || current->size.height != size.height
+			|| current->numLevels != image->numLevels) {
+			slot = 0;
+		}
+	}
+
+	uint32_t layer = slot != 0 ? spriteLayers[id] : 0;
+	if (slot == 0) {
+		slot = cnRLL_FindSpriteArray(size, image->numLevels);
+		if (slot == 0) {
+			return false;
+		}
+		layer = spriteArrays[slot - 1].usedLayers++;
+	}
+
+	// Anything batched might draw from the layer being replaced.
+	cnRLL_FlushSpriteBatch();
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, spriteArrays[slot - 1].texture);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint)layer, (GLsizei)size.width, (GLsizei)size.height, 1,
+		GL_RGBA, GL_UNSIGNED_BYTE, image->pixels);
+	for (uint32_t level = 1; level < image->numLevels; ++level) {
+		const CnDimension2u32 levelSize = cnImageMips_LevelSize(size, level);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, 0, 0, (GLint)layer, (GLsizei)levelSize.width,
+			(GLsizei)levelSize.height, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+			image->mips + cnImageMips_TailOffset(size, level));
+	}
+	CN_ASSERT_NO_GL_ERROR();
+
+	// The placeholder shown while loading isn't needed any more.
+	if (spriteTextures[id] != 0) {
+		glDeleteTextures(1, &spriteTextures[id]);
+		spriteTextures[id] = 0;
+	}
+	cnResidency_Remove(&textureResidency, RLL_RESIDENCY_SPRITE(id));
+	spriteArraySlots[id] = slot;
+	spriteLayers[id] = layer;
+	return true;
+}
+
+/**
+ * Uploads decoded RGBA8 pixels, with Y=0 as the bottom row, as the sprite's
+ * own texture, along with every mip level the image has.
+ *
+ * @return the size of the texture in bytes
+ */
+static uint64_t cnRLL_UploadSpriteTexture(CnSpriteId id, const CnCachedImage* image)
+{
+	if (spriteTextures[id] == 0) {
+		glGenTextures(1, &spriteTextures[id]);
+	}
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, spriteTextures[id]);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image->numLevels - 1);
+
+	// TODO: Use proxy textures to test to see if sufficient space exists.
+	// TODO: Should this be GL_RGBA8?
+	const CnDimension2u32 size = { .width = image->width, .height = image->height };
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (GLsizei)size.width, (GLsizei)size.height, 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, image->pixels);
+	for (uint32_t level = 1; level < image->numLevels; ++level) {
+		const CnDimension2u32 levelSize = cnImageMips_LevelSize(size, level);
+		glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGB, (GLsizei)levelSize.width, (GLsizei)levelSize.height, 0,
+			GL_RGBA, GL_UNSIGNED_BYTE, image->mips + cnImageMips_TailOffset(size, level));
+	}
+
+	// Set the texture parameters.
+	// https://stackoverflow.com/questions/3643932/what-is-the-scope-of-gltexparameters-in-opengl
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// Trilinear filtering when minified, if there are mips to filter between.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		image->numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	CN_ASSERT(glIsTexture(spriteTextures[id]), "Unable to reserve texture for "
+		"sprite %" PRIu32, id);
+
+	CN_ASSERT_NO_GL_ERROR();
+	return 4 * (uint64_t)size.width * size.height + cnImageMips_TailSize(size, image->numLevels);
+}
+
+/**
+ * Uploads a decoded image as a sprite.
+ *
+ * @param path where the image came from, to reload it if it gets evicted
+ */
+bool cnRLL_UploadSprite(CnSpriteId id, const CnCachedImage* image, const char* path)
+{
+	CN_ASSERT(id < MaxSpriteId, "Sprite id out of range: %" PRIu32, id);
+	CN_ASSERT_PTR(image);
+	CN_ASSERT_PTR(image->pixels);
+	CN_ASSERT_PTR(path);
+	CN_ASSERT_NO_GL_ERROR();
+
+	if (!cnPathBuffer_Set(&spritePaths[id], path)) {
+		CN_WARN(LogSysRender, "Sprite path is too long to reload from: %s", path);
+	}
+
+	// Sprites which don't fit in an array fall back to their own texture.
+	if (useSpriteArrays && !spriteIsTileset[id] && cnRLL_UploadSpriteLayer(id, image)) {
+		return true;
+	}
+	spriteArraySlots[id] = 0;
+
+	const uint64_t bytes = cnRLL_UploadSpriteTexture(id, image);
+	cnResidency_Add(&textureResidency, RLL_RESIDENCY_SPRITE(id), bytes, false);
+	return true;
+}
+
+bool cnRLL_LoadSprite(CnSpriteId id, const char* path)
+{
+	// Cached images are already decoded and flipped, so can be uploaded directly
+	// from the cache mapping.
+	CnCachedImage image;
+	if (!cnImageCache_Load(&image, path, true)) {
+		return false;
+	}
+
+	const bool uploaded = cnRLL_UploadSprite(id, &image, path);
+	cnImageCache_Release(&image);
+	return uploaded;
+}
+
+/**
+ * Reloads a sprite's texture if it was evicted, stalling until it's uploaded.
+ */
+static void cnRLL_MakeSpriteResident(CnSpriteId id)
+{
+	if (cnResidency_Touch(&textureResidency, RLL_RESIDENCY_SPRITE(id))) {
+		return;
+	}
+
+	const uint64_t start = SDL_GetPerformanceCounter();
+	CnCachedImage image;
+	if (!cnImageCache_Load(&image, spritePaths[id].str, true)) {
+		CN_WARN(LogSysRender, "Unable to reload sprite %" PRIu32 " from %s", id, spritePaths[id].str);
+		cnRLL_ReserveSprite(id);
+		return;
+	}
+	cnRLL_UploadSpriteTexture(id, &image);
+	cnImageCache_Release(&image);
+
+	const uint64_t micros = (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+	cnResidency_Reloaded(&textureResidency, RLL_RESIDENCY_SPRITE(id), micros);
+	CN_TRACE(LogSysRender, "Reloaded sprite %" PRIu32 " in %" PRIu64 " us", id, micros);
 }
 
-bool cnRLL_LoadSprite(CnSpriteId id, const char* path)
+/**
+ * Draws the first `numSprites` sprites in `spriteBatchVertices` from a texture
+ * array, with positions unpacked as `origin + position * step`.
+ */
+static void cnRLL_DrawSpriteBatch(uint32_t array, uint32_t numSprites, CnFloat4x4 viewModel, CnFloat2 origin,
+	CnFloat2 step)
 {
 	CN_ASSERT_NO_GL_ERROR();
 
-	glGenTextures(1, &spriteTextures[id]);
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, spriteTextures[id]);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, spriteArrays[array - 1].texture);
+
+	// Batches are flushed from inside other draws, after those have set up their
+	// own uniforms, so the ones changed for the batch are put back afterwards.
+	const CnFloat4x4 lastViewModel = uniformStorage[CnUniformNameViewModel].f44;
+	const CnFloat2 lastOrigin = uniformStorage[CnUniformNameBatchOrigin].f2;
+	const CnFloat2 lastStep = uniformStorage[CnUniformNamePositionStep].f2;
+
+	uniformStorage[CnUniformNameViewModel].f44 = viewModel;
+	uniformStorage[CnUniformNameBatchOrigin].f2 = origin;
+	uniformStorage[CnUniformNamePositionStep].f2 = step;
+	glBindBuffer(GL_ARRAY_BUFFER, spriteBatchBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CnSpriteBatchVertex) * RLL_VERTICES_PER_SPRITE * numSprites,
+		spriteBatchVertices);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSpriteArray, &vertexFormats[CnVertexFormatSpriteBatch],
+		spriteBatchBuffer);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(RLL_VERTICES_PER_SPRITE * numSprites));
+
+	uniformStorage[CnUniformNameViewModel].f44 = lastViewModel;
+	uniformStorage[CnUniformNameBatchOrigin].f2 = lastOrigin;
+	uniformStorage[CnUniformNamePositionStep].f2 = lastStep;
+	CN_ASSERT_NO_GL_ERROR();
+}
 
-	CnImageRGBA8 image;
-	if (!cnImageRGBA8_Allocate(&image, path)) {
-		return false;
+/**
+ * Draws all sprites batched from the current texture array.
+ */
+static void cnRLL_FlushSpriteBatch(void)
+{
+	if (spriteBatchSize == 0) {
+		return;
 	}
 
-	// Don't mipmap for now.
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	cnRLL_DrawSpriteBatch(spriteBatchArray, spriteBatchSize, cnFloat4x4_Identity(), spriteBatchOrigin,
+		positionStep);
+	spriteBatchSize = 0;
+	spriteBatchArray = 0;
+}
 
-	// TODO: Use proxy textures to test to see if sufficient space exists.
-	// TODO: Should this be GL_RGBA8?
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0,
-		GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.contents);
+static bool cnRLL_PackSpriteCorners(CnFloat2 position, CnDimension2f size, CnPackedPosition* corners)
+{
+	return cnRLL_PackPosition(spriteBatchOrigin, position, &corners[0])
+		&& cnRLL_PackPosition(spriteBatchOrigin, cnFloat2_Add(position, cnFloat2_Make(size.width, 0.0f)), &corners[1])
+		&& cnRLL_PackPosition(spriteBatchOrigin, cnFloat2_Add(position, cnFloat2_Make(0.0f, size.height)), &corners[2])
+		&& cnRLL_PackPosition(spriteBatchOrigin, cnFloat2_Add(position, cnFloat2_Make(size.width, size.height)),
+			&corners[3]);
+}
 
-	// Set the texture parameters.
-	// https://stackoverflow.com/questions/3643932/what-is-the-scope-of-gltexparameters-in-opengl
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+static void cnRLL_WriteSpriteVertices(CnSpriteBatchVertex* vertices, const CnPackedPosition* corners,
+	uint16_t layer)
+{
+	const CnSpriteBatchVertex lowerLeft = { corners[0], { 0, 0 }, layer, 0 };
+	const CnSpriteBatchVertex lowerRight = { corners[1], { RLL_UNORM16_ONE, 0 }, layer, 0 };
+	const CnSpriteBatchVertex upperLeft = { corners[2], { 0, RLL_UNORM16_ONE }, layer, 0 };
+	const CnSpriteBatchVertex upperRight = { corners[3], { RLL_UNORM16_ONE, RLL_UNORM16_ONE }, layer, 0 };
+
+	vertices[0] = lowerLeft;
+	vertices[1] = lowerRight;
+	vertices[2] = upperLeft;
+	vertices[3] = lowerRight;
+	vertices[4] = upperRight;
+	vertices[5] = upperLeft;
+}
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+/**
+ * Draws a sprite from an array which is too large to batch on its own, as a
+ * unit quad scaled and moved into place like sprites with their own texture.
+ */
+static void cnRLL_DrawUnbatchedArraySprite(CnSpriteId id, CnFloat2 position, CnDimension2f size)
+{
+	cnRLL_FlushSpriteBatch();
 
-	CN_ASSERT(glIsTexture(spriteTextures[id]), "Unable to reserve texture for "
-		"sprite loading from path: %s", path);
+	const CnPackedPosition unitQuad[4] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+	cnRLL_WriteSpriteVertices(spriteBatchVertices, unitQuad, (uint16_t)spriteLayers[id]);
+	const CnFloat4x4 viewModel = cnFloat4x4_Multiply(
+		cnFloat4x4_NonUniformScale(size.width, size.height, 1.0f),
+		cnFloat4x4_Translate(position.x, position.y, 0.0f));
+	cnRLL_DrawSpriteBatch(spriteArraySlots[id], 1, viewModel, cnFloat2_Make(0.0f, 0.0f),
+		cnFloat2_Make(1.0f, 1.0f));
+}
 
-	cnImageRGBA8_Free(&image);
+static void cnRLL_AddToSpriteBatch(CnSpriteId id, CnFloat2 position, CnDimension2f size)
+{
+	if (spriteBatchArray != spriteArraySlots[id] || spriteBatchSize == RLL_MAX_SPRITES_PER_BATCH) {
+		cnRLL_FlushSpriteBatch();
+	}
+	if (spriteBatchSize == 0) {
+		spriteBatchOrigin = position;
+	}
+	spriteBatchArray = spriteArraySlots[id];
+
+	// Corners too far from the start of the batch start a new batch.
+	CnPackedPosition corners[4];
+	if (!cnRLL_PackSpriteCorners(position, size, corners)) {
+		cnRLL_FlushSpriteBatch();
+		spriteBatchOrigin = position;
+		if (!cnRLL_PackSpriteCorners(position, size, corners)) {
+			cnRLL_DrawUnbatchedArraySprite(id, position, size);
+			return;
+		}
+		spriteBatchArray = spriteArraySlots[id];
+	}
 
-	CN_ASSERT_NO_GL_ERROR();
-	return true;
+	cnRLL_WriteSpriteVertices(&spriteBatchVertices[spriteBatchSize * RLL_VERTICES_PER_SPRITE], corners,
+		(uint16_t)spriteLayers[id]);
+	++spriteBatchSize;
 }
 
 void cnRLL_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size)
 {
+	CN_ASSERT(id < MaxSpriteId, "Sprite id out of range: %" PRIu32, id);
+
+	if (spriteArraySlots[id] != 0) {
+		cnRLL_AddToSpriteBatch(id, position, size);
+		return;
+	}
+
+	cnRLL_MakeSpriteResident(id);
 	CN_ASSERT_NO_GL_ERROR();
 
 	GLuint texture = spriteTextures[id];
-	CN_ASSERT(glIsTexture(texture), "Sprite %" PRIu32 " does not have a valid"
+	RLL_DEBUG_ASSERT(glIsTexture(texture), "Sprite %" PRIu32 " does not have a valid"
 		"texture", id);
-	cnRLL_ReadyTexture2(0, spriteTextures[id]);
+	cnRLL_ReadyTexture2(0, texture);
 
-	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Multiply(
+	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Multiply(
 		cnFloat4x4_NonUniformScale(size.width, size.height, 1.0f),
-		cnFloat4x4_Translate(position.x, position.y, 0.0f));;
+		cnFloat4x4_Translate(position.x, position.y, 0.0f));
 
 	glBindBuffer(GL_ARRAY_BUFFER, spriteBuffer);
 	CN_ASSERT_NO_GL_ERROR();
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &vertexFormats[CnVertexFormatP2T2Interleaved]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &vertexFormats[CnVertexFormatP2T2Interleaved],
+		spriteBuffer);
 
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-	cnRLL_DisableProgram(CnProgramIndexSprite);
-
 	CN_ASSERT_NO_GL_ERROR();
 }
 
 /**
- * Loads a PSF2 font from a given font into the specific id.
+ * Uploads the atlas of a font, which is built flipped for upload.
  */
-bool cnRLL_LoadPSF2Font(CnFontId id, const char* path)
+static void cnRLL_UploadFontTexture(CnFontId id)
 {
-	// TODO: Check to determine if the font id has already been used.
-
-	CN_ASSERT(path != NULL, "Cannot load a font from a null path");
-	CN_ASSERT(cnPath_IsFile(path), "PSF2 font does not exist");
-
 	CN_ASSERT_NO_GL_ERROR();
-
 	CnFontPSF2* font = &fonts[id];
-	cnFont_PSF2Allocate(&fonts[id], path);
 
 	glGenTextures(1, &fontTextures[id]);
 	CN_ASSERT(fontTextures[id] != 0, "Could not allocate a texture name for the font.");
@@ -1099,7 +2681,6 @@ bool cnRLL_LoadPSF2Font(CnFontId id, const char* path)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 
-	cnImageRGBA8_Flip(&font->atlas.image);
 	CN_ASSERT(font->atlas.image.pixels.size == font->atlas.backingSizePixels.width * font->atlas.backingSizePixels.height * 4,
 		"Backing size doesn't match pixel size.");
 
@@ -1125,77 +2706,147 @@ bool cnRLL_LoadPSF2Font(CnFontId id, const char* path)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
 	CN_ASSERT(glIsTexture(fontTextures[id]), "Unable to reserve texture for "
-		"font loading from path: %s", path);
+		"font %" PRIu32, id);
 
 	CN_ASSERT_NO_GL_ERROR();
-	return true;
 }
 
-static void cnRLL_AddToGlyphBatch(CnFloat2 position, CnDimension2f size, CnFloat2* texCoords)
+/**
+ * Takes ownership of a loaded font and uploads its atlas.  The atlas stays in
+ * memory to reload the texture from if it gets evicted.
+ */
+bool cnRLL_UploadPSF2Font(CnFontId id, CnFontPSF2* loaded)
 {
-	const uint32_t glyphOffset = usedGlyphs * RLL_VERTICES_PER_GLYPH;
-	glyphTexCoords[glyphOffset] = texCoords[0];
-	glyphTexCoords[glyphOffset + 1] = texCoords[1];
-	glyphTexCoords[glyphOffset + 2] = texCoords[2];
+	// TODO: Check to determine if the font id has already been used.
+	CN_ASSERT(id < MaxFontId, "Font id out of range: %" PRIu32, id);
+	CN_ASSERT_PTR(loaded);
 
-	glyphTexCoords[glyphOffset + 3] = texCoords[1];
-	glyphTexCoords[glyphOffset + 4] = texCoords[3];
-	glyphTexCoords[glyphOffset + 5] = texCoords[2];
+	fonts[id] = *loaded;
+	cnRLL_UploadFontTexture(id);
+	cnResidency_Add(&textureResidency, RLL_RESIDENCY_FONT(id), fonts[id].atlas.image.pixels.size, false);
+	return true;
+}
 
-	glyphVertices[glyphOffset + 0] = position;
-	glyphVertices[glyphOffset + 1] = cnFloat2_Add(position, cnFloat2_Make(size.width, 0.0f));
-	glyphVertices[glyphOffset + 2] = cnFloat2_Add(position, cnFloat2_Make(0.0f, size.height));
+/**
+ * Reloads a font's texture if it was evicted, stalling until it's uploaded.
+ */
+static void cnRLL_MakeFontResident(CnFontId id)
+{
+	if (cnResidency_Touch(&textureResidency, RLL_RESIDENCY_FONT(id))) {
+		return;
+	}
 
-	glyphVertices[glyphOffset + 3] = cnFloat2_Add(position, cnFloat2_Make(size.width, 0.0f));
-	glyphVertices[glyphOffset + 4] = cnFloat2_Add(position, cnFloat2_Make(size.width, size.height));
-	glyphVertices[glyphOffset + 5] = cnFloat2_Add(position, cnFloat2_Make(0.0f, size.height));
-	++usedGlyphs;
+	const uint64_t start = SDL_GetPerformanceCounter();
+	cnRLL_UploadFontTexture(id);
+	const uint64_t micros = (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+	cnResidency_Reloaded(&textureResidency, RLL_RESIDENCY_FONT(id), micros);
+	CN_TRACE(LogSysRender, "Reloaded font %" PRIu32 " in %" PRIu64 " us", id, micros);
 }
 
-static void cnRLL_AppendGlyph(CnFontId id, CnFloat2 position, CnGlyphIndex glyphIndex)
+/**
+ * Fonts which are still loading have no texture, and aren't drawn.  Evicted
+ * fonts are still ready, their textures are reloaded when drawn.
+ */
+bool cnRLL_IsFontReady(CnFontId id)
 {
-	CnFontPSF2* font = &fonts[id];
-	CN_ASSERT(glyphIndex != CN_GRAPHEME_INDEX_INVALID, "Cannot draw an invalid glyph");
+	return id < MaxFontId && textureResidency.entries[RLL_RESIDENCY_FONT(id)].tracked;
+}
 
-	// Get the glyph size, should go in printing parameters.
-	// TODO: Use aspect ratio of the glyph.
-	const CnDimension2f glyphSize = (CnDimension2f) { .width = 30.0f, .height = 50.0f };
+/**
+ * Releases the texture of an evicted sprite or font.
+ */
+static void cnRLL_EvictTexture(uint32_t entry, void* userData)
+{
+	CN_UNUSED(userData);
+
+	GLuint* texture;
+	if (entry < RLL_RESIDENCY_FONT(0)) {
+		texture = &spriteTextures[entry];
+	}
+	else {
+		CN_ASSERT(entry < RLL_RESIDENCY_SPRITE_ARRAY(0), "Sprite arrays are never evicted: %" PRIu32, entry);
+		texture = &fontTextures[entry - RLL_RESIDENCY_FONT(0)];
+	}
+	CN_ASSERT(*texture != 0, "Evicting a texture which was never uploaded: %" PRIu32, entry);
+	glDeleteTextures(1, texture);
+	*texture = 0;
+	CN_TRACE(LogSysRender, "Evicted texture %" PRIu32, entry);
+}
+
+/**
+ * Loads a PSF2 font from a given font into the specific id.
+ */
+bool cnRLL_LoadPSF2Font(CnFontId id, const char* path)
+{
+	CN_ASSERT(path != NULL, "Cannot load a font from a null path");
+	CN_ASSERT(cnAssets_FileExists(path), "PSF2 font does not exist");
 
-	CnFloat2 texCoords[4];
-	cnTextureAtlas_TexCoordForSubImage(&font->atlas, &texCoords[0], glyphIndex);
-	cnRLL_AddToGlyphBatch(position, glyphSize, texCoords);
+	CnFontPSF2 font;
+	if (!cnFont_PSF2Allocate(&font, path)) {
+		CN_ERROR(LogSysRender, "Unable to load PSF2 font: %s", path);
+		return false;
+	}
+	return cnRLL_UploadPSF2Font(id, &font);
 }
 
 /**
  * The final draw call to write text once all the glyphs have been assembled.
+ * Only the instances used are uploaded.
  */
 static void cnRLL_DrawGlyphs(CnFontId id)
 {
+	cnRLL_MakeFontResident(id);
 	CN_ASSERT_NO_GL_ERROR();
 	const GLuint texture = fontTextures[id];
-	CN_ASSERT(glIsTexture(texture), "Sprite %" PRIu32 " does not have a valid"
+	RLL_DEBUG_ASSERT(glIsTexture(texture), "Sprite %" PRIu32 " does not have a valid"
 		"texture", texture);
-	cnRLL_ReadyTexture2(0, fontTextures[id]);
-
-	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Identity();
-	glBindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
+	cnRLL_ReadyTexture2(0, texture);
 
-	const size_t verticesSize = sizeof(float) * 2 * RLL_MAX_GLYPH_VERTICES_PER_DRAW;
-	const size_t texCoordsSize = sizeof(float) * 2 * RLL_MAX_GLYPH_VERTICES_PER_DRAW;
-	CN_ASSERT(verticesSize + texCoordsSize == RLL_GLYPH_BUFFER_SIZE, "Insufficient size"
-		" for vertices and texture coordinates: %zu and %zu -> %zu",
-		verticesSize, texCoordsSize,  RLL_GLYPH_BUFFER_SIZE);
+	// TODO: Use aspect ratio of the glyph.
+	const CnTextureAtlas* atlas = &fonts[id].atlas;
+	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
+	uniformStorage[CnUniformNameGlyphSize].f2 = cnFloat2_Make(30.0f, 50.0f);
+	uniformStorage[CnUniformNameAtlasGrid].f2 = cnFloat2_Make((float)atlas->gridSize.width,
+		(float)atlas->gridSize.height);
+	uniformStorage[CnUniformNameBatchOrigin].f2 = glyphBatchOrigin;
+	uniformStorage[CnUniformNamePositionStep].f2 = positionStep;
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, verticesSize, glyphVertices);
-	glBufferSubData(GL_ARRAY_BUFFER, verticesSize, texCoordsSize, glyphTexCoords);
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &glyphFormat);
-	glDrawArrays(GL_TRIANGLES, 0, 6 * usedGlyphs);
+	glBindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CnGlyphInstance) * usedGlyphs, glyphInstances);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexGlyph, &glyphFormat, glyphBuffer);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)usedGlyphs);
 
 	usedGlyphs = 0;
-	cnRLL_DisableProgram(CnProgramIndexSprite);
 	CN_ASSERT_NO_GL_ERROR();
 }
 
+static void cnRLL_AppendGlyph(CnFontId id, CnFloat2 position, CnGlyphIndex glyphIndex, CnRGBA8u color)
+{
+	CN_ASSERT(glyphIndex != CN_GRAPHEME_INDEX_INVALID, "Cannot draw an invalid glyph");
+	CN_ASSERT(glyphIndex < fonts[id].atlas.totalImages, "Glyph %" PRIu32 " is outside of the font atlas",
+		glyphIndex);
+	CN_ASSERT(glyphIndex <= UINT16_MAX, "Glyph %" PRIu32 " is too large to draw", glyphIndex);
+
+	if (usedGlyphs == RLL_MAX_GLYPHS_PER_DRAW) {
+		cnRLL_DrawGlyphs(id);
+	}
+	if (usedGlyphs == 0) {
+		glyphBatchOrigin = position;
+	}
+
+	CnGlyphInstance* instance = &glyphInstances[usedGlyphs];
+	if (!cnRLL_PackPosition(glyphBatchOrigin, position, &instance->position)) {
+		cnRLL_DrawGlyphs(id);
+		glyphBatchOrigin = position;
+		instance = &glyphInstances[0];
+		cnRLL_PackPosition(glyphBatchOrigin, position, &instance->position);
+	}
+	instance->glyphIndex = (uint16_t)glyphIndex;
+	instance->padding = 0;
+	instance->color = color;
+	++usedGlyphs;
+}
+
 /**
  * @param id
  * @param textPosition
@@ -1203,6 +2854,10 @@ static void cnRLL_DrawGlyphs(CnFontId id)
  */
 void cnRLL_DrawSimpleText(CnFontId id, CnTextDrawParams* params, const char* text)
 {
+	if (!cnRLL_IsFontReady(id)) {
+		return;
+	}
+
 	CnFontPSF2* font = &fonts[id];
 	// TODO: Check to ensure the id is valid.
 	CN_ASSERT(params != NULL, "Cannot draw with null parameters.");
@@ -1233,7 +2888,7 @@ void cnRLL_DrawSimpleText(CnFontId id, CnTextDrawParams* params, const char* tex
 			const CnGlyphIndex graphemeIndex = cnGraphemeMap_GraphemeIndexForCodePoints(&font->map, (uint8_t*) cursor,
 																						graphemeLength);
 			if (graphemeIndex != CN_GRAPHEME_INDEX_INVALID) {
-				cnRLL_AppendGlyph(id, glyphPosition, font->map.glyphs[graphemeIndex]);
+				cnRLL_AppendGlyph(id, glyphPosition, font->map.glyphs[graphemeIndex], params->color);
 				graphemeByteSize = font->map.graphemes[graphemeIndex].byteLength;
 				break;
 			}
@@ -1255,12 +2910,296 @@ void cnRLL_DrawDebugFullScreenRect(void)
 
 	glBindBuffer(GL_ARRAY_BUFFER, fullScreenQuadBuffer);
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexFullScreen, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexFullScreen, &vertexFormats[CnVertexFormatP2],
+		fullScreenQuadBuffer);
+
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+bool cnRLL_CreateLayer(CnLayerId* id)
+{
+	CN_ASSERT_PTR(id);
+
+	uint32_t slot = 0;
+	while (slot < RLL_MAX_LAYERS && layers[slot].framebuffer != 0) {
+		++slot;
+	}
+	if (slot == RLL_MAX_LAYERS) {
+		CN_WARN(LogSysRender, "Unable to create a layer, all %d layers are in use", RLL_MAX_LAYERS);
+		return false;
+	}
+
+	CnLayer* layer = &layers[slot];
+	glGenTextures(1, &layer->texture);
+	glBindTexture(GL_TEXTURE_2D, layer->texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, windowWidth, windowHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenFramebuffers(1, &layer->framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, layer->framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer->texture, 0);
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, activeLayer != 0 ? layers[activeLayer - 1].framebuffer : cnRLL_SceneFramebuffer());
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		CN_WARN(LogSysRender, "Layer framebuffer is incomplete: 0x%x", status);
+		glDeleteFramebuffers(1, &layer->framebuffer);
+		glDeleteTextures(1, &layer->texture);
+		memset(layer, 0, sizeof(CnLayer));
+		return false;
+	}
+
+	layer->dirty = true;
+	CN_ASSERT_NO_GL_ERROR();
+
+	*id = slot + 1;
+	return true;
+}
+
+void cnRLL_DestroyLayer(CnLayerId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_LAYERS, "Layer id out of range: %" PRIu32, id);
+	CN_ASSERT(id != activeLayer, "Cannot destroy layer %" PRIu32 " while drawing to it", id);
+	CnLayer* layer = &layers[id - 1];
+	CN_ASSERT(layer->framebuffer != 0, "Destroying layer %" PRIu32 " which doesn't exist", id);
+
+	glDeleteFramebuffers(1, &layer->framebuffer);
+	glDeleteTextures(1, &layer->texture);
+	memset(layer, 0, sizeof(CnLayer));
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+void cnRLL_MarkLayerDirty(CnLayerId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_LAYERS, "Layer id out of range: %" PRIu32, id);
+	layers[id - 1].dirty = true;
+}
+
+bool cnRLL_BeginLayer(CnLayerId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_LAYERS, "Layer id out of range: %" PRIu32, id);
+	CN_ASSERT(activeLayer == 0, "Cannot begin layer %" PRIu32 " while drawing to layer %" PRIu32,
+		id, activeLayer);
+	CnLayer* layer = &layers[id - 1];
+	CN_ASSERT(layer->framebuffer != 0, "Beginning layer %" PRIu32 " which doesn't exist", id);
+
+	if (!layer->dirty) {
+		return false;
+	}
+
+	cnRLL_FlushSpriteBatch();
+	glBindFramebuffer(GL_FRAMEBUFFER, layer->framebuffer);
+	glViewport(0, 0, windowWidth, windowHeight);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	layer->dirty = false;
+	activeLayer = id;
+	CN_ASSERT_NO_GL_ERROR();
+	return true;
+}
+
+void cnRLL_EndLayer(void)
+{
+	CN_ASSERT(activeLayer != 0, "Ending a layer without beginning one");
+
+	cnRLL_FlushSpriteBatch();
+	activeLayer = 0;
+	glBindFramebuffer(GL_FRAMEBUFFER, cnRLL_SceneFramebuffer());
+	cnRLL_ApplyViewport(viewport);
+	CN_ASSERT_NO_GL_ERROR();
+}
 
+/**
+ * Composites a layer over everything drawn so far with a single quad over the
+ * backing canvas.
+ */
+void cnRLL_DrawLayer(CnLayerId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_LAYERS, "Layer id out of range: %" PRIu32, id);
+	CN_ASSERT(id != activeLayer, "Cannot draw layer %" PRIu32 " into itself", id);
+	const CnLayer* layer = &layers[id - 1];
+	CN_ASSERT(layer->framebuffer != 0, "Drawing layer %" PRIu32 " which doesn't exist", id);
+
+	cnRLL_ReadyTexture2(0, layer->texture);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexLayer, &vertexFormats[CnVertexFormatP2],
+		fullScreenQuadBuffer);
+
+	// Layers start transparent, so only what was drawn to them covers what is
+	// underneath.
+	cnRLL_ApplyViewport(cnRLL_BackingCanvasArea());
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	glDisable(GL_BLEND);
+	cnRLL_ApplyViewport(viewport);
+
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+bool cnRLL_CreateTilemap(CnTilemapId* id, CnDimension2u32 size, CnSpriteId tileset, CnDimension2u32 tilesetGrid)
+{
+	CN_ASSERT_PTR(id);
+	CN_ASSERT(tileset < MaxSpriteId, "Sprite id out of range: %" PRIu32, tileset);
+
+	if (spriteArraySlots[tileset] != 0) {
+		CN_WARN(LogSysRender, "Sprite %" PRIu32 " is in a sprite array, so can't be a tileset", tileset);
+		return false;
+	}
+
+	uint32_t slot = 0;
+	while (slot < RLL_MAX_TILEMAPS && tilemaps[slot].used) {
+		++slot;
+	}
+	if (slot == RLL_MAX_TILEMAPS) {
+		CN_WARN(LogSysRender, "Unable to create a tilemap, all %d tilemaps are in use", RLL_MAX_TILEMAPS);
+		return false;
+	}
+
+	if (tilesetSampler == 0) {
+		glGenSamplers(1, &tilesetSampler);
+		glSamplerParameteri(tilesetSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glSamplerParameteri(tilesetSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glSamplerParameteri(tilesetSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glSamplerParameteri(tilesetSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glSamplerParameterf(tilesetSampler, GL_TEXTURE_MAX_LOD, 0.0f);
+		CN_ASSERT_NO_GL_ERROR();
+	}
+
+	CnTilemapDraw* t = &tilemaps[slot];
+	if (!cnTilemap_Allocate(&t->map, size)) {
+		CN_WARN(LogSysRender, "Tilemap is too large: %" PRIu32 "x%" PRIu32, size.width, size.height);
+		return false;
+	}
+
+	const uint32_t numChunks = t->map.numChunks.width * t->map.numChunks.height;
+	cnDynamicBuffer_Allocate(&t->chunkBufferStorage, numChunks * (uint32_t)sizeof(CnTilemapChunkBuffer));
+	t->chunkBuffers = (CnTilemapChunkBuffer*)t->chunkBufferStorage.contents;
+	memset(t->chunkBuffers, 0, t->chunkBufferStorage.size);
+	t->tileset = tileset;
+	t->tilesetGrid = tilesetGrid;
+	t->used = true;
+
+	// Loads finishing later, including asynchronous ones, must not move the
+	// tileset into an array.
+	spriteIsTileset[tileset] = true;
+
+	*id = slot + 1;
+	return true;
+}
+
+void cnRLL_DestroyTilemap(CnTilemapId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_TILEMAPS, "Tilemap id out of range: %" PRIu32, id);
+	CnTilemapDraw* t = &tilemaps[id - 1];
+	CN_ASSERT(t->used, "Destroying tilemap %" PRIu32 " which doesn't exist", id);
+
+	const uint32_t numChunks = t->map.numChunks.width * t->map.numChunks.height;
+	for (uint32_t i = 0; i < numChunks; ++i) {
+		if (t->chunkBuffers[i].buffer != 0) {
+			glDeleteVertexArrays(1, &t->chunkBuffers[i].vao);
+			glDeleteBuffers(1, &t->chunkBuffers[i].buffer);
+		}
+	}
+	cnDynamicBuffer_Free(&t->chunkBufferStorage);
+	cnTilemap_Free(&t->map);
+	memset(t, 0, sizeof(CnTilemapDraw));
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+void cnRLL_SetTile(CnTilemapId id, CnRowColu32 position, CnTile tile)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_TILEMAPS, "Tilemap id out of range: %" PRIu32, id);
+	CN_ASSERT(tilemaps[id - 1].used, "Tilemap %" PRIu32 " doesn't exist", id);
+	cnTilemap_Set(&tilemaps[id - 1].map, position, tile);
+}
+
+CnTile cnRLL_Tile(CnTilemapId id, CnRowColu32 position)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_TILEMAPS, "Tilemap id out of range: %" PRIu32, id);
+	CN_ASSERT(tilemaps[id - 1].used, "Tilemap %" PRIu32 " doesn't exist", id);
+	return cnTilemap_Get(&tilemaps[id - 1].map, position);
+}
+
+/**
+ * Rebuilds the vertex buffer of a chunk from its tiles.
+ */
+static void cnRLL_BuildTilemapChunk(CnTilemapDraw* t, CnRowColu32 chunk, CnTilemapChunkBuffer* chunkBuffer)
+{
+	chunkBuffer->numVertices = cnTilemap_BuildChunk(&t->map, chunk, t->tilesetGrid, tilemapVertices);
+
+	if (chunkBuffer->buffer == 0) {
+		glGenBuffers(1, &chunkBuffer->buffer);
+		glGenVertexArrays(1, &chunkBuffer->vao);
+		glBindVertexArray(chunkBuffer->vao);
+		glBindBuffer(GL_ARRAY_BUFFER, chunkBuffer->buffer);
+
+		const CnProgram* p = &programs[CnProgramIndexTilemap];
+		for (uint32_t i = 0; i < p->numAttributes; ++i) {
+			cnRLL_ApplyVertexAttribute(&vertexFormats[CnVertexFormatTilemap], p->attributes[i].semanticName,
+				p->attributes[i].location);
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, chunkBuffer->buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(CnTilemapVertex) * chunkBuffer->numVertices, tilemapVertices,
+		GL_STATIC_DRAW);
+	CN_ASSERT_NO_GL_ERROR();
+}
 
-	cnRLL_DisableProgram(CnProgramIndexFullScreen);
+/**
+ * Draws the chunks of a tilemap which the camera can see, rebuilding those
+ * which have changed.
+ */
+void cnRLL_DrawTilemap(CnTilemapId id, CnFloat2 origin, CnDimension2f tileSize)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_TILEMAPS, "Tilemap id out of range: %" PRIu32, id);
+	CnTilemapDraw* t = &tilemaps[id - 1];
+	CN_ASSERT(t->used, "Drawing tilemap %" PRIu32 " which doesn't exist", id);
+	CN_ASSERT(spriteArraySlots[t->tileset] == 0, "Tileset %" PRIu32 " must not be in a sprite array",
+		t->tileset);
+
+	CnRowColu32 first, last;
+	if (!cnTilemap_VisibleChunks(&t->map, origin, tileSize, cameraAABB2, &first, &last)) {
+		return;
+	}
+
+	cnRLL_MakeSpriteResident(t->tileset);
+	cnRLL_ReadyTexture2(0, spriteTextures[t->tileset]);
+
+	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
+	uniformStorage[CnUniformNameTileSize].f2 = cnFloat2_Make(tileSize.width, tileSize.height);
+	CnProgram* p = cnRLL_UseProgram(CnProgramIndexTilemap);
+
+	// Bound after using the program, since that may draw batched sprites.
+	glBindSampler(0, tilesetSampler);
+
+	for (uint32_t row = first.row; row <= last.row; ++row) {
+		for (uint32_t col = first.col; col <= last.col; ++col) {
+			const CnRowColu32 chunkPosition = { row, col };
+			const CnTilemapChunk* chunk = cnTilemap_Chunk(&t->map, chunkPosition);
+			CnTilemapChunkBuffer* chunkBuffer = &t->chunkBuffers[row * t->map.numChunks.width + col];
+			if (chunk->numTiles == 0) {
+				continue;
+			}
+			if (chunk->dirty || chunkBuffer->buffer == 0) {
+				cnRLL_BuildTilemapChunk(t, chunkPosition, chunkBuffer);
+			}
 
+			uniformStorage[CnUniformNameBatchOrigin].f2 = cnFloat2_Make(
+				origin.x + (float)(col * CN_TILEMAP_CHUNK_SIZE) * tileSize.width,
+				origin.y + (float)(row * CN_TILEMAP_CHUNK_SIZE) * tileSize.height);
+			cnRLL_ApplyProgramUniform(p, CnUniformNameBatchOrigin);
+			glBindVertexArray(chunkBuffer->vao);
+			glDrawArrays(GL_TRIANGLES, 0, (GLsizei)chunkBuffer->numVertices);
+		}
+	}
+	glBindSampler(0, 0);
 	CN_ASSERT_NO_GL_ERROR();
 }
 
@@ -1274,7 +3213,7 @@ void cnRLL_DrawDebugRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColo
 	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
 	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2], debugDrawBuffer);
 
 	CnFloat2 vertices[4];
 	vertices[0] = cnFloat2_Make(-dimensions.width / 2.0f, -dimensions.height / 2.0f);
@@ -1290,8 +3229,6 @@ void cnRLL_DrawDebugRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColo
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
 	CN_ASSERT_NO_GL_ERROR();
 }
 
@@ -1302,7 +3239,7 @@ void cnRLL_DrawDebugLine(float x1, float y1, float x2, float y2, CnOpaqueColor c
 	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
 	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2], debugDrawBuffer);
 
 	CnFloat2 vertices[2];
 	vertices[0] = cnFloat2_Make(x1, y1);
@@ -1311,7 +3248,6 @@ void cnRLL_DrawDebugLine(float x1, float y1, float x2, float y2, CnOpaqueColor c
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
 	glDrawArrays(GL_LINES, 0, 2);
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
 	CN_ASSERT_NO_GL_ERROR();
 }
 
@@ -1325,37 +3261,110 @@ void cnRLL_DrawDebugLineStrip(CnFloat2* points, uint32_t numPoints, CnOpaqueColo
 	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
 	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2], debugDrawBuffer);
 
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CnFloat2) * numPoints, points);
 	glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)numPoints);
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+static GLenum cnRLL_MeshPrimitiveMode(CnMeshPrimitive primitive)
+{
+	switch (primitive) {
+		case CnMeshPrimitiveLines: return GL_LINES;
+		case CnMeshPrimitiveLineStrip: return GL_LINE_STRIP;
+		case CnMeshPrimitiveLineLoop: return GL_LINE_LOOP;
+		case CnMeshPrimitiveTriangles: return GL_TRIANGLES;
+		case CnMeshPrimitiveTriangleStrip: return GL_TRIANGLE_STRIP;
+		default:
+			CN_FATAL_ERROR("Unknown mesh primitive: %i", (int)primitive);
+	}
+}
+
+bool cnRLL_CreateMesh(CnMeshId* id, const CnFloat2* vertices, uint32_t numVertices, CnMeshPrimitive primitive)
+{
+	CN_ASSERT_PTR(id);
+	CN_ASSERT_PTR(vertices);
+	CN_ASSERT(numVertices > 0, "Cannot create a mesh without vertices");
+
+	uint32_t slot = 0;
+	while (slot < RLL_MAX_MESHES && meshes[slot].buffer != 0) {
+		++slot;
+	}
+	if (slot == RLL_MAX_MESHES) {
+		CN_WARN(LogSysRender, "Unable to create a mesh, all %d meshes are in use", RLL_MAX_MESHES);
+		return false;
+	}
+
+	CnMesh* mesh = &meshes[slot];
+	mesh->mode = cnRLL_MeshPrimitiveMode(primitive);
+	mesh->numVertices = numVertices;
+	glGenBuffers(1, &mesh->buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(CnFloat2) * numVertices, vertices, GL_STATIC_DRAW);
+
+	const CnProgram* p = &programs[CnProgramIndexSolidPolygon];
+	glGenVertexArrays(1, &mesh->vao);
+	glBindVertexArray(mesh->vao);
+	for (uint32_t i = 0; i < p->numAttributes; ++i) {
+		cnRLL_ApplyVertexAttribute(&vertexFormats[CnVertexFormatP2], p->attributes[i].semanticName,
+			p->attributes[i].location);
+	}
+	CN_ASSERT_NO_GL_ERROR();
+
+	*id = slot + 1;
+	return true;
+}
+
+void cnRLL_DrawMesh(CnMeshId id, CnFloat4x4 transform, CnOpaqueColor color)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_MESHES, "Mesh id out of range: %" PRIu32, id);
+	const CnMesh* mesh = &meshes[id - 1];
+	CN_ASSERT(mesh->buffer != 0, "Drawing mesh %" PRIu32 " which doesn't exist", id);
+
+	uniformStorage[CnUniformNameViewModel].f44 = transform;
+	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
+	cnRLL_UseProgram(CnProgramIndexSolidPolygon);
+	glBindVertexArray(mesh->vao);
+	glDrawArrays(mesh->mode, 0, (GLsizei)mesh->numVertices);
+
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+void cnRLL_DestroyMesh(CnMeshId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_MESHES, "Mesh id out of range: %" PRIu32, id);
+	CnMesh* mesh = &meshes[id - 1];
+	CN_ASSERT(mesh->buffer != 0, "Destroying mesh %" PRIu32 " which doesn't exist", id);
 
+	glDeleteVertexArrays(1, &mesh->vao);
+	glDeleteBuffers(1, &mesh->buffer);
+	memset(mesh, 0, sizeof(CnMesh));
 	CN_ASSERT_NO_GL_ERROR();
 }
 
 void cnRLL_DrawDebugFont(CnFontId id, CnFloat2 center, CnDimension2f size)
 {
+	cnRLL_MakeFontResident(id);
 	CN_ASSERT_NO_GL_ERROR();
 
 	const GLuint texture = fontTextures[id];
-	CN_ASSERT(glIsTexture(texture), "Font %" PRIu32 " does not have a valid"
+	RLL_DEBUG_ASSERT(glIsTexture(texture), "Font %" PRIu32 " does not have a valid"
 		"texture", id);
 	cnRLL_ReadyTexture2(0, texture);
 
-	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Multiply(
+	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Multiply(
 		cnFloat4x4_NonUniformScale(size.width, size.height, 1.0f),
-		cnFloat4x4_Translate(center.x, center.y, 0.0f));;
+		cnFloat4x4_Translate(center.x, center.y, 0.0f));
 
 	glBindBuffer(GL_ARRAY_BUFFER, spriteBuffer);
 	CN_ASSERT_NO_GL_ERROR();
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &vertexFormats[CnVertexFormatP2T2Interleaved]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &vertexFormats[CnVertexFormatP2T2Interleaved],
+		spriteBuffer);
 
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-	cnRLL_DisableProgram(CnProgramIndexSprite);
-
 	CN_ASSERT_NO_GL_ERROR();
 }
 
@@ -1368,7 +3377,7 @@ void cnRLL_DrawRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor col
 	uniformStorage[CnUniformNameViewModel].f44 = transform;
 	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2], debugDrawBuffer);
 
 	CnFloat2 vertices[4];
 	vertices[0] = cnFloat2_Make(-dimensions.width / 2.0f, -dimensions.height / 2.0f);
@@ -1384,8 +3393,6 @@ void cnRLL_DrawRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor col
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
 	CN_ASSERT_NO_GL_ERROR();
 }
 
@@ -1398,7 +3405,7 @@ void cnRLL_OutlineRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor
 	uniformStorage[CnUniformNameViewModel].f44 = transform;
 	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2], debugDrawBuffer);
 
 	CnFloat2 vertices[4];
 	vertices[0] = cnFloat2_Make(-dimensions.width / 2.0f, -dimensions.height / 2.0f);
@@ -1414,8 +3421,6 @@ void cnRLL_OutlineRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
 	glDrawArrays(GL_LINE_LOOP, 0, 4);
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
 	CN_ASSERT_NO_GL_ERROR();
 }
 
@@ -1450,14 +3455,12 @@ void cnRLL_OutlineCircle(CnFloat2 center, float radius, CnOpaqueColor color, uin
 	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Translate(center.x, center.y, 0.0f);
 	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2], debugDrawBuffer);
 
 	cnRLL_CreateCircle(&points[0], numPoints, radius);
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CnFloat2) * numPoints, points);
 	glDrawArrays(GL_LINE_LOOP, 0, (GLsizei)numPoints);
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
 	CN_ASSERT_NO_GL_ERROR();
 }
 
@@ -1474,7 +3477,7 @@ void cnRLL_FillScreen(CnOpaqueColor color)
 	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
 
 	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2], debugDrawBuffer);
 
 	const float width = cnAABB2_Width(cameraAABB2);
 	const float height = cnAABB2_Height(cameraAABB2);
@@ -1494,7 +3497,5 @@ void cnRLL_FillScreen(CnOpaqueColor color)
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
 	CN_ASSERT_NO_GL_ERROR();
 }
\ No newline at end of file
@@ -66,6 +66,12 @@ typedef struct {
 	 * first value of the attribute.
 	 */
 	size_t offset;
+
+	/**
+	 * The number of instances drawn before advancing to the next value, or 0
+	 * to advance every vertex.
+	 */
+	uint32_t divisor;
 } CnVertexFormatAttribute;
 
 /**
@@ -109,7 +115,8 @@ CN_STATIC_ASSERT(CN_RLL_MAX_ATTRIBUTES <= GL_MAX_VERTEX_ATTRIBS,
  * attributes used by a program prevent from having to query for it every time
  * that program is used.
  *
- * Normalized attributed are not currently supported.
+ * Shaders always see floats, integer vertex data is converted by the vertex
+ * format, normalized or not.
  */
 typedef struct {
 	/**
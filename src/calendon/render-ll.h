@@ -14,15 +14,25 @@
  */
 
 #include <calendon/color.h>
+#include <calendon/font-psf2.h>
 #include <calendon/handle.h>
+#include <calendon/image-cache.h>
 #include <calendon/math2.h>
 #include <calendon/math4.h>
 #include <calendon/render-resources.h>
+#include <calendon/residency.h>
+#include <calendon/tilemap.h>
 
 void cnRLL_Init(CnDimension2u32 resolution);
 void cnRLL_Shutdown(void);
 void cnRLL_StartFrame(void);
 void cnRLL_EndFrame(void);
+
+void cnRLL_AcquireContext(void);
+void cnRLL_ReleaseContext(void);
+
+void cnRLL_SetTextureBudget(uint64_t bytes);
+void cnRLL_TextureStats(CnResidencyStats* stats);
 void cnRLL_Clear(CnRGBA8u color);
 
 CnDimension2u32 cnRLL_Resolution(void);
@@ -35,15 +45,31 @@ void cnRLL_SetViewport(CnAABB2 viewport);
 CnAABB2 cnRLL_CameraAABB2(void);
 void cnRLL_SetCameraAABB2(const CnAABB2 mapSlice);
 
+void  cnRLL_SetDynamicResolution(uint64_t budgetMicros, float minScale);
+float cnRLL_RenderScale(void);
+
+CnPresentMode cnRLL_SetPresentMode(CnPresentMode mode);
+void          cnRLL_SetMaxFramesInFlight(uint32_t frames);
+void          cnRLL_FrameStats(CnFrameStats* stats);
+
+bool cnRLL_StartCapture(const char* directory, CnCaptureFormat format);
+void cnRLL_StopCapture(void);
+void cnRLL_CaptureStats(CnCaptureStats* stats);
+
 CN_DEFINE_HANDLE_TYPE(CnSpriteId, cnRLL_, Sprite);
 CN_DEFINE_HANDLE_TYPE(CnFontId, cnRLL_, Font);
 
 CnFloat4x4 cnRLL_MatrixFromTransform(CnTransform2 transform);
 
 bool cnRLL_LoadSprite(CnSpriteId id, const char* path);
+void cnRLL_ReserveSprite(CnSpriteId id);
+void cnRLL_SetSpriteArrays(bool enabled);
+bool cnRLL_UploadSprite(CnSpriteId id, const CnCachedImage* image, const char* path);
 void cnRLL_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size);
 
 bool cnRLL_LoadPSF2Font(CnFontId id, const char* path);
+bool cnRLL_UploadPSF2Font(CnFontId id, CnFontPSF2* loaded);
+bool cnRLL_IsFontReady(CnFontId id);
 void cnRLL_DrawSimpleText(CnFontId id, CnTextDrawParams* params, const char* text);
 void cnRLL_DrawDebugFont(CnFontId id, CnFloat2 center, CnDimension2f size);
 
@@ -52,6 +78,25 @@ void cnRLL_DrawDebugRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColo
 void cnRLL_DrawDebugLine(float x1, float y1, float x2, float y2, CnOpaqueColor color);
 void cnRLL_DrawDebugLineStrip(CnFloat2* points, uint32_t numPoints, CnOpaqueColor color);
 
+bool cnRLL_CreateMesh(CnMeshId* id, const CnFloat2* vertices, uint32_t numVertices, CnMeshPrimitive primitive);
+void cnRLL_DrawMesh(CnMeshId id, CnFloat4x4 transform, CnOpaqueColor color);
+void cnRLL_DestroyMesh(CnMeshId id);
+
+#define RLL_MAX_LAYERS 8
+
+bool cnRLL_CreateLayer(CnLayerId* id);
+void cnRLL_DestroyLayer(CnLayerId id);
+void cnRLL_MarkLayerDirty(CnLayerId id);
+bool cnRLL_BeginLayer(CnLayerId id);
+void cnRLL_EndLayer(void);
+void cnRLL_DrawLayer(CnLayerId id);
+
+bool cnRLL_CreateTilemap(CnTilemapId* id, CnDimension2u32 size, CnSpriteId tileset, CnDimension2u32 tilesetGrid);
+void cnRLL_DestroyTilemap(CnTilemapId id);
+void cnRLL_SetTile(CnTilemapId id, CnRowColu32 position, CnTile tile);
+CnTile cnRLL_Tile(CnTilemapId id, CnRowColu32 position);
+void cnRLL_DrawTilemap(CnTilemapId id, CnFloat2 origin, CnDimension2f tileSize);
+
 void cnRLL_DrawRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnFloat4x4 transform);
 void cnRLL_OutlineRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnFloat4x4 transform);
 
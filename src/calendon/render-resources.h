@@ -18,6 +18,9 @@ extern "C" {
 
 #include <calendon/cn.h>
 
+#include <calendon/color.h>
+#include <calendon/math2.h>
+
 /**
  * Opaque handle used to coordinate with the renderer to uniquely identify
  * sprites.
@@ -29,6 +32,123 @@ typedef uint32_t CnSpriteId;
  */
 typedef uint32_t CnFontId;
 
+/**
+ * Handle for geometry kept by the renderer.  Zero is never a valid mesh.
+ */
+typedef uint32_t CnMeshId;
+
+/**
+ * How the vertices of a mesh are joined.
+ */
+typedef enum {
+	CnMeshPrimitiveLines,
+	CnMeshPrimitiveLineStrip,
+	CnMeshPrimitiveLineLoop,
+	CnMeshPrimitiveTriangles,
+	CnMeshPrimitiveTriangleStrip
+} CnMeshPrimitive;
+
+/**
+ * Handle for an offscreen layer kept by the renderer.  Zero is never a valid
+ * layer.
+ */
+typedef uint32_t CnLayerId;
+
+/**
+ * Handle for a tilemap kept by the renderer.  Zero is never a valid tilemap.
+ */
+typedef uint32_t CnTilemapId;
+
+/**
+ * How finished frames are shown.
+ */
+typedef enum {
+	/** Wait for the display to refresh, which never tears. */
+	CnPresentModeVSync,
+
+	/**
+	 * Wait for the display to refresh unless the frame is already late, which
+	 * tears instead of waiting another refresh.  Falls back to vsync where it
+	 * isn't supported.
+	 */
+	CnPresentModeAdaptive,
+
+	/** Show frames as soon as they're done, which tears. */
+	CnPresentModeImmediate
+} CnPresentMode;
+
+/**
+ * Frames queued for the GPU and how long they took to finish.
+ */
+typedef struct {
+	/** Frames submitted but not yet finished by the GPU, before waiting. */
+	uint32_t framesInFlight;
+
+	/**
+	 * Time from starting the latest finished frame to the GPU finishing it,
+	 * both measured on the GL clock, so this doesn't include how long it took
+	 * to notice the frame had finished.
+	 */
+	uint64_t latencyMicros;
+
+	/** Time spent waiting for the GPU to allow starting this frame. */
+	uint64_t waitMicros;
+} CnFrameStats;
+
+/**
+ * How captured frames are written to disk.
+ */
+typedef enum {
+	/** Uncompressed RGBA in a PAM file, which costs the least CPU time. */
+	CnCaptureFormatRaw,
+
+	/** Lossless QOI files, several times smaller and still fast to encode. */
+	CnCaptureFormatQOI
+} CnCaptureFormat;
+
+/**
+ * The cost of capturing frames since capture started.
+ */
+typedef struct {
+	uint32_t framesWritten;
+
+	/** Frames skipped because the encoder had fallen behind. */
+	uint32_t framesDropped;
+	uint64_t bytesWritten;
+
+	/** Main thread time spent reading back frames. */
+	uint64_t lastReadbackMicros;
+	uint64_t averageReadbackMicros;
+
+	/** Worker thread time spent encoding and writing each frame. */
+	uint64_t averageEncodeMicros;
+} CnCaptureStats;
+
+/**
+ * Handle for an asynchronous resource load.  Zero is never a valid load.
+ */
+typedef uint32_t CnLoadId;
+
+typedef enum {
+	/** The load was never requested. */
+	CnLoadStatusNone,
+
+	/** Waiting to be read, decoded or uploaded.  Placeholders are drawn. */
+	CnLoadStatusPending,
+
+	/** The resource is available for drawing. */
+	CnLoadStatusReady,
+
+	/** The resource could not be loaded and is left with its placeholder. */
+	CnLoadStatusFailed
+} CnLoadStatus;
+
+/**
+ * Called on the main thread, during `cnR_StartFrame`, once an asynchronous load
+ * has finished.
+ */
+typedef void (*CnLoadCallbackFn)(CnLoadId load, CnLoadStatus status, void* userData);
+
 /**
  * The horizontal direction in which text glyphs are written.
  */
@@ -0,0 +1,83 @@
+#include "render-scale.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * Raising scale requires the predicted frame time at the next step to be
+ * within this fraction of the budget.
+ */
+#define CN_RENDER_SCALE_RAISE_HEADROOM 0.9f
+
+void cnRenderScale_Init(CnRenderScale* rs, uint64_t budgetMicros, float minScale)
+{
+	CN_ASSERT_PTR(rs);
+	CN_ASSERT(minScale > 0.0f && minScale <= 1.0f, "Minimum render scale out of range: %f", (double)minScale);
+
+	memset(rs, 0, sizeof(CnRenderScale));
+	rs->budgetMicros = budgetMicros;
+	rs->steps = CN_RENDER_SCALE_STEPS;
+	rs->minSteps = (uint32_t)ceilf(minScale * CN_RENDER_SCALE_STEPS);
+	rs->minSteps = rs->minSteps < 1 ? 1 : rs->minSteps;
+}
+
+/**
+ * Records the time of a frame drawn at the current scale, and adjusts the
+ * scale once enough frames have been seen.
+ *
+ * @return true if the scale changed
+ */
+bool cnRenderScale_AddFrame(CnRenderScale* rs, uint64_t frameMicros)
+{
+	CN_ASSERT_PTR(rs);
+
+	if (rs->budgetMicros == CN_RENDER_SCALE_NO_BUDGET) {
+		return false;
+	}
+
+	rs->frameMicros[rs->nextFrame] = frameMicros;
+	rs->nextFrame = (rs->nextFrame + 1) % CN_RENDER_SCALE_FRAMES;
+	if (rs->numFrames < CN_RENDER_SCALE_FRAMES) {
+		++rs->numFrames;
+	}
+	if (rs->numFrames < CN_RENDER_SCALE_FRAMES) {
+		return false;
+	}
+
+	uint64_t totalMicros = 0;
+	for (uint32_t i = 0; i < CN_RENDER_SCALE_FRAMES; ++i) {
+		totalMicros += rs->frameMicros[i];
+	}
+	const float average = (float)totalMicros / CN_RENDER_SCALE_FRAMES;
+	const float budget = (float)rs->budgetMicros;
+
+	uint32_t steps = rs->steps;
+	if (average > budget) {
+		// Pixels drawn go with the square of the scale.
+		steps = (uint32_t)floorf((float)rs->steps * sqrtf(budget / average));
+		steps = steps >= rs->steps ? rs->steps - 1 : steps;
+		steps = steps < rs->minSteps ? rs->minSteps : steps;
+	}
+	else if (rs->steps < CN_RENDER_SCALE_STEPS) {
+		const float growth = (float)(rs->steps + 1) / (float)rs->steps;
+		if (average * growth * growth < budget * CN_RENDER_SCALE_RAISE_HEADROOM) {
+			steps = rs->steps + 1;
+		}
+	}
+
+	if (steps == rs->steps) {
+		return false;
+	}
+
+	// Frames at the old scale say nothing about the new one.
+	rs->steps = steps;
+	rs->numFrames = 0;
+	rs->nextFrame = 0;
+	return true;
+}
+
+float cnRenderScale_Scale(const CnRenderScale* rs)
+{
+	CN_ASSERT_PTR(rs);
+	return (float)rs->steps / CN_RENDER_SCALE_STEPS;
+}
@@ -0,0 +1,58 @@
+#ifndef CN_RENDER_SCALE_H
+#define CN_RENDER_SCALE_H
+
+/**
+ * @file render-scale.h
+ *
+ * Picks the fraction of the backing canvas resolution to draw at, so the time
+ * the GPU spends on each frame stays within a budget.
+ *
+ * Scales are kept in steps of 1/20 and changes are made from the average
+ * frame time of the last several frames.  Dropping scale is done in one jump,
+ * assuming frame time is proportional to pixels drawn.  Raising scale is done
+ * one step at a time and only when the predicted frame time at the next step
+ * still has headroom, so the scale settles rather than bouncing between steps.
+ *
+ * This only picks the scale, the renderer measures frames and draws at the
+ * scale picked.
+ */
+
+#include <calendon/cn.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CN_RENDER_SCALE_STEPS 20
+#define CN_RENDER_SCALE_FRAMES 8
+
+/**
+ * A budget of zero leaves drawing at full resolution.
+ */
+#define CN_RENDER_SCALE_NO_BUDGET 0
+
+/**
+ * Below half resolution, most games are hard to make out.
+ */
+#define CN_RENDER_SCALE_DEFAULT_MIN 0.5f
+
+typedef struct {
+	uint64_t budgetMicros;
+	uint32_t steps;
+	uint32_t minSteps;
+
+	/** Frame times since the scale last changed, the oldest are overwritten. */
+	uint64_t frameMicros[CN_RENDER_SCALE_FRAMES];
+	uint32_t numFrames;
+	uint32_t nextFrame;
+} CnRenderScale;
+
+CN_TEST_API void  cnRenderScale_Init(CnRenderScale* rs, uint64_t budgetMicros, float minScale);
+CN_TEST_API bool  cnRenderScale_AddFrame(CnRenderScale* rs, uint64_t frameMicros);
+CN_TEST_API float cnRenderScale_Scale(const CnRenderScale* rs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_RENDER_SCALE_H */
@@ -0,0 +1,215 @@
+#include "render-thread.h"
+
+#include <calendon/compat-sdl.h>
+#include <calendon/log.h>
+#include <calendon/render-ll.h>
+
+extern uint32_t LogSysRender;
+
+/**
+ * The main thread records into `recording`, while the render thread replays
+ * `submitted`, which is NULL once it has been replayed.  `submitted` and
+ * `renderQuit` are guarded by `renderLock`.
+ */
+static CnRCommandList lists[2];
+static CnRCommandList* recording;
+static CnRCommandList* submitted;
+
+static SDL_mutex* renderLock;
+static SDL_cond* listSubmitted;
+static SDL_cond* listReplayed;
+static SDL_Thread* renderThread;
+static SDL_threadID renderThreadId;
+static bool renderQuit;
+static uint32_t latency;
+
+/**
+ * Time the main thread spent waiting for the render thread, only touched on
+ * the main thread.
+ */
+static uint64_t waitTicks;
+static uint64_t numFrames;
+
+static int cnRThread_Run(void* data)
+{
+	CN_UNUSED(data);
+	cnRLL_AcquireContext();
+
+	SDL_LockMutex(renderLock);
+	for (;;) {
+		while (!submitted && !renderQuit) {
+			SDL_CondWait(listSubmitted, renderLock);
+		}
+		if (!submitted) {
+			break;
+		}
+		CnRCommandList* list = submitted;
+		SDL_UnlockMutex(renderLock);
+
+		cnRCommandList_Replay(list);
+		cnRCommandList_Clear(list);
+
+		SDL_LockMutex(renderLock);
+		submitted = NULL;
+		SDL_CondBroadcast(listReplayed);
+	}
+	SDL_UnlockMutex(renderLock);
+
+	cnRLL_ReleaseContext();
+	return 0;
+}
+
+/**
+ * Hands the recorded list to the render thread, after it finishes the list
+ * handed to it before, and starts recording into that one.
+ *
+ * @param wait also wait for the render thread to replay the recorded list
+ */
+static void cnRThread_Submit(bool wait)
+{
+	const uint64_t start = SDL_GetPerformanceCounter();
+
+	SDL_LockMutex(renderLock);
+	while (submitted) {
+		SDL_CondWait(listReplayed, renderLock);
+	}
+	submitted = recording;
+	SDL_CondSignal(listSubmitted);
+	while (wait && submitted) {
+		SDL_CondWait(listReplayed, renderLock);
+	}
+	SDL_UnlockMutex(renderLock);
+
+	recording = recording == &lists[0] ? &lists[1] : &lists[0];
+	waitTicks += SDL_GetPerformanceCounter() - start;
+}
+
+/**
+ * Moves GL submission to a new thread, which takes over the GL context.  Must
+ * be called on the main thread, outside of a frame.
+ *
+ * @param latencyFrames 1 to let the main thread record the next frame while
+ * the last is submitted, or 0 to wait for each frame to be submitted at the
+ * end of the frame, which only moves driver time off the main thread
+ */
+bool cnRThread_Start(uint32_t latencyFrames)
+{
+	CN_ASSERT(!renderThread, "Render thread is already running");
+	CN_ASSERT(latencyFrames <= CN_RENDER_THREAD_MAX_LATENCY, "Render thread latency out of range: %" PRIu32,
+		latencyFrames);
+
+	renderLock = SDL_CreateMutex();
+	listSubmitted = SDL_CreateCond();
+	listReplayed = SDL_CreateCond();
+	if (!renderLock || !listSubmitted || !listReplayed) {
+		CN_WARN(LogSysRender, "Unable to create render thread synchronization: %s", SDL_GetError());
+		cnRThread_Stop();
+		return false;
+	}
+
+	cnRCommandList_Init(&lists[0]);
+	cnRCommandList_Init(&lists[1]);
+	recording = &lists[0];
+	submitted = NULL;
+	renderQuit = false;
+	latency = latencyFrames;
+	waitTicks = 0;
+	numFrames = 0;
+
+	// A context can only be current on one thread at a time.
+	cnRLL_ReleaseContext();
+	renderThread = SDL_CreateThread(cnRThread_Run, "cn-render", NULL);
+	if (!renderThread) {
+		CN_WARN(LogSysRender, "Unable to create render thread: %s", SDL_GetError());
+		cnRLL_AcquireContext();
+		cnRThread_Stop();
+		return false;
+	}
+	renderThreadId = SDL_GetThreadID(renderThread);
+
+	CN_TRACE(LogSysRender, "Render thread started with %" PRIu32 " frame latency", latencyFrames);
+	return true;
+}
+
+/**
+ * Submits anything recorded, then returns GL submission to the main thread.
+ */
+void cnRThread_Stop(void)
+{
+	if (renderThread) {
+		cnRThread_Submit(true);
+
+		SDL_LockMutex(renderLock);
+		renderQuit = true;
+		SDL_CondSignal(listSubmitted);
+		SDL_UnlockMutex(renderLock);
+
+		SDL_WaitThread(renderThread, NULL);
+		renderThread = NULL;
+		cnRLL_AcquireContext();
+
+		if (numFrames > 0) {
+			const uint64_t waitMicros = waitTicks * 1000000 / SDL_GetPerformanceFrequency();
+			CN_TRACE(LogSysRender, "Render thread stopped, main thread waited %" PRIu64 " us per frame",
+				waitMicros / numFrames);
+		}
+	}
+
+	cnRCommandList_Free(&lists[0]);
+	cnRCommandList_Free(&lists[1]);
+	recording = NULL;
+
+	SDL_DestroyCond(listReplayed);
+	SDL_DestroyCond(listSubmitted);
+	SDL_DestroyMutex(renderLock);
+	listReplayed = NULL;
+	listSubmitted = NULL;
+	renderLock = NULL;
+}
+
+bool cnRThread_IsRunning(void)
+{
+	return renderThread != NULL;
+}
+
+/**
+ * The list to record render calls into, or NULL if they should be made
+ * directly, which is when the render thread isn't running or when called on
+ * the render thread itself.
+ */
+CnRCommandList* cnRThread_Recording(void)
+{
+	if (!renderThread || SDL_ThreadID() == renderThreadId) {
+		return NULL;
+	}
+	return recording;
+}
+
+/**
+ * Hands the frame to the render thread.  With a latency of one frame this only
+ * waits for the previous frame to finish being submitted.
+ */
+void cnRThread_EndFrame(void)
+{
+	CN_ASSERT(renderThread, "Render thread is not running");
+	cnRCommands_EndFrame(recording);
+	cnRThread_Submit(latency == 0);
+	++numFrames;
+}
+
+/**
+ * Runs a function on the render thread after everything recorded so far, and
+ * waits for it to finish.  Runs the function directly if the render thread
+ * isn't running.
+ */
+void cnRThread_Call(CnRInvokeFn fn, void* data)
+{
+	CN_ASSERT_PTR(fn);
+	CnRCommandList* list = cnRThread_Recording();
+	if (!list) {
+		fn(data);
+		return;
+	}
+	cnRCommands_Invoke(list, fn, data);
+	cnRThread_Submit(true);
+}
@@ -0,0 +1,43 @@
+#ifndef CN_RENDER_THREAD_H
+#define CN_RENDER_THREAD_H
+
+/**
+ * @file render-thread.h
+ *
+ * An optional thread which owns the GL context and does all GL submission.
+ *
+ * While it runs, render calls on the main thread are recorded into one of two
+ * command lists.  `cnR_EndFrame` hands the recorded list to the render thread
+ * and starts recording into the other, so the main thread simulates the next
+ * frame while the render thread submits the last one.
+ *
+ * Calls which need a result from the renderer, such as creating resources,
+ * are run on the render thread while the main thread waits, after everything
+ * recorded before them.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/render-commands.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The most frames the main thread can get ahead of the render thread.
+ */
+#define CN_RENDER_THREAD_MAX_LATENCY 1
+
+bool            cnRThread_Start(uint32_t latencyFrames);
+void            cnRThread_Stop(void);
+bool            cnRThread_IsRunning(void);
+CnRCommandList* cnRThread_Recording(void);
+void            cnRThread_EndFrame(void);
+void            cnRThread_Call(CnRInvokeFn fn, void* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_RENDER_THREAD_H */
@@ -1,6 +1,102 @@
 #include "render.h"
 
+#include "render-async.h"
 #include "render-ll.h"
+#include "render-thread.h"
+
+#include <calendon/compat-sdl.h>
+
+#include <math.h>
+#include <string.h>
+
+static CnCullStats cullStats;
+static CnCullStats lastFrameCullStats;
+
+/**
+ * The camera, viewport and layer dirtiness as last set by the main thread,
+ * which is ahead of the renderer while the render thread is running.
+ */
+static CnAABB2 camera;
+static CnAABB2 viewport;
+static bool layerDirty[RLL_MAX_LAYERS];
+
+/**
+ * Frame stats and render scale as of the last frame the renderer started,
+ * written by the render thread while it is running so reading them doesn't
+ * wait for it.  Guarded by `frameSnapshotLock`.
+ */
+static CnFrameStats frameStatsSnapshot;
+static float renderScaleSnapshot;
+static SDL_SpinLock frameSnapshotLock;
+
+/**
+ * Arguments and results of calls run on the render thread.
+ */
+typedef struct {
+	uint32_t* newId;
+	uint32_t id;
+	const char* path;
+	bool result;
+} CnRResourceCall;
+
+typedef struct {
+	CnMeshId* id;
+	const CnFloat2* vertices;
+	uint32_t numVertices;
+	CnMeshPrimitive primitive;
+	bool result;
+} CnRMeshCall;
+
+typedef struct {
+	CnTilemapId* id;
+	CnDimension2u32 size;
+	CnSpriteId tileset;
+	CnDimension2u32 tilesetGrid;
+	bool result;
+} CnRTilemapCall;
+
+typedef struct {
+	CnTilemapId id;
+	CnRowColu32 position;
+	CnTile tile;
+} CnRTileCall;
+
+typedef struct {
+	const char* directory;
+	CnCaptureFormat format;
+	bool result;
+} CnRCaptureCall;
+
+typedef struct {
+	CnPresentMode mode;
+	CnPresentMode result;
+} CnRPresentModeCall;
+
+static void cnR_SnapshotFrame(void* unused)
+{
+	CN_UNUSED(unused);
+	CnFrameStats stats;
+	cnRLL_FrameStats(&stats);
+	const float scale = cnRLL_RenderScale();
+
+	SDL_AtomicLock(&frameSnapshotLock);
+	frameStatsSnapshot = stats;
+	renderScaleSnapshot = scale;
+	SDL_AtomicUnlock(&frameSnapshotLock);
+}
+
+/**
+ * Tests bounds against the camera, counting those which are culled.
+ */
+static bool cnR_IsVisible(CnAABB2 bounds)
+{
+	++cullStats.tested;
+	if (cnCull_IsVisible(camera, bounds)) {
+		return true;
+	}
+	++cullStats.culled;
+	return false;
+}
 
 /**
  * Initialize the rendering system assuming a rectangular region of the given
@@ -9,13 +105,45 @@
 void cnR_Init(CnDimension2u32 resolution)
 {
 	cnRLL_Init(resolution);
+	cnRAsync_Init();
+	camera = cnRLL_CameraAABB2();
+	viewport = cnRLL_Viewport();
 }
 
 void cnR_Shutdown(void)
 {
+	cnRThread_Stop();
+	cnRAsync_Shutdown();
 	cnRLL_Shutdown();
 }
 
+/**
+ * Moves all GL submission to a render thread, so driver time doesn't take from
+ * the main thread.  Draws are recorded and submitted by the render thread
+ * after `cnR_EndFrame`, while the main thread goes on to the next frame.
+ * Calls which return results, such as creating resources or reading tiles,
+ * wait for the render thread to catch up.  Must be called outside of a frame.
+ *
+ * @param latencyFrames 1 to draw the next frame while the last is submitted,
+ * or 0 for `cnR_EndFrame` to wait until the frame has been submitted
+ */
+bool cnR_StartRenderThread(uint32_t latencyFrames)
+{
+	CN_ASSERT(latencyFrames <= CN_RENDER_THREAD_MAX_LATENCY, "Render thread latency out of range: %" PRIu32,
+		latencyFrames);
+	cnR_SnapshotFrame(NULL);
+	return cnRThread_Start(latencyFrames);
+}
+
+/**
+ * Submits any frame still being drawn by the render thread, then goes back to
+ * submitting from the main thread.
+ */
+void cnR_StopRenderThread(void)
+{
+	cnRThread_Stop();
+}
+
 /**
  * To be called once per main loop to reset the state required to draw the next
  * frame.  Error conditions should be restored and any pending values should be
@@ -26,20 +154,48 @@ void cnR_Shutdown(void)
  */
 void cnR_StartFrame(void)
 {
-	cnRLL_StartFrame();
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_StartFrame(commands);
+		cnRCommands_Invoke(commands, cnR_SnapshotFrame, NULL);
+	}
+	else {
+		cnRLL_StartFrame();
+	}
 
-	cnRLL_SetViewport(cnR_BackingCanvasAABB2());
+	lastFrameCullStats = cullStats;
+	memset(&cullStats, 0, sizeof(CnCullStats));
 
+	// Uploads are done before drawing, so resources finishing loading are
+	// drawn this frame.  They're submitted together, waiting once for the
+	// render thread if it is running.
+	cnRAsync_DrainUploads();
+
+	viewport = cnR_BackingCanvasAABB2();
 	const CnRGBA8u black = { 0, 0, 0, 0 };
-	cnRLL_Clear(black);
+	commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetViewport(commands, viewport);
+		cnRCommands_Clear(commands, black);
+	}
+	else {
+		cnRLL_SetViewport(viewport);
+		cnRLL_Clear(black);
+	}
 }
 
 /**
- * The frame is now done and should be submitted for drawing.
+ * The frame is now done and should be submitted for drawing.  With the render
+ * thread running, the frame is handed to it instead.
  */
 void cnR_EndFrame(void)
 {
-	cnRLL_EndFrame();
+	if (cnRThread_IsRunning()) {
+		cnRThread_EndFrame();
+	}
+	else {
+		cnRLL_EndFrame();
+	}
 }
 
 CnDimension2u32 cnR_Resolution(void)
@@ -54,7 +210,7 @@ CnAABB2 cnR_BackingCanvasAABB2(void)
 
 CnAABB2 cnR_Viewport(void)
 {
-	return cnRLL_Viewport();
+	return viewport;
 }
 
 /**
@@ -67,11 +223,19 @@ CnAABB2 cnR_Viewport(void)
  *
  * @see cnR_BackingCanvasAABB2
  */
-void cnR_SetViewport(CnAABB2 viewport)
+void cnR_SetViewport(CnAABB2 newViewport)
 {
-	CN_ASSERT(cnAABB2_FullyContainsAABB2(cnR_BackingCanvasAABB2(), viewport, 0.0f),
+	CN_ASSERT(cnAABB2_FullyContainsAABB2(cnR_BackingCanvasAABB2(), newViewport, 0.0f),
 		"Viewport is not fully contained by the backing canvas.");
-	cnRLL_SetViewport(viewport);
+	viewport = newViewport;
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetViewport(commands, newViewport);
+	}
+	else {
+		cnRLL_SetViewport(newViewport);
+	}
 }
 
 /**
@@ -84,33 +248,347 @@ void cnR_SetViewport(CnAABB2 viewport)
  */
 void cnR_SetCameraAABB2(CnAABB2 area)
 {
-	cnRLL_SetCameraAABB2(area);
+	camera = area;
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetCameraAABB2(commands, area);
+	}
+	else {
+		cnRLL_SetCameraAABB2(area);
+	}
+}
+
+CnAABB2 cnR_CameraAABB2(void)
+{
+	return camera;
+}
+
+/**
+ * Lowers the resolution frames are drawn at when the GPU takes longer than a
+ * budget to draw them, and raises it again when there's time to spare.  Frames
+ * are upscaled to the window, so nothing drawn needs to change.
+ *
+ * @param budgetMicros GPU time per frame to stay within, or zero to always
+ * draw at full resolution
+ * @param minScale the lowest fraction of the resolution to draw at
+ */
+void cnR_SetDynamicResolution(uint64_t budgetMicros, float minScale)
+{
+	CN_ASSERT(minScale > 0.0f && minScale <= 1.0f, "Minimum render scale out of range: %f", (double)minScale);
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetDynamicResolution(commands, budgetMicros, minScale);
+	}
+	else {
+		cnRLL_SetDynamicResolution(budgetMicros, minScale);
+	}
+}
+
+/**
+ * The fraction of the backing canvas resolution the current frame is drawn at.
+ * While the render thread is running, this is the frame it last started.
+ */
+float cnR_RenderScale(void)
+{
+	if (!cnRThread_IsRunning()) {
+		return cnRLL_RenderScale();
+	}
+	SDL_AtomicLock(&frameSnapshotLock);
+	const float scale = renderScaleSnapshot;
+	SDL_AtomicUnlock(&frameSnapshotLock);
+	return scale;
+}
+
+static void cnR_SetPresentModeCall(void* data)
+{
+	CnRPresentModeCall* call = (CnRPresentModeCall*)data;
+	call->result = cnRLL_SetPresentMode(call->mode);
+}
+
+/**
+ * Sets how finished frames are shown, which defaults to vsync.  Modes which
+ * aren't supported fall back to vsync.
+ *
+ * @return the present mode in use
+ */
+CnPresentMode cnR_SetPresentMode(CnPresentMode mode)
+{
+	CnRPresentModeCall call = { .mode = mode };
+	cnRThread_Call(cnR_SetPresentModeCall, &call);
+	return call.result;
+}
+
+/**
+ * Limits how many frames can be queued for the GPU before `cnR_StartFrame`
+ * waits for the oldest to finish, which bounds the latency between reading
+ * input and displaying its effects.  Defaults to 2.
+ */
+void cnR_SetMaxFramesInFlight(uint32_t frames)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetMaxFramesInFlight(commands, frames);
+	}
+	else {
+		cnRLL_SetMaxFramesInFlight(frames);
+	}
+}
+
+/**
+ * Provides the frame queue depth and latency measured when the current frame
+ * was started.  Latency is measured to when the GPU finished a frame, which
+ * doesn't include the time to scan it out to the display.  While the render
+ * thread is running, these are from the frame it last started.
+ */
+void cnR_FrameStats(CnFrameStats* stats)
+{
+	CN_ASSERT_PTR(stats);
+	if (!cnRThread_IsRunning()) {
+		cnRLL_FrameStats(stats);
+		return;
+	}
+	SDL_AtomicLock(&frameSnapshotLock);
+	*stats = frameStatsSnapshot;
+	SDL_AtomicUnlock(&frameSnapshotLock);
+}
+
+static void cnR_StartCaptureCall(void* data)
+{
+	CnRCaptureCall* call = (CnRCaptureCall*)data;
+	call->result = cnRLL_StartCapture(call->directory, call->format);
+}
+
+/**
+ * Writes every following frame to numbered files in an existing directory,
+ * for reviewing runs afterwards.  Frames are read back from the GPU a few
+ * frames late and encoded on a worker thread, so drawing never waits on
+ * capture.  Frames are dropped if encoding falls behind.
+ */
+bool cnR_StartCapture(const char* directory, CnCaptureFormat format)
+{
+	CN_ASSERT(directory != NULL, "Cannot capture to a null directory.");
+	CnRCaptureCall call = { .directory = directory, .format = format };
+	cnRThread_Call(cnR_StartCaptureCall, &call);
+	return call.result;
+}
+
+static void cnR_StopCaptureCall(void* data)
+{
+	CN_UNUSED(data);
+	cnRLL_StopCapture();
+}
+
+/**
+ * Stops capturing, after writing frames already captured.
+ */
+void cnR_StopCapture(void)
+{
+	cnRThread_Call(cnR_StopCaptureCall, NULL);
+}
+
+static void cnR_ReadCaptureStats(void* stats)
+{
+	cnRLL_CaptureStats((CnCaptureStats*)stats);
+}
+
+/**
+ * Provides the frames written and dropped since capture started, and the time
+ * spent on them by the main thread and the encoding worker.
+ */
+void cnR_CaptureStats(CnCaptureStats* stats)
+{
+	CN_ASSERT_PTR(stats);
+	cnRThread_Call(cnR_ReadCaptureStats, stats);
+}
+
+/**
+ * Tests many bounds against the camera at once, such as those of every object
+ * in a world, so only the visible ones need to be drawn.  Sprites, rects and
+ * circles are already culled when drawn, so this is for skipping the work of
+ * preparing draws which wouldn't be seen.
+ *
+ * @param visible space for `numBounds` indices, filled with the indices of the
+ * visible bounds in order
+ * @return the number of visible bounds
+ */
+uint32_t cnR_CullAABB2s(const CnAABB2* bounds, uint32_t numBounds, uint32_t* visible)
+{
+	const uint32_t numVisible = cnCull_AABB2s(camera, bounds, numBounds, visible);
+	cullStats.tested += numBounds;
+	cullStats.culled += numBounds - numVisible;
+	return numVisible;
+}
+
+/**
+ * Provides how many draws and bounds were tested against the camera during the
+ * last finished frame, and how many of those were culled.
+ */
+void cnR_CullStats(CnCullStats* stats)
+{
+	CN_ASSERT_PTR(stats);
+	*stats = lastFrameCullStats;
+}
+
+static void cnR_CreateSpriteCall(void* data)
+{
+	CnRResourceCall* call = (CnRResourceCall*)data;
+	call->result = cnRLL_CreateSprite(call->newId);
 }
 
 bool cnR_CreateSprite(CnSpriteId* id)
 {
 	CN_ASSERT(id != NULL, "Cannot assign a sprite to a null pointer.");
-	return cnRLL_CreateSprite(id);
+	CnRResourceCall call = { .newId = id };
+	cnRThread_Call(cnR_CreateSpriteCall, &call);
+	return call.result;
+}
+
+static void cnR_LoadSpriteCall(void* data)
+{
+	CnRResourceCall* call = (CnRResourceCall*)data;
+	call->result = cnRLL_LoadSprite(call->id, call->path);
 }
 
 bool cnR_LoadSprite(CnSpriteId id, const char* path)
 {
-	return cnRLL_LoadSprite(id, path);
+	CnRResourceCall call = { .id = id, .path = path };
+	cnRThread_Call(cnR_LoadSpriteCall, &call);
+	return call.result;
 }
 
 void cnR_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size)
 {
-	cnRLL_DrawSprite(id, position, size);
+	const CnFloat2 corner = cnFloat2_Make(position.x + size.width, position.y + size.height);
+	const CnAABB2 bounds = cnAABB2_IncludePoint(cnAABB2_MakeMinMax(position, position), corner);
+	if (!cnR_IsVisible(bounds)) {
+		return;
+	}
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawSprite(commands, id, position, size);
+	}
+	else {
+		cnRLL_DrawSprite(id, position, size);
+	}
+}
+
+/**
+ * Places sprites loaded afterwards into texture arrays shared by sprites of the
+ * same size, such as the frames of an animation or the tiles of a tileset.
+ * Consecutive draws of sprites sharing an array are batched into one draw call.
+ * Sprites which don't fit in an array still get their own texture.
+ */
+void cnR_SetSpriteArrays(bool enabled)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetSpriteArrays(commands, enabled);
+	}
+	else {
+		cnRLL_SetSpriteArrays(enabled);
+	}
+}
+
+static void cnR_CreateFontCall(void* data)
+{
+	CnRResourceCall* call = (CnRResourceCall*)data;
+	call->result = cnRLL_CreateFont(call->newId);
 }
 
 bool cnR_CreateFont(CnFontId* id)
 {
-	return cnRLL_CreateFont(id);
+	CnRResourceCall call = { .newId = id };
+	cnRThread_Call(cnR_CreateFontCall, &call);
+	return call.result;
+}
+
+static void cnR_LoadPSF2FontCall(void* data)
+{
+	CnRResourceCall* call = (CnRResourceCall*)data;
+	call->result = cnRLL_LoadPSF2Font(call->id, call->path);
 }
 
 bool cnR_LoadPSF2Font(CnFontId id, const char* path)
 {
-	return cnRLL_LoadPSF2Font(id, path);
+	CnRResourceCall call = { .id = id, .path = path };
+	cnRThread_Call(cnR_LoadPSF2FontCall, &call);
+	return call.result;
+}
+
+/**
+ * Starts loading a sprite in the background.  The sprite can be drawn
+ * immediately, and shows a placeholder until loading finishes.
+ *
+ * @param onLoaded optional function to call when the sprite is ready or fails
+ * @return a handle to check progress, or 0 if the load couldn't be started
+ */
+CnLoadId cnR_LoadSpriteAsync(CnSpriteId id, const char* path, CnLoadCallbackFn onLoaded, void* userData)
+{
+	CN_ASSERT_PTR(path);
+	return cnRAsync_QueueSprite(id, path, onLoaded, userData);
+}
+
+/**
+ * Starts loading a font in the background.  Text drawn with the font is skipped
+ * until loading finishes.
+ *
+ * @param onLoaded optional function to call when the font is ready or fails
+ * @return a handle to check progress, or 0 if the load couldn't be started
+ */
+CnLoadId cnR_LoadPSF2FontAsync(CnFontId id, const char* path, CnLoadCallbackFn onLoaded, void* userData)
+{
+	CN_ASSERT_PTR(path);
+	return cnRAsync_QueueFont(id, path, onLoaded, userData);
+}
+
+CnLoadStatus cnR_LoadStatus(CnLoadId load)
+{
+	return cnRAsync_Status(load);
+}
+
+/**
+ * Limits the number of bytes of texture data uploaded at the start of each
+ * frame by asynchronous loads, to prevent long frames when many loads finish
+ * together.  At least one load is always uploaded per frame.
+ */
+void cnR_SetUploadBudget(uint32_t bytesPerFrame)
+{
+	cnRAsync_SetUploadBudget(bytesPerFrame);
+}
+
+/**
+ * Limits the bytes of sprite and font textures kept on the GPU, with zero
+ * (`CN_RESIDENCY_NO_BUDGET`) for no limit.  Least recently drawn textures are
+ * evicted when over budget, and transparently reloaded when next drawn, which
+ * stalls the frame drawing them.
+ */
+void cnR_SetTextureBudget(uint64_t bytes)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetTextureBudget(commands, bytes);
+	}
+	else {
+		cnRLL_SetTextureBudget(bytes);
+	}
+}
+
+static void cnR_ReadTextureStats(void* stats)
+{
+	cnRLL_TextureStats((CnResidencyStats*)stats);
+}
+
+/**
+ * Provides resident texture bytes, evictions and reload stalls of the last
+ * finished frame.
+ */
+void cnR_TextureStats(CnResidencyStats* stats)
+{
+	CN_ASSERT_PTR(stats);
+	cnRThread_Call(cnR_ReadTextureStats, stats);
 }
 
 void cnR_DrawSimpleText(CnFontId id, CnFloat2 position, const char* text)
@@ -120,47 +598,344 @@ void cnR_DrawSimpleText(CnFontId id, CnFloat2 position, const char* text)
 	params.color = (CnRGBA8u) { .red = 255, .green = 255, .blue = 255, .alpha = 255 };
 	params.layout = CnLayoutDirectionHorizontal;
 	params.printDirection = CnTextDirectionLeftToRight;
-	cnRLL_DrawSimpleText(id, &params, text);
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawSimpleText(commands, id, &params, text);
+	}
+	else {
+		cnRLL_DrawSimpleText(id, &params, text);
+	}
 }
 
 void cnR_DrawDebugFullScreenRect(void)
 {
-	cnRLL_DrawDebugFullScreenRect();
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawDebugFullScreenRect(commands);
+	}
+	else {
+		cnRLL_DrawDebugFullScreenRect();
+	}
 }
 
 void cnR_DrawDebugRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color)
 {
-	cnRLL_DrawDebugRect(center, dimensions, color);
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawDebugRect(commands, center, dimensions, color);
+	}
+	else {
+		cnRLL_DrawDebugRect(center, dimensions, color);
+	}
 }
 
 void cnR_DrawDebugLine(float x1, float y1, float x2, float y2, CnOpaqueColor color)
 {
-	cnRLL_DrawDebugLine(x1, y1, x2, y2, color);
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawDebugLine(commands, x1, y1, x2, y2, color);
+	}
+	else {
+		cnRLL_DrawDebugLine(x1, y1, x2, y2, color);
+	}
 }
 
 void cnR_DrawDebugLineStrip(CnFloat2* points, uint32_t numPoints, CnOpaqueColor color)
 {
-	cnRLL_DrawDebugLineStrip(points, numPoints, color);
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawDebugLineStrip(commands, points, numPoints, color);
+	}
+	else {
+		cnRLL_DrawDebugLineStrip(points, numPoints, color);
+	}
 }
 
 void cnR_DrawDebugFont(CnFontId id, CnFloat2 center, CnDimension2f size)
 {
-	cnRLL_DrawDebugFont(id, center, size);
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawDebugFont(commands, id, center, size);
+	}
+	else {
+		cnRLL_DrawDebugFont(id, center, size);
+	}
+}
+
+static void cnR_CreateMeshCall(void* data)
+{
+	CnRMeshCall* call = (CnRMeshCall*)data;
+	call->result = cnRLL_CreateMesh(call->id, call->vertices, call->numVertices, call->primitive);
+}
+
+/**
+ * Uploads geometry once to be drawn by handle, for static shapes which would
+ * otherwise be sent every frame, such as with `cnR_DrawDebugLineStrip`.
+ */
+bool cnR_CreateMesh(CnMeshId* id, const CnFloat2* vertices, uint32_t numVertices, CnMeshPrimitive primitive)
+{
+	CN_ASSERT(id != NULL, "Cannot assign a mesh to a null pointer.");
+	CnRMeshCall call = { .id = id, .vertices = vertices, .numVertices = numVertices, .primitive = primitive };
+	cnRThread_Call(cnR_CreateMeshCall, &call);
+	return call.result;
+}
+
+void cnR_DrawMesh(CnMeshId id, CnTransform2 transform, CnOpaqueColor color)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawMesh(commands, id, cnRLL_MatrixFromTransform(transform), color);
+	}
+	else {
+		cnRLL_DrawMesh(id, cnRLL_MatrixFromTransform(transform), color);
+	}
+}
+
+void cnR_DestroyMesh(CnMeshId id)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DestroyMesh(commands, id);
+	}
+	else {
+		cnRLL_DestroyMesh(id);
+	}
+}
+
+static void cnR_CreateLayerCall(void* data)
+{
+	CnRResourceCall* call = (CnRResourceCall*)data;
+	call->result = cnRLL_CreateLayer(call->newId);
+}
+
+/**
+ * Creates an offscreen layer the size of the backing canvas, for caching
+ * content which rarely changes, such as backgrounds.  Layers start dirty.
+ */
+bool cnR_CreateLayer(CnLayerId* id)
+{
+	CN_ASSERT(id != NULL, "Cannot assign a layer to a null pointer.");
+	CnRResourceCall call = { .newId = id };
+	cnRThread_Call(cnR_CreateLayerCall, &call);
+	if (call.result) {
+		layerDirty[*id - 1] = true;
+	}
+	return call.result;
+}
+
+void cnR_DestroyLayer(CnLayerId id)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DestroyLayer(commands, id);
+	}
+	else {
+		cnRLL_DestroyLayer(id);
+	}
+}
+
+/**
+ * Flags a layer to be redrawn the next time it is begun.
+ */
+void cnR_MarkLayerDirty(CnLayerId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_LAYERS, "Layer id out of range: %" PRIu32, id);
+	layerDirty[id - 1] = true;
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_MarkLayerDirty(commands, id);
+	}
+	else {
+		cnRLL_MarkLayerDirty(id);
+	}
+}
+
+/**
+ * Starts drawing into a layer, if it is dirty.  Draws go into the layer until
+ * `cnR_EndLayer`, with the current camera.
+ *
+ * @return true if the layer should be redrawn and then ended, false if its
+ * contents are up to date and nothing should be drawn
+ */
+bool cnR_BeginLayer(CnLayerId id)
+{
+	CN_ASSERT(id > 0 && id <= RLL_MAX_LAYERS, "Layer id out of range: %" PRIu32, id);
+
+	// Dirtiness is tracked here as well as by the renderer, so whether to draw
+	// the layer is known without waiting for the render thread.
+	CnRCommandList* commands = cnRThread_Recording();
+	if (!commands) {
+		layerDirty[id - 1] = false;
+		return cnRLL_BeginLayer(id);
+	}
+
+	if (!layerDirty[id - 1]) {
+		return false;
+	}
+	layerDirty[id - 1] = false;
+	cnRCommands_BeginLayer(commands, id);
+	return true;
+}
+
+void cnR_EndLayer(void)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_EndLayer(commands);
+	}
+	else {
+		cnRLL_EndLayer();
+	}
+}
+
+/**
+ * Draws the contents of a layer over the screen with a single quad.
+ */
+void cnR_DrawLayer(CnLayerId id)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawLayer(commands, id);
+	}
+	else {
+		cnRLL_DrawLayer(id);
+	}
+}
+
+static void cnR_CreateTilemapCall(void* data)
+{
+	CnRTilemapCall* call = (CnRTilemapCall*)data;
+	call->result = cnRLL_CreateTilemap(call->id, call->size, call->tileset, call->tilesetGrid);
+}
+
+/**
+ * Creates an empty tilemap drawn with tiles from a tileset sprite, which is a
+ * grid of equally sized tiles.  The tileset is kept out of sprite arrays from
+ * then on, and creating the tilemap fails if it was already loaded into one.
+ *
+ * @param size the number of columns and rows of tiles in the map
+ * @param tilesetGrid the number of columns and rows of tiles in the tileset
+ */
+bool cnR_CreateTilemap(CnTilemapId* id, CnDimension2u32 size, CnSpriteId tileset, CnDimension2u32 tilesetGrid)
+{
+	CN_ASSERT(id != NULL, "Cannot assign a tilemap to a null pointer.");
+	CnRTilemapCall call = { .id = id, .size = size, .tileset = tileset, .tilesetGrid = tilesetGrid };
+	cnRThread_Call(cnR_CreateTilemapCall, &call);
+	return call.result;
+}
+
+void cnR_DestroyTilemap(CnTilemapId id)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DestroyTilemap(commands, id);
+	}
+	else {
+		cnRLL_DestroyTilemap(id);
+	}
+}
+
+void cnR_SetTile(CnTilemapId id, CnRowColu32 position, CnTile tile)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_SetTile(commands, id, position, tile);
+	}
+	else {
+		cnRLL_SetTile(id, position, tile);
+	}
+}
+
+static void cnR_ReadTile(void* data)
+{
+	CnRTileCall* call = (CnRTileCall*)data;
+	call->tile = cnRLL_Tile(call->id, call->position);
+}
+
+/**
+ * Reads back a tile.  Waits for the render thread, if it is running.
+ */
+CnTile cnR_Tile(CnTilemapId id, CnRowColu32 position)
+{
+	CnRTileCall call = { .id = id, .position = position };
+	cnRThread_Call(cnR_ReadTile, &call);
+	return call.tile;
+}
+
+/**
+ * Draws the parts of a tilemap which the camera can see.  The cost depends on
+ * how much of the map is visible, not on the size of the map.
+ *
+ * @param origin where to draw the lower left corner of the map
+ */
+void cnR_DrawTilemap(CnTilemapId id, CnFloat2 origin, CnDimension2f tileSize)
+{
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawTilemap(commands, id, origin, tileSize);
+	}
+	else {
+		cnRLL_DrawTilemap(id, origin, tileSize);
+	}
+}
+
+/**
+ * The bounds of a rect after it has been transformed.
+ */
+static CnAABB2 cnR_RectBounds(CnFloat2 center, CnDimension2f dimensions, CnTransform2 transform)
+{
+	const CnFloat2 halfSize = cnFloat2_Make(fabsf(dimensions.width) / 2.0f, fabsf(dimensions.height) / 2.0f);
+	return cnMath2_TransformAABB2(
+		cnAABB2_MakeMinMax(cnFloat2_Sub(center, halfSize), cnFloat2_Add(center, halfSize)), transform);
 }
 
 void cnR_DrawRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnTransform2 transform)
 {
-	cnRLL_DrawRect(center, dimensions, color, cnRLL_MatrixFromTransform(transform));
+	if (!cnR_IsVisible(cnR_RectBounds(center, dimensions, transform))) {
+		return;
+	}
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_DrawRect(commands, center, dimensions, color, cnRLL_MatrixFromTransform(transform));
+	}
+	else {
+		cnRLL_DrawRect(center, dimensions, color, cnRLL_MatrixFromTransform(transform));
+	}
 }
 
 void cnR_OutlineRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnTransform2 transform)
 {
-	cnRLL_OutlineRect(center, dimensions, color, cnRLL_MatrixFromTransform(transform));
+	if (!cnR_IsVisible(cnR_RectBounds(center, dimensions, transform))) {
+		return;
+	}
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_OutlineRect(commands, center, dimensions, color, cnRLL_MatrixFromTransform(transform));
+	}
+	else {
+		cnRLL_OutlineRect(center, dimensions, color, cnRLL_MatrixFromTransform(transform));
+	}
 }
 
 void cnR_OutlineCircle(CnFloat2 center, float radius, CnOpaqueColor color, uint32_t numSegments)
 {
-	cnRLL_OutlineCircle(center, radius, color, numSegments);
+	const CnFloat2 extent = cnFloat2_Make(radius, radius);
+	const CnAABB2 bounds = cnAABB2_MakeMinMax(cnFloat2_Sub(center, extent), cnFloat2_Add(center, extent));
+	if (!cnR_IsVisible(bounds)) {
+		return;
+	}
+
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_OutlineCircle(commands, center, radius, color, numSegments);
+	}
+	else {
+		cnRLL_OutlineCircle(center, radius, color, numSegments);
+	}
 }
 
 /**
@@ -168,5 +943,11 @@ void cnR_OutlineCircle(CnFloat2 center, float radius, CnOpaqueColor color, uint3
  */
 void cnR_FillScreen(CnOpaqueColor color)
 {
-	cnRLL_FillScreen(color);
+	CnRCommandList* commands = cnRThread_Recording();
+	if (commands) {
+		cnRCommands_FillScreen(commands, color);
+	}
+	else {
+		cnRLL_FillScreen(color);
+	}
 }
\ No newline at end of file
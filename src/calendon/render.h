@@ -27,8 +27,11 @@
 #include <calendon/cn.h>
 
 #include <calendon/color.h>
+#include <calendon/cull.h>
 #include <calendon/math2.h>
 #include <calendon/render-resources.h>
+#include <calendon/residency.h>
+#include <calendon/tilemap.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +40,9 @@ extern "C" {
 CN_API void cnR_Init(CnDimension2u32 resolution);
 CN_API void cnR_Shutdown(void);
 
+CN_API bool cnR_StartRenderThread(uint32_t latencyFrames);
+CN_API void cnR_StopRenderThread(void);
+
 CN_API void cnR_StartFrame(void);
 CN_API void cnR_EndFrame(void);
 
@@ -50,20 +56,61 @@ CN_API void cnR_SetViewport(CnAABB2 viewport);
 CN_API CnAABB2 cnR_CameraAABB2(void);
 CN_API void cnR_SetCameraAABB2(CnAABB2 area);
 
+CN_API void  cnR_SetDynamicResolution(uint64_t budgetMicros, float minScale);
+CN_API float cnR_RenderScale(void);
+
+CN_API CnPresentMode cnR_SetPresentMode(CnPresentMode mode);
+CN_API void          cnR_SetMaxFramesInFlight(uint32_t frames);
+CN_API void          cnR_FrameStats(CnFrameStats* stats);
+
+CN_API bool cnR_StartCapture(const char* directory, CnCaptureFormat format);
+CN_API void cnR_StopCapture(void);
+CN_API void cnR_CaptureStats(CnCaptureStats* stats);
+
+CN_API uint32_t cnR_CullAABB2s(const CnAABB2* bounds, uint32_t numBounds, uint32_t* visible);
+CN_API void     cnR_CullStats(CnCullStats* stats);
+
 CN_API bool cnR_CreateSprite(CnSpriteId* id);
 CN_API bool cnR_LoadSprite(CnSpriteId id, const char* path);
 CN_API void cnR_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size);
+CN_API void cnR_SetSpriteArrays(bool enabled);
 
 CN_API bool cnR_CreateFont(CnFontId* id);
 CN_API bool cnR_LoadPSF2Font(CnFontId id, const char* path);
 CN_API void cnR_DrawSimpleText(CnFontId id, CnFloat2 position, const char* text);
 
+CN_API CnLoadId     cnR_LoadSpriteAsync(CnSpriteId id, const char* path, CnLoadCallbackFn onLoaded, void* userData);
+CN_API CnLoadId     cnR_LoadPSF2FontAsync(CnFontId id, const char* path, CnLoadCallbackFn onLoaded, void* userData);
+CN_API CnLoadStatus cnR_LoadStatus(CnLoadId load);
+CN_API void         cnR_SetUploadBudget(uint32_t bytesPerFrame);
+
+CN_API void cnR_SetTextureBudget(uint64_t bytes);
+CN_API void cnR_TextureStats(CnResidencyStats* stats);
+
 CN_API void cnR_DrawDebugFullScreenRect(void);
 CN_API void cnR_DrawDebugRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color);
 CN_API void cnR_DrawDebugLine(float x1, float y1, float x2, float y2, CnOpaqueColor color);
 CN_API void cnR_DrawDebugLineStrip(CnFloat2* points, uint32_t numPoints, CnOpaqueColor color);
 CN_API void cnR_DrawDebugFont(CnFontId id, CnFloat2 center, CnDimension2f size);
 
+CN_API bool cnR_CreateMesh(CnMeshId* id, const CnFloat2* vertices, uint32_t numVertices, CnMeshPrimitive primitive);
+CN_API void cnR_DrawMesh(CnMeshId id, CnTransform2 transform, CnOpaqueColor color);
+CN_API void cnR_DestroyMesh(CnMeshId id);
+
+CN_API bool cnR_CreateLayer(CnLayerId* id);
+CN_API void cnR_DestroyLayer(CnLayerId id);
+CN_API void cnR_MarkLayerDirty(CnLayerId id);
+CN_API bool cnR_BeginLayer(CnLayerId id);
+CN_API void cnR_EndLayer(void);
+CN_API void cnR_DrawLayer(CnLayerId id);
+
+CN_API bool   cnR_CreateTilemap(CnTilemapId* id, CnDimension2u32 size, CnSpriteId tileset,
+	CnDimension2u32 tilesetGrid);
+CN_API void   cnR_DestroyTilemap(CnTilemapId id);
+CN_API void   cnR_SetTile(CnTilemapId id, CnRowColu32 position, CnTile tile);
+CN_API CnTile cnR_Tile(CnTilemapId id, CnRowColu32 position);
+CN_API void   cnR_DrawTilemap(CnTilemapId id, CnFloat2 origin, CnDimension2f tileSize);
+
 CN_API void cnR_DrawRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnTransform2 transform);
 CN_API void cnR_OutlineRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnTransform2 transform);
 CN_API void cnR_OutlineCircle(CnFloat2 center, float radius, CnOpaqueColor color, uint32_t numSegments);
@@ -0,0 +1,150 @@
+#include "residency.h"
+
+#include <string.h>
+
+void cnResidency_Init(CnResidency* residency, uint64_t budgetBytes)
+{
+	CN_ASSERT_PTR(residency);
+
+	memset(residency, 0, sizeof(CnResidency));
+	residency->budgetBytes = budgetBytes;
+}
+
+void cnResidency_SetBudget(CnResidency* residency, uint64_t budgetBytes)
+{
+	CN_ASSERT_PTR(residency);
+	residency->budgetBytes = budgetBytes;
+}
+
+/**
+ * Advances to the next frame, keeping the stats of the frame just finished.
+ */
+void cnResidency_StartFrame(CnResidency* residency)
+{
+	CN_ASSERT_PTR(residency);
+
+	residency->lastFrameStats = residency->frameStats;
+	residency->lastFrameStats.residentBytes = residency->residentBytes;
+	residency->lastFrameStats.budgetBytes = residency->budgetBytes;
+	memset(&residency->frameStats, 0, sizeof(CnResidencyStats));
+	++residency->frame;
+}
+
+/**
+ * Tracks a newly uploaded texture as resident, replacing whatever the entry
+ * previously held.
+ */
+void cnResidency_Add(CnResidency* residency, uint32_t entry, uint64_t bytes, bool pinned)
+{
+	CN_ASSERT_PTR(residency);
+	CN_ASSERT(entry < CN_RESIDENCY_MAX_ENTRIES, "Residency entry out of range: %" PRIu32, entry);
+
+	cnResidency_Remove(residency, entry);
+
+	CnResidencyEntry* e = &residency->entries[entry];
+	e->bytes = bytes;
+	e->lastUsedFrame = residency->frame;
+	e->tracked = true;
+	e->resident = true;
+	e->pinned = pinned;
+	residency->residentBytes += bytes;
+}
+
+void cnResidency_Remove(CnResidency* residency, uint32_t entry)
+{
+	CN_ASSERT_PTR(residency);
+	CN_ASSERT(entry < CN_RESIDENCY_MAX_ENTRIES, "Residency entry out of range: %" PRIu32, entry);
+
+	CnResidencyEntry* e = &residency->entries[entry];
+	if (e->resident) {
+		residency->residentBytes -= e->bytes;
+	}
+	memset(e, 0, sizeof(CnResidencyEntry));
+}
+
+/**
+ * Marks an entry as used this frame.
+ *
+ * @return false if the entry was evicted and must be reloaded before use
+ */
+bool cnResidency_Touch(CnResidency* residency, uint32_t entry)
+{
+	CN_ASSERT_PTR(residency);
+	CN_ASSERT(entry < CN_RESIDENCY_MAX_ENTRIES, "Residency entry out of range: %" PRIu32, entry);
+
+	CnResidencyEntry* e = &residency->entries[entry];
+	e->lastUsedFrame = residency->frame;
+	return !e->tracked || e->resident;
+}
+
+/**
+ * Records an evicted entry having been reloaded, and how long it stalled the
+ * frame.
+ */
+void cnResidency_Reloaded(CnResidency* residency, uint32_t entry, uint64_t micros)
+{
+	CN_ASSERT_PTR(residency);
+	CN_ASSERT(entry < CN_RESIDENCY_MAX_ENTRIES, "Residency entry out of range: %" PRIu32, entry);
+
+	CnResidencyEntry* e = &residency->entries[entry];
+	CN_ASSERT(e->tracked && !e->resident, "Reloaded an entry which wasn't evicted: %" PRIu32, entry);
+	e->resident = true;
+	e->lastUsedFrame = residency->frame;
+	residency->residentBytes += e->bytes;
+
+	++residency->frameStats.reloads;
+	residency->frameStats.reloadMicros += micros;
+}
+
+/**
+ * Evicts least recently used entries until resident textures fit in the
+ * budget.  Entries used this frame aren't evicted, so the budget might still
+ * be exceeded afterwards.
+ *
+ * @return the number of entries evicted
+ */
+uint32_t cnResidency_Evict(CnResidency* residency, CnResidencyEvictFn evict, void* userData)
+{
+	CN_ASSERT_PTR(residency);
+	CN_ASSERT_PTR(evict);
+
+	if (residency->budgetBytes == CN_RESIDENCY_NO_BUDGET) {
+		return 0;
+	}
+
+	uint32_t numEvicted = 0;
+	while (residency->residentBytes > residency->budgetBytes) {
+		uint32_t oldest = CN_RESIDENCY_MAX_ENTRIES;
+		for (uint32_t i = 0; i < CN_RESIDENCY_MAX_ENTRIES; ++i) {
+			const CnResidencyEntry* e = &residency->entries[i];
+			if (!e->resident || e->pinned || e->lastUsedFrame == residency->frame) {
+				continue;
+			}
+			if (oldest == CN_RESIDENCY_MAX_ENTRIES || e->lastUsedFrame < residency->entries[oldest].lastUsedFrame) {
+				oldest = i;
+			}
+		}
+		if (oldest == CN_RESIDENCY_MAX_ENTRIES) {
+			break;
+		}
+
+		evict(oldest, userData);
+		residency->entries[oldest].resident = false;
+		residency->residentBytes -= residency->entries[oldest].bytes;
+		++numEvicted;
+	}
+
+	residency->frameStats.evictions += numEvicted;
+	return numEvicted;
+}
+
+/**
+ * Provides the stats of the last finished frame.
+ */
+void cnResidency_Stats(const CnResidency* residency, CnResidencyStats* stats)
+{
+	CN_ASSERT_PTR(residency);
+	CN_ASSERT_PTR(stats);
+
+	*stats = residency->lastFrameStats;
+}
@@ -0,0 +1,82 @@
+#ifndef CN_RESIDENCY_H
+#define CN_RESIDENCY_H
+
+/**
+ * @file residency.h
+ *
+ * Tracks which textures are resident on the GPU against a memory budget.
+ *
+ * Each texture is an entry, with its size in bytes and the last frame it was
+ * used.  When resident textures exceed the budget, the least recently used
+ * are evicted, never those used in the current frame.  Evicted textures stay
+ * tracked, so the renderer can reload them when they're next used.
+ *
+ * This only keeps the books, the renderer does the actual deleting and
+ * reloading of textures.
+ */
+
+#include <calendon/cn.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CN_RESIDENCY_MAX_ENTRIES 64
+
+/**
+ * A budget of zero is no budget, nothing is evicted.
+ */
+#define CN_RESIDENCY_NO_BUDGET 0
+
+typedef struct {
+	uint64_t bytes;
+	uint64_t lastUsedFrame;
+	bool tracked;
+	bool resident;
+
+	/** Pinned entries count against the budget but are never evicted. */
+	bool pinned;
+} CnResidencyEntry;
+
+/**
+ * What happened to resident textures during a frame.
+ */
+typedef struct {
+	uint64_t residentBytes;
+	uint64_t budgetBytes;
+	uint32_t evictions;
+
+	/** Textures which had to be reloaded before they could be drawn. */
+	uint32_t reloads;
+	uint64_t reloadMicros;
+} CnResidencyStats;
+
+typedef struct {
+	CnResidencyEntry entries[CN_RESIDENCY_MAX_ENTRIES];
+	uint64_t budgetBytes;
+	uint64_t residentBytes;
+	uint64_t frame;
+	CnResidencyStats frameStats;
+	CnResidencyStats lastFrameStats;
+} CnResidency;
+
+/**
+ * Called for each entry evicted, to release its texture.
+ */
+typedef void (*CnResidencyEvictFn)(uint32_t entry, void* userData);
+
+CN_TEST_API void     cnResidency_Init(CnResidency* residency, uint64_t budgetBytes);
+CN_TEST_API void     cnResidency_SetBudget(CnResidency* residency, uint64_t budgetBytes);
+CN_TEST_API void     cnResidency_StartFrame(CnResidency* residency);
+CN_TEST_API void     cnResidency_Add(CnResidency* residency, uint32_t entry, uint64_t bytes, bool pinned);
+CN_TEST_API void     cnResidency_Remove(CnResidency* residency, uint32_t entry);
+CN_TEST_API bool     cnResidency_Touch(CnResidency* residency, uint32_t entry);
+CN_TEST_API void     cnResidency_Reloaded(CnResidency* residency, uint32_t entry, uint64_t micros);
+CN_TEST_API uint32_t cnResidency_Evict(CnResidency* residency, CnResidencyEvictFn evict, void* userData);
+CN_TEST_API void     cnResidency_Stats(const CnResidency* residency, CnResidencyStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_RESIDENCY_H */
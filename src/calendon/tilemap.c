@@ -0,0 +1,197 @@
+#include "tilemap.h"
+
+#include <math.h>
+#include <string.h>
+
+#define CN_TILEMAP_UNORM16_ONE 65535
+
+/**
+ * Allocates an empty map.  Every chunk starts dirty.
+ */
+bool cnTilemap_Allocate(CnTilemap* map, CnDimension2u32 size)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT(size.width > 0 && size.height > 0, "Tilemap must have a size: %" PRIu32 "x%" PRIu32,
+		size.width, size.height);
+
+	memset(map, 0, sizeof(CnTilemap));
+	map->size = size;
+	map->numChunks.width = (size.width + CN_TILEMAP_CHUNK_SIZE - 1) / CN_TILEMAP_CHUNK_SIZE;
+	map->numChunks.height = (size.height + CN_TILEMAP_CHUNK_SIZE - 1) / CN_TILEMAP_CHUNK_SIZE;
+
+	const uint64_t bytes = (uint64_t)map->numChunks.width * map->numChunks.height * sizeof(CnTilemapChunk);
+	if (bytes > UINT32_MAX) {
+		return false;
+	}
+
+	cnDynamicBuffer_Allocate(&map->chunkStorage, (uint32_t)bytes);
+	map->chunks = (CnTilemapChunk*)map->chunkStorage.contents;
+	memset(map->chunks, 0, (size_t)bytes);
+	for (uint32_t i = 0; i < map->numChunks.width * map->numChunks.height; ++i) {
+		map->chunks[i].dirty = true;
+	}
+	return true;
+}
+
+void cnTilemap_Free(CnTilemap* map)
+{
+	CN_ASSERT_PTR(map);
+	cnDynamicBuffer_Free(&map->chunkStorage);
+	memset(map, 0, sizeof(CnTilemap));
+}
+
+CnTilemapChunk* cnTilemap_Chunk(CnTilemap* map, CnRowColu32 chunk)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT(chunk.row < map->numChunks.height && chunk.col < map->numChunks.width,
+		"Chunk out of range: (%" PRIu32 ", %" PRIu32 ")", chunk.row, chunk.col);
+	return &map->chunks[chunk.row * map->numChunks.width + chunk.col];
+}
+
+static uint32_t cnTilemap_TileIndex(CnRowColu32 position)
+{
+	return (position.row % CN_TILEMAP_CHUNK_SIZE) * CN_TILEMAP_CHUNK_SIZE + position.col % CN_TILEMAP_CHUNK_SIZE;
+}
+
+void cnTilemap_Set(CnTilemap* map, CnRowColu32 position, CnTile tile)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT(position.row < map->size.height && position.col < map->size.width,
+		"Tile out of range: (%" PRIu32 ", %" PRIu32 ")", position.row, position.col);
+
+	const CnRowColu32 chunkPosition = { position.row / CN_TILEMAP_CHUNK_SIZE, position.col / CN_TILEMAP_CHUNK_SIZE };
+	CnTilemapChunk* chunk = cnTilemap_Chunk(map, chunkPosition);
+	CnTile* existing = &chunk->tiles[cnTilemap_TileIndex(position)];
+	if (*existing == tile) {
+		return;
+	}
+
+	if (*existing == CN_TILE_EMPTY) {
+		++chunk->numTiles;
+	}
+	else if (tile == CN_TILE_EMPTY) {
+		--chunk->numTiles;
+	}
+	*existing = tile;
+	chunk->dirty = true;
+}
+
+CnTile cnTilemap_Get(const CnTilemap* map, CnRowColu32 position)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT(position.row < map->size.height && position.col < map->size.width,
+		"Tile out of range: (%" PRIu32 ", %" PRIu32 ")", position.row, position.col);
+
+	const CnTilemapChunk* chunk = &map->chunks[(position.row / CN_TILEMAP_CHUNK_SIZE) * map->numChunks.width
+		+ position.col / CN_TILEMAP_CHUNK_SIZE];
+	return chunk->tiles[cnTilemap_TileIndex(position)];
+}
+
+/**
+ * Clamps a distance in chunks to the chunks which exist.
+ */
+static uint32_t cnTilemap_ClampChunk(float chunk, uint32_t numChunks)
+{
+	if (chunk < 0.0f) {
+		return 0;
+	}
+	if (chunk >= (float)numChunks) {
+		return numChunks - 1;
+	}
+	return (uint32_t)chunk;
+}
+
+/**
+ * Finds the range of chunks which overlap an area, such as what the camera
+ * sees.  The cost depends on the size of the area, not the size of the map.
+ *
+ * @param origin where the lower left corner of the map is drawn
+ * @param tileSize the size of each tile where it is drawn
+ * @param first,last the lowest and highest chunks which overlap, inclusive
+ * @return false if no chunks overlap the area
+ */
+bool cnTilemap_VisibleChunks(const CnTilemap* map, CnFloat2 origin, CnDimension2f tileSize, CnAABB2 area,
+	CnRowColu32* first, CnRowColu32* last)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT_PTR(first);
+	CN_ASSERT_PTR(last);
+	CN_ASSERT(tileSize.width > 0.0f && tileSize.height > 0.0f, "Tiles must have a size");
+
+	const float chunkWidth = tileSize.width * CN_TILEMAP_CHUNK_SIZE;
+	const float chunkHeight = tileSize.height * CN_TILEMAP_CHUNK_SIZE;
+	const float mapWidth = tileSize.width * (float)map->size.width;
+	const float mapHeight = tileSize.height * (float)map->size.height;
+
+	if (area.max.x <= origin.x || area.max.y <= origin.y
+		|| area.min.x >= origin.x + mapWidth || area.min.y >= origin.y + mapHeight)
+	{
+		return false;
+	}
+
+	first->col = cnTilemap_ClampChunk(floorf((area.min.x - origin.x) / chunkWidth), map->numChunks.width);
+	first->row = cnTilemap_ClampChunk(floorf((area.min.y - origin.y) / chunkHeight), map->numChunks.height);
+	last->col = cnTilemap_ClampChunk(floorf((area.max.x - origin.x) / chunkWidth), map->numChunks.width);
+	last->row = cnTilemap_ClampChunk(floorf((area.max.y - origin.y) / chunkHeight), map->numChunks.height);
+	return true;
+}
+
+/**
+ * Builds two triangles for each tile in a chunk which isn't empty, and marks
+ * the chunk as clean.
+ *
+ * @param tilesetGrid the number of columns and rows of tiles in the tileset,
+ * with tile 1 in the top left of the image, increasing along rows
+ * @param vertices space for `CN_TILEMAP_CHUNK_TILES * CN_TILEMAP_VERTICES_PER_TILE`
+ * vertices
+ * @return the number of vertices built
+ */
+uint32_t cnTilemap_BuildChunk(CnTilemap* map, CnRowColu32 chunk, CnDimension2u32 tilesetGrid,
+	CnTilemapVertex* vertices)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT_PTR(vertices);
+	CN_ASSERT(tilesetGrid.width > 0 && tilesetGrid.height > 0, "Tileset must have tiles");
+
+	CnTilemapChunk* c = cnTilemap_Chunk(map, chunk);
+	const uint32_t numTilesetTiles = tilesetGrid.width * tilesetGrid.height;
+
+	uint32_t numVertices = 0;
+	for (uint32_t row = 0; row < CN_TILEMAP_CHUNK_SIZE; ++row) {
+		for (uint32_t col = 0; col < CN_TILEMAP_CHUNK_SIZE; ++col) {
+			const CnTile tile = c->tiles[row * CN_TILEMAP_CHUNK_SIZE + col];
+			if (tile == CN_TILE_EMPTY) {
+				continue;
+			}
+			CN_ASSERT(tile <= numTilesetTiles, "Tile %" PRIu32 " is outside of the tileset", (uint32_t)tile);
+
+			const uint32_t index = (uint32_t)tile - 1;
+			const uint16_t u0 = (uint16_t)((index % tilesetGrid.width) * CN_TILEMAP_UNORM16_ONE / tilesetGrid.width);
+			const uint16_t u1 = (uint16_t)((index % tilesetGrid.width + 1) * CN_TILEMAP_UNORM16_ONE / tilesetGrid.width);
+			const uint32_t tilesetRow = tilesetGrid.height - index / tilesetGrid.width - 1;
+			const uint16_t v0 = (uint16_t)(tilesetRow * CN_TILEMAP_UNORM16_ONE / tilesetGrid.height);
+			const uint16_t v1 = (uint16_t)((tilesetRow + 1) * CN_TILEMAP_UNORM16_ONE / tilesetGrid.height);
+			const int16_t x0 = (int16_t)col;
+			const int16_t x1 = (int16_t)(col + 1);
+			const int16_t y0 = (int16_t)row;
+			const int16_t y1 = (int16_t)(row + 1);
+
+			const CnTilemapVertex lowerLeft = { { x0, y0 }, { u0, v0 } };
+			const CnTilemapVertex lowerRight = { { x1, y0 }, { u1, v0 } };
+			const CnTilemapVertex upperLeft = { { x0, y1 }, { u0, v1 } };
+			const CnTilemapVertex upperRight = { { x1, y1 }, { u1, v1 } };
+
+			CnTilemapVertex* v = &vertices[numVertices];
+			v[0] = lowerLeft;
+			v[1] = lowerRight;
+			v[2] = upperLeft;
+			v[3] = lowerRight;
+			v[4] = upperRight;
+			v[5] = upperLeft;
+			numVertices += CN_TILEMAP_VERTICES_PER_TILE;
+		}
+	}
+
+	c->dirty = false;
+	return numVertices;
+}
@@ -0,0 +1,86 @@
+#ifndef CN_TILEMAP_H
+#define CN_TILEMAP_H
+
+/**
+ * @file tilemap.h
+ *
+ * Tiles of a grid based level, stored in square chunks.  Chunks are the unit
+ * of drawing: each one is built into its own vertex buffer, which is only
+ * rebuilt when one of its tiles changes, and only chunks overlapping the
+ * camera are drawn.
+ *
+ * Tiles are addressed by row and column, with row 0 at the bottom of the map,
+ * since Y goes up.  A tile is an index into the grid of tiles in the tileset
+ * image, plus one, so zero is an empty tile.
+ *
+ * This holds the tiles and builds vertices, the renderer owns the buffers.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/dimension.h>
+#include <calendon/math2.h>
+#include <calendon/memory.h>
+#include <calendon/row-col.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Width and height of a chunk, in tiles.
+ */
+#define CN_TILEMAP_CHUNK_SIZE 32
+#define CN_TILEMAP_CHUNK_TILES (CN_TILEMAP_CHUNK_SIZE * CN_TILEMAP_CHUNK_SIZE)
+#define CN_TILEMAP_VERTICES_PER_TILE 6
+
+#define CN_TILE_EMPTY 0
+
+typedef uint16_t CnTile;
+
+typedef struct {
+	CnTile tiles[CN_TILEMAP_CHUNK_TILES];
+
+	/** Tiles which aren't empty, so empty chunks can be skipped. */
+	uint32_t numTiles;
+
+	/** The chunk has changed since its vertices were last built. */
+	bool dirty;
+} CnTilemapChunk;
+
+typedef struct {
+	/** Size of the map, in tiles. */
+	CnDimension2u32 size;
+
+	/** Size of the map, in chunks, rounded up. */
+	CnDimension2u32 numChunks;
+
+	/** Chunks in rows, starting from the bottom. */
+	CnDynamicBuffer chunkStorage;
+	CnTilemapChunk* chunks;
+} CnTilemap;
+
+/**
+ * A corner of a tile in a chunk.  Positions are in tiles from the lower left
+ * of the chunk, and texture coordinates are normalized over the tileset.
+ */
+typedef struct {
+	int16_t position[2];
+	uint16_t texCoord[2];
+} CnTilemapVertex;
+
+CN_TEST_API bool            cnTilemap_Allocate(CnTilemap* map, CnDimension2u32 size);
+CN_TEST_API void            cnTilemap_Free(CnTilemap* map);
+CN_TEST_API void            cnTilemap_Set(CnTilemap* map, CnRowColu32 position, CnTile tile);
+CN_TEST_API CnTile          cnTilemap_Get(const CnTilemap* map, CnRowColu32 position);
+CN_TEST_API CnTilemapChunk* cnTilemap_Chunk(CnTilemap* map, CnRowColu32 chunk);
+CN_TEST_API bool            cnTilemap_VisibleChunks(const CnTilemap* map, CnFloat2 origin, CnDimension2f tileSize,
+	CnAABB2 area, CnRowColu32* first, CnRowColu32* last);
+CN_TEST_API uint32_t        cnTilemap_BuildChunk(CnTilemap* map, CnRowColu32 chunk, CnDimension2u32 tilesetGrid,
+	CnTilemapVertex* vertices);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_TILEMAP_H */
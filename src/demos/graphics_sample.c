@@ -114,10 +114,11 @@ CN_GAME_API bool Demo_Init(void)
 		"sprites/stick_person3.png"
 	};
 
+	// Frames show a placeholder until they finish loading in the background.
 	for (uint32_t i = 0; i < 3; ++i) {
 		CnPathBuffer path;
 		cnAssets_PathBufferFor(frameFilenames[i], &path);
-		cnR_LoadSprite(spriteFrames[i], path.str);
+		cnR_LoadSpriteAsync(spriteFrames[i], path.str, NULL, NULL);
 	}
 
 	rotate = cnTransform2_MakeIdentity();
@@ -40,6 +40,9 @@ CN_GAME_API bool Demo_Init(void)
 	sampleLoop.elapsed[1] = cnTime_MakeMilli(150);
 	sampleLoop.elapsed[2] = cnTime_MakeMilli(150);
 
+	// The frames are all the same size, so can share a texture array.
+	cnR_SetSpriteArrays(true);
+
 	cnR_CreateSprite(&spriteFrames[0]);
 	cnR_CreateSprite(&spriteFrames[1]);
 	cnR_CreateSprite(&spriteFrames[2]);
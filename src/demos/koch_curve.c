@@ -16,12 +16,28 @@ CnTime currentTime;
 CnFloat2 points[2][MAX_POINTS];
 uint32_t currentBuffer = 0;
 
+// The curve only changes each step, so it is kept by the renderer as a mesh
+// instead of being sent every frame.
+CnMeshId curve = 0;
+
+void rebuildCurve(void)
+{
+	if (curve != 0) {
+		cnR_DestroyMesh(curve);
+		curve = 0;
+	}
+	if (!cnR_CreateMesh(&curve, points[currentBuffer], numCurrentPoints, CnMeshPrimitiveLineStrip)) {
+		curve = 0;
+	}
+}
+
 void reset(void)
 {
 	currentBuffer = 0;
 	points[currentBuffer][0] = cnFloat2_Make(200, 200);
 	points[currentBuffer][1] = cnFloat2_Make(600, 200);
 	numCurrentPoints = 2;
+	rebuildCurve();
 }
 
 void step(void)
@@ -61,6 +77,7 @@ void step(void)
 		++numNewPoints;
 		currentBuffer = ((currentBuffer + 1) % 2);
 		numCurrentPoints = numNewPoints;
+		rebuildCurve();
 	}
 	else {
 		reset();
@@ -84,7 +101,9 @@ CN_GAME_API void Demo_Draw(CnFrameEvent* event)
 	CN_UNUSED(event);
 	cnR_StartFrame();
 	const CnOpaqueColor white = cnOpaqueColor_MakeRGBu8(255, 255, 255);
-	cnR_DrawDebugLineStrip(points[currentBuffer], numCurrentPoints, white);
+	if (curve != 0) {
+		cnR_DrawMesh(curve, cnTransform2_MakeIdentity(), white);
+	}
 	cnR_EndFrame();
 }
 
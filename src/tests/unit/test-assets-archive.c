@@ -0,0 +1,210 @@
+#include <calendon/test.h>
+
+#include <calendon/assets-archive.h>
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <zlib.h>
+
+#define MAX_TEST_ENTRIES 4
+
+typedef struct {
+	const char* name;
+	const char* contents;
+	bool compress;
+} TestEntry;
+
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + CN_ARCHIVE_ALIGNMENT - 1) & ~(uint64_t)(CN_ARCHIVE_ALIGNMENT - 1);
+}
+
+/**
+ * Packs entries with the same layout as calendon-packer.
+ */
+static bool packArchive(const char* path, TestEntry* entries, uint32_t numEntries)
+{
+	CN_ASSERT(numEntries <= MAX_TEST_ENTRIES, "Too many test entries: %" PRIu32, numEntries);
+
+	// Entries are found by a binary search on their hashes.
+	for (uint32_t i = 1; i < numEntries; ++i) {
+		for (uint32_t j = i; j > 0
+			&& cnArchive_HashName(entries[j - 1].name) > cnArchive_HashName(entries[j].name); --j)
+		{
+			const TestEntry swap = entries[j];
+			entries[j] = entries[j - 1];
+			entries[j - 1] = swap;
+		}
+	}
+
+	CnArchiveHeader header;
+	memcpy(header.magic, cnArchive_Magic, sizeof(header.magic));
+	header.version = CN_ARCHIVE_VERSION;
+	header.numEntries = numEntries;
+	header.namesSize = 0;
+
+	CnArchiveEntry table[MAX_TEST_ENTRIES];
+	uint8_t stored[MAX_TEST_ENTRIES][256];
+	for (uint32_t i = 0; i < numEntries; ++i) {
+		const uint32_t size = (uint32_t)strlen(entries[i].contents);
+		uLongf storedSize = sizeof(stored[i]);
+		if (entries[i].compress) {
+			if (compress2(stored[i], &storedSize, (const Bytef*)entries[i].contents, size, Z_BEST_COMPRESSION)
+				!= Z_OK) {
+				return false;
+			}
+		}
+		else {
+			memcpy(stored[i], entries[i].contents, size);
+			storedSize = size;
+		}
+
+		table[i].nameHash = cnArchive_HashName(entries[i].name);
+		table[i].storedSize = (uint32_t)storedSize;
+		table[i].size = size;
+		table[i].nameOffset = header.namesSize;
+		table[i].flags = entries[i].compress ? CN_ARCHIVE_ENTRY_FLAG_ZLIB : 0;
+		header.namesSize += (uint32_t)strlen(entries[i].name) + 1;
+	}
+
+	uint64_t offset = sizeof(CnArchiveHeader) + numEntries * sizeof(CnArchiveEntry) + header.namesSize;
+	for (uint32_t i = 0; i < numEntries; ++i) {
+		table[i].offset = alignOffset(offset);
+		offset = table[i].offset + table[i].storedSize;
+	}
+
+	FILE* file = fopen(path, "wb");
+	if (!file) {
+		return false;
+	}
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(table, sizeof(CnArchiveEntry), numEntries, file) == numEntries;
+	for (uint32_t i = 0; written && i < numEntries; ++i) {
+		written = fwrite(entries[i].name, strlen(entries[i].name) + 1, 1, file) == 1;
+	}
+	for (uint32_t i = 0; written && i < numEntries; ++i) {
+		written = fseek(file, (long)table[i].offset, SEEK_SET) == 0
+			&& fwrite(stored[i], table[i].storedSize, 1, file) == 1;
+	}
+	fclose(file);
+	return written;
+}
+
+/**
+ * Rewrites the unpacked size of an entry in a packed archive.
+ */
+static bool setEntrySize(const char* path, uint32_t index, uint32_t size)
+{
+	FILE* file = fopen(path, "r+b");
+	if (!file) {
+		return false;
+	}
+	const long position = (long)(sizeof(CnArchiveHeader) + index * sizeof(CnArchiveEntry)
+		+ offsetof(CnArchiveEntry, size));
+	const bool written = fseek(file, position, SEEK_SET) == 0 && fwrite(&size, sizeof(size), 1, file) == 1;
+	fclose(file);
+	return written;
+}
+
+static bool entryMatches(const CnArchive* archive, const char* name, const char* contents)
+{
+	const CnArchiveEntry* entry = cnArchive_Find(archive, name);
+	CnFileView view;
+	if (!entry || !cnArchive_MapEntry(archive, entry, &view)) {
+		return false;
+	}
+	const bool matches = view.size == strlen(contents) && memcmp(view.contents, contents, view.size) == 0;
+	if (view.source == CnFileViewSourceBuffer) {
+		cnDynamicBuffer_Free(&view.buffer);
+	}
+	return matches;
+}
+
+CN_TEST_SUITE_BEGIN("Assets Archive") {
+	// Rejected archives are logged as errors, which break into the debugger in
+	// debug builds.
+	signal(SIGTRAP, SIG_IGN);
+
+	CN_TEST_UNIT("Name hashes are stable") {
+		// 64-bit FNV-1a reference values.
+		CN_TEST_ASSERT_EQ_U64(0xcbf29ce484222325ULL, cnArchive_HashName(""));
+		CN_TEST_ASSERT_EQ_U64(0xaf63dc4c8601ec8cULL, cnArchive_HashName("a"));
+		CN_TEST_ASSERT_EQ_U64(0x85944171f73967e8ULL, cnArchive_HashName("foobar"));
+	}
+
+	CN_TEST_UNIT("Name hashes are case sensitive") {
+		CN_TEST_ASSERT_TRUE(cnArchive_HashName("sprites/a.png") != cnArchive_HashName("sprites/A.png"));
+	}
+
+	CN_TEST_UNIT("Closed archives find nothing") {
+		CnArchive archive;
+		memset(&archive, 0, sizeof(archive));
+		CN_TEST_ASSERT_FALSE(cnArchive_IsOpen(&archive));
+		CN_TEST_ASSERT_TRUE(cnArchive_Find(&archive, "sprites/test_sprite.png") == NULL);
+	}
+
+	CN_TEST_UNIT("Packed entries map back") {
+		TestEntry entries[] = {
+			{ "shaders/a.vert", "void main() {}", false },
+			{ "shaders/b.frag", "out vec4 color;", false },
+			{ "fonts/c.psf2", "PSF2", false }
+		};
+		CN_TEST_ASSERT_TRUE(packArchive("test-assets-archive.cnpack", entries, CN_ARRAY_SIZE(entries)));
+
+		CnArchive archive;
+		CN_TEST_ASSERT_TRUE(cnArchive_Open(&archive, "test-assets-archive.cnpack"));
+		CN_TEST_ASSERT_TRUE(entryMatches(&archive, "shaders/a.vert", "void main() {}"));
+		CN_TEST_ASSERT_TRUE(entryMatches(&archive, "shaders/b.frag", "out vec4 color;"));
+		CN_TEST_ASSERT_TRUE(entryMatches(&archive, "fonts/c.psf2", "PSF2"));
+		CN_TEST_ASSERT_TRUE(cnArchive_Find(&archive, "shaders/missing.frag") == NULL);
+
+		// Entries start on page boundaries.
+		const CnArchiveEntry* entry = cnArchive_Find(&archive, "shaders/a.vert");
+		CN_TEST_ASSERT_EQ_U64(0, entry->offset % CN_ARCHIVE_ALIGNMENT);
+
+		cnArchive_Close(&archive);
+		remove("test-assets-archive.cnpack");
+	}
+
+	CN_TEST_UNIT("Compressed entries are inflated") {
+		const char* repetitive = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+		TestEntry entries[] = {
+			{ "shaders/a.vert", repetitive, true },
+			{ "shaders/b.frag", "out vec4 color;", false }
+		};
+		CN_TEST_ASSERT_TRUE(packArchive("test-assets-archive.cnpack", entries, CN_ARRAY_SIZE(entries)));
+
+		CnArchive archive;
+		CN_TEST_ASSERT_TRUE(cnArchive_Open(&archive, "test-assets-archive.cnpack"));
+		const CnArchiveEntry* entry = cnArchive_Find(&archive, "shaders/a.vert");
+		CN_TEST_ASSERT_TRUE(entry != NULL);
+		CN_TEST_ASSERT_TRUE(entry->storedSize < entry->size);
+
+		CnFileView view;
+		CN_TEST_ASSERT_TRUE(cnArchive_MapEntry(&archive, entry, &view));
+		CN_TEST_ASSERT_EQ_U32(CnFileViewSourceBuffer, view.source);
+		CN_TEST_ASSERT_EQ_U32(64, view.size);
+		CN_TEST_ASSERT_TRUE(memcmp(view.contents, repetitive, view.size) == 0);
+		cnDynamicBuffer_Free(&view.buffer);
+
+		CN_TEST_ASSERT_TRUE(entryMatches(&archive, "shaders/b.frag", "out vec4 color;"));
+		cnArchive_Close(&archive);
+		remove("test-assets-archive.cnpack");
+	}
+
+	CN_TEST_UNIT("Uncompressed entries with mismatched sizes are rejected") {
+		TestEntry entries[] = {
+			{ "shaders/a.vert", "void main() {}", false }
+		};
+		CN_TEST_ASSERT_TRUE(packArchive("test-assets-archive.cnpack", entries, CN_ARRAY_SIZE(entries)));
+		CN_TEST_ASSERT_TRUE(setEntrySize("test-assets-archive.cnpack", 0, 1u << 20));
+
+		CnArchive archive;
+		CN_TEST_ASSERT_FALSE(cnArchive_Open(&archive, "test-assets-archive.cnpack"));
+		CN_TEST_ASSERT_FALSE(cnArchive_IsOpen(&archive));
+		remove("test-assets-archive.cnpack");
+	}
+}
+
+CN_TEST_SUITE_END
@@ -131,4 +131,72 @@ CN_TEST_SUITE_BEGIN("atlas")
 		cnTextureAtlas_Free(&squareAtlas);
 	}
 
+	CN_TEST_UNIT("Bulk insertion matches single insertion.") {
+		CnDimension2u32 subImageSize = { .width = 2, .height = 2 };
+		CnTextureAtlas single, bulk;
+		cnTextureAtlas_Allocate(&single, subImageSize, 3);
+		cnTextureAtlas_Allocate(&bulk, subImageSize, 3);
+		memset(single.image.pixels.contents, 0, single.image.pixels.size);
+		memset(bulk.image.pixels.contents, 0, bulk.image.pixels.size);
+
+		CnImageRGBA8 subImages[3];
+		for (uint32_t i = 0; i < 3; ++i) {
+			cnImageRGBA8_AllocateSized(&subImages[i], subImageSize);
+			for (uint32_t p = 0; p < subImages[i].pixels.size; ++p) {
+				subImages[i].pixels.contents[p] = (char)(16 * i + p + 1);
+			}
+			CN_TEST_ASSERT_EQ_U32(i, cnTextureAtlas_Insert(&single, &subImages[i]));
+		}
+
+		CN_TEST_ASSERT_EQ_U32(0, cnTextureAtlas_InsertBulk(&bulk, subImages, 3));
+		CN_TEST_ASSERT_EQ_U32(3, cnTextureAtlas_UsedImages(&bulk));
+		CN_TEST_ASSERT_TRUE(memcmp(single.image.pixels.contents, bulk.image.pixels.contents,
+			bulk.image.pixels.size) == 0);
+
+		for (uint32_t i = 0; i < 3; ++i) {
+			cnImageRGBA8_Free(&subImages[i]);
+		}
+		cnTextureAtlas_Free(&single);
+		cnTextureAtlas_Free(&bulk);
+	}
+
+	CN_TEST_UNIT("Cannot reserve more images than fit in the atlas.") {
+		CnTextureAtlas atlas;
+		cnTextureAtlas_Allocate(&atlas, (CnDimension2u32) { 1, 1 }, 4);
+		CN_TEST_ASSERT_EQ_U32(0, cnTextureAtlas_Reserve(&atlas, 3));
+		CN_TEST_PRECONDITION(cnTextureAtlas_Reserve(&atlas, 2));
+		cnTextureAtlas_Free(&atlas);
+	}
+
+	CN_TEST_UNIT("Flipped sub image rows match inserting then flipping.") {
+		CnDimension2u32 subImageSize = { .width = 2, .height = 3 };
+		CnTextureAtlas inserted, direct;
+		cnTextureAtlas_Allocate(&inserted, subImageSize, 5);
+		cnTextureAtlas_Allocate(&direct, subImageSize, 5);
+		memset(inserted.image.pixels.contents, 0, inserted.image.pixels.size);
+		memset(direct.image.pixels.contents, 0, direct.image.pixels.size);
+
+		CnImageRGBA8 subImage;
+		cnImageRGBA8_AllocateSized(&subImage, subImageSize);
+		uint32_t* subImagePixels = (uint32_t*)subImage.pixels.contents;
+		for (uint32_t i = 0; i < 5; ++i) {
+			for (uint32_t y = 0; y < subImageSize.height; ++y) {
+				uint32_t* row = cnTextureAtlas_FlippedSubImageRow(&direct, i, y);
+				for (uint32_t x = 0; x < subImageSize.width; ++x) {
+					subImagePixels[y * subImageSize.width + x] = 100 * i + 10 * y + x + 1;
+					row[x] = 100 * i + 10 * y + x + 1;
+				}
+			}
+			cnTextureAtlas_Insert(&inserted, &subImage);
+		}
+		cnImageRGBA8_Flip(&inserted.image);
+
+		CN_TEST_ASSERT_TRUE(memcmp(inserted.image.pixels.contents, direct.image.pixels.contents,
+			direct.image.pixels.size) == 0);
+
+		cnImageRGBA8_Free(&subImage);
+		cnTextureAtlas_Free(&inserted);
+		cnTextureAtlas_Free(&direct);
+	}
+
 CN_TEST_SUITE_END
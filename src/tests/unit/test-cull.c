@@ -0,0 +1,50 @@
+#include <calendon/test.h>
+
+#include <calendon/cull.h>
+
+#include <math.h>
+
+#define NUM_BOUNDS 37
+
+static CnAABB2 boxAt(float x, float y, float width, float height)
+{
+	return cnAABB2_MakeMinMax(cnFloat2_Make(x, y), cnFloat2_Make(x + width, y + height));
+}
+
+CN_TEST_SUITE_BEGIN("Cull")
+	CN_TEST_UNIT("Bounds touching an edge are culled") {
+		const CnAABB2 area = boxAt(0.0f, 0.0f, 10.0f, 10.0f);
+		CN_TEST_ASSERT_TRUE(cnCull_IsVisible(area, boxAt(5.0f, 5.0f, 1.0f, 1.0f)));
+		CN_TEST_ASSERT_TRUE(cnCull_IsVisible(area, boxAt(-5.0f, -5.0f, 20.0f, 20.0f)));
+		CN_TEST_ASSERT_TRUE(cnCull_IsVisible(area, boxAt(9.5f, -1.0f, 5.0f, 2.0f)));
+		CN_TEST_ASSERT_FALSE(cnCull_IsVisible(area, boxAt(10.0f, 5.0f, 1.0f, 1.0f)));
+		CN_TEST_ASSERT_FALSE(cnCull_IsVisible(area, boxAt(5.0f, -1.0f, 1.0f, 1.0f)));
+		CN_TEST_ASSERT_FALSE(cnCull_IsVisible(area, boxAt(-3.0f, 20.0f, 1.0f, 1.0f)));
+	}
+
+	CN_TEST_UNIT("Batches match testing one at a time") {
+		const CnAABB2 area = boxAt(-8.0f, -4.0f, 16.0f, 8.0f);
+		CnAABB2 bounds[NUM_BOUNDS];
+		for (uint32_t i = 0; i < NUM_BOUNDS; ++i) {
+			const float x = (float)((int32_t)(i * 7 % 23) - 11);
+			const float y = (float)((int32_t)(i * 5 % 13) - 6);
+			bounds[i] = boxAt(x, y, (float)(i % 3), (float)(i % 4));
+		}
+		bounds[3].min.x = NAN;
+
+		for (uint32_t numBounds = 0; numBounds <= NUM_BOUNDS; ++numBounds) {
+			uint32_t visible[NUM_BOUNDS];
+			const uint32_t numVisible = cnCull_AABB2s(area, bounds, numBounds, visible);
+
+			uint32_t expected = 0;
+			for (uint32_t i = 0; i < numBounds; ++i) {
+				if (cnCull_IsVisible(area, bounds[i])) {
+					CN_TEST_ASSERT_EQ_U32(i, visible[expected]);
+					++expected;
+				}
+			}
+			CN_TEST_ASSERT_EQ_U32(expected, numVisible);
+		}
+		CN_TEST_ASSERT_FALSE(cnCull_IsVisible(area, bounds[3]));
+	}
+CN_TEST_SUITE_END
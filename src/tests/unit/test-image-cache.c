@@ -0,0 +1,107 @@
+#include <calendon/test.h>
+
+#include <calendon/assets-archive.h>
+#include <calendon/image-cache.h>
+
+#include <stdio.h>
+
+#ifdef _WIN32
+	#include <direct.h>
+	#define rmdir _rmdir
+#else
+	#include <unistd.h>
+#endif
+
+static bool writeSource(const char* path, const char* contents)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file) {
+		return false;
+	}
+	fputs(contents, file);
+	fclose(file);
+	return true;
+}
+
+/**
+ * Deletes the cache entry for an image, so the cache directory can be removed.
+ */
+static void removeEntry(const char* name)
+{
+	CnPathBuffer path;
+	if (cnImageCache_EntryPath(cnArchive_HashName(name), "rgba8", &path)) {
+		remove(path.str);
+	}
+}
+
+CN_TEST_SUITE_BEGIN("Image Cache") {
+	CN_TEST_UNIT("Closed caches miss") {
+		CnCachedImage cached;
+		CN_TEST_ASSERT_FALSE(cnImageCache_IsOpen());
+		CN_TEST_ASSERT_FALSE(cnImageCache_Map(&cached, "sprites/missing.png", "missing.png"));
+	}
+
+	CN_TEST_UNIT("Stored images map back") {
+		CN_TEST_ASSERT_TRUE(cnImageCache_Open("image-cache-test"));
+		CN_TEST_ASSERT_TRUE(writeSource("test-image-cache-source.png", "source"));
+
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 2, 3 });
+		for (uint32_t i = 0; i < image.pixels.size; ++i) {
+			image.pixels.contents[i] = (char)i;
+		}
+		CN_TEST_ASSERT_TRUE(cnImageCache_Store(&image, NULL, 1, "sprites/source.png", "test-image-cache-source.png"));
+
+		CnCachedImage cached;
+		CN_TEST_ASSERT_TRUE(cnImageCache_Map(&cached, "sprites/source.png", "test-image-cache-source.png"));
+		CN_TEST_ASSERT_EQ_U32(2, cached.width);
+		CN_TEST_ASSERT_EQ_U32(3, cached.height);
+		CN_TEST_ASSERT_EQ_U32(1, cached.numLevels);
+		CN_TEST_ASSERT_TRUE(cached.mips == NULL);
+		CN_TEST_ASSERT_TRUE(memcmp(cached.pixels, image.pixels.contents, image.pixels.size) == 0);
+		cnImageCache_Release(&cached);
+
+		// Changing the source invalidates the cached entry.
+		CN_TEST_ASSERT_TRUE(writeSource("test-image-cache-source.png", "changed source"));
+		CN_TEST_ASSERT_FALSE(cnImageCache_Map(&cached, "sprites/source.png", "test-image-cache-source.png"));
+
+		cnImageRGBA8_Free(&image);
+		removeEntry("sprites/source.png");
+		cnImageCache_Close();
+		remove("test-image-cache-source.png");
+	}
+
+	CN_TEST_UNIT("Stored mip chains map back") {
+		CN_TEST_ASSERT_TRUE(cnImageCache_Open("image-cache-test"));
+		CN_TEST_ASSERT_TRUE(writeSource("test-image-cache-mips.png", "source"));
+
+		const CnDimension2u32 size = { 4, 2 };
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, size);
+		for (uint32_t i = 0; i < image.pixels.size; ++i) {
+			image.pixels.contents[i] = (char)(i * 3);
+		}
+		const uint32_t numLevels = cnImageMips_NumLevels(size);
+		uint8_t mips[4 * (2 + 1)];
+		CN_TEST_ASSERT_EQ_U32((uint32_t)sizeof(mips), cnImageMips_TailSize(size, numLevels));
+		cnImageMips_Build(mips, (const uint8_t*)image.pixels.contents, size, numLevels);
+		CN_TEST_ASSERT_TRUE(cnImageCache_Store(&image, mips, numLevels, "sprites/mips.png",
+			"test-image-cache-mips.png"));
+
+		CnCachedImage cached;
+		CN_TEST_ASSERT_TRUE(cnImageCache_Map(&cached, "sprites/mips.png", "test-image-cache-mips.png"));
+		CN_TEST_ASSERT_EQ_U32(numLevels, cached.numLevels);
+		CN_TEST_ASSERT_TRUE(memcmp(cached.pixels, image.pixels.contents, image.pixels.size) == 0);
+		CN_TEST_ASSERT_TRUE(memcmp(cached.mips, mips, sizeof(mips)) == 0);
+		cnImageCache_Release(&cached);
+
+		cnImageRGBA8_Free(&image);
+		removeEntry("sprites/mips.png");
+		cnImageCache_Close();
+		remove("test-image-cache-mips.png");
+		rmdir("image-cache-test");
+		CN_TEST_ASSERT_FALSE(cnPath_IsDir("image-cache-test"));
+	}
+}
+
+CN_TEST_SUITE_END
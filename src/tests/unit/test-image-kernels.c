@@ -0,0 +1,208 @@
+#include <calendon/test.h>
+
+#include <calendon/image-kernels.h>
+
+static const CnImageKernelLevel levels[] = {
+	CnImageKernelLevelScalar,
+	CnImageKernelLevelSSE2,
+	CnImageKernelLevelAVX2
+};
+
+static void fillPattern(CnImageRGBA8* image, uint32_t seed)
+{
+	for (uint32_t i = 0; i < image->pixels.size; ++i) {
+		image->pixels.contents[i] = (char)((i * 37 + seed * 11 + (i >> 3)) & 0xFF);
+	}
+}
+
+static bool sameImage(const CnImageRGBA8* a, const CnImageRGBA8* b)
+{
+	return a->width == b->width && a->height == b->height
+		&& memcmp(a->pixels.contents, b->pixels.contents, a->pixels.size) == 0;
+}
+
+static const uint8_t* pixelAt(const CnImageRGBA8* image, uint32_t x, uint32_t y)
+{
+	return (const uint8_t*)image->pixels.contents + 4 * (y * image->width + x);
+}
+
+CN_TEST_SUITE_BEGIN("image kernels")
+	CN_TEST_UNIT("Clear fills every pixel in RGBA order") {
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(levels); ++i) {
+			cnImageKernels_SetMaxLevel(levels[i]);
+			CnImageRGBA8 image;
+			cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 13, 3 });
+			cnImageRGBA8_ClearRGBA(&image, 1, 2, 3, 4);
+			for (uint32_t p = 0; p < image.width * image.height; ++p) {
+				const uint8_t* pixel = (const uint8_t*)image.pixels.contents + 4 * p;
+				CN_TEST_ASSERT_EQ_U32(1, pixel[0]);
+				CN_TEST_ASSERT_EQ_U32(2, pixel[1]);
+				CN_TEST_ASSERT_EQ_U32(3, pixel[2]);
+				CN_TEST_ASSERT_EQ_U32(4, pixel[3]);
+			}
+			cnImageRGBA8_Free(&image);
+		}
+		cnImageKernels_SetMaxLevel(CnImageKernelLevelAVX2);
+	}
+
+	CN_TEST_UNIT("Flip reverses rows in place") {
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(levels); ++i) {
+			cnImageKernels_SetMaxLevel(levels[i]);
+			CnImageRGBA8 image, original;
+			cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 11, 5 });
+			cnImageRGBA8_AllocateSized(&original, (CnDimension2u32) { 11, 5 });
+			fillPattern(&image, 1);
+			fillPattern(&original, 1);
+
+			cnImageRGBA8_Flip(&image);
+			for (uint32_t y = 0; y < image.height; ++y) {
+				CN_TEST_ASSERT_TRUE(memcmp(pixelAt(&image, 0, y), pixelAt(&original, 0, image.height - y - 1),
+					4 * image.width) == 0);
+			}
+			cnImageRGBA8_Free(&image);
+			cnImageRGBA8_Free(&original);
+		}
+		cnImageKernels_SetMaxLevel(CnImageKernelLevelAVX2);
+	}
+
+	CN_TEST_UNIT("Blit copies a sub rectangle") {
+		CnImageRGBA8 src, dest;
+		cnImageRGBA8_AllocateSized(&src, (CnDimension2u32) { 6, 4 });
+		cnImageRGBA8_AllocateSized(&dest, (CnDimension2u32) { 5, 5 });
+		fillPattern(&src, 2);
+		cnImageRGBA8_ClearRGBA(&dest, 0, 0, 0, 0);
+
+		cnImageRGBA8_Blit(&dest, (CnRowColu32) { .row = 2, .col = 1 }, &src, (CnRowColu32) { .row = 1, .col = 3 },
+			(CnDimension2u32) { 3, 2 });
+		for (uint32_t y = 0; y < dest.height; ++y) {
+			for (uint32_t x = 0; x < dest.width; ++x) {
+				const bool inside = x >= 1 && x < 4 && y >= 2 && y < 4;
+				if (inside) {
+					CN_TEST_ASSERT_TRUE(memcmp(pixelAt(&dest, x, y), pixelAt(&src, x + 2, y - 1), 4) == 0);
+				}
+				else {
+					uint32_t value;
+					memcpy(&value, pixelAt(&dest, x, y), 4);
+					CN_TEST_ASSERT_EQ_U32(0, value);
+				}
+			}
+		}
+		cnImageRGBA8_Free(&src);
+		cnImageRGBA8_Free(&dest);
+	}
+
+	CN_TEST_UNIT("Premultiply scales color by alpha") {
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 1, 1 });
+		cnImageRGBA8_ClearRGBA(&image, 255, 128, 0, 128);
+		cnImageRGBA8_Premultiply(&image);
+		const uint8_t* pixel = pixelAt(&image, 0, 0);
+		CN_TEST_ASSERT_EQ_U32(128, pixel[0]);
+		CN_TEST_ASSERT_EQ_U32(64, pixel[1]);
+		CN_TEST_ASSERT_EQ_U32(0, pixel[2]);
+		CN_TEST_ASSERT_EQ_U32(128, pixel[3]);
+		cnImageRGBA8_Free(&image);
+	}
+
+	CN_TEST_UNIT("Swizzle reorders channels") {
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 1, 1 });
+		cnImageRGBA8_ClearRGBA(&image, 1, 2, 3, 4);
+		const uint8_t toBGRA[4] = { 2, 1, 0, 3 };
+		cnImageRGBA8_Swizzle(&image, toBGRA);
+		const uint8_t* pixel = pixelAt(&image, 0, 0);
+		CN_TEST_ASSERT_EQ_U32(3, pixel[0]);
+		CN_TEST_ASSERT_EQ_U32(2, pixel[1]);
+		CN_TEST_ASSERT_EQ_U32(1, pixel[2]);
+		CN_TEST_ASSERT_EQ_U32(4, pixel[3]);
+		cnImageRGBA8_Free(&image);
+	}
+
+	CN_TEST_UNIT("Downsample averages 2x2 blocks") {
+		CnImageRGBA8 src, dest;
+		cnImageRGBA8_AllocateSized(&src, (CnDimension2u32) { 2, 2 });
+		cnImageRGBA8_AllocateSized(&dest, (CnDimension2u32) { 1, 1 });
+		const uint8_t values[16] = { 0, 10, 255, 1, 1, 20, 255, 2, 2, 30, 255, 3, 3, 40, 254, 4 };
+		memcpy(src.pixels.contents, values, sizeof(values));
+		cnImageRGBA8_Downsample(&dest, &src);
+		const uint8_t* pixel = pixelAt(&dest, 0, 0);
+		CN_TEST_ASSERT_EQ_U32(2, pixel[0]);
+		CN_TEST_ASSERT_EQ_U32(25, pixel[1]);
+		CN_TEST_ASSERT_EQ_U32(255, pixel[2]);
+		CN_TEST_ASSERT_EQ_U32(3, pixel[3]);
+		cnImageRGBA8_Free(&src);
+		cnImageRGBA8_Free(&dest);
+	}
+
+	CN_TEST_UNIT("Resizing to the same size is a copy") {
+		CnImageRGBA8 src, dest;
+		cnImageRGBA8_AllocateSized(&src, (CnDimension2u32) { 9, 7 });
+		cnImageRGBA8_AllocateSized(&dest, (CnDimension2u32) { 9, 7 });
+		fillPattern(&src, 3);
+		cnImageRGBA8_Resize(&dest, &src, CnImageFilterNearest);
+		CN_TEST_ASSERT_TRUE(sameImage(&src, &dest));
+		cnImageRGBA8_ClearRGBA(&dest, 0, 0, 0, 0);
+		cnImageRGBA8_Resize(&dest, &src, CnImageFilterBilinear);
+		CN_TEST_ASSERT_TRUE(sameImage(&src, &dest));
+		cnImageRGBA8_Free(&src);
+		cnImageRGBA8_Free(&dest);
+	}
+
+	CN_TEST_UNIT("Every kernel level matches scalar") {
+		const CnDimension2u32 size = { 37, 19 };
+		const CnDimension2u32 halfSize = { 18, 9 };
+		const CnDimension2u32 resized = { 53, 11 };
+		CnImageRGBA8 src, expected, actual, expectedHalf, actualHalf, expectedResized, actualResized;
+		cnImageRGBA8_AllocateSized(&src, size);
+		cnImageRGBA8_AllocateSized(&expected, size);
+		cnImageRGBA8_AllocateSized(&actual, size);
+		cnImageRGBA8_AllocateSized(&expectedHalf, halfSize);
+		cnImageRGBA8_AllocateSized(&actualHalf, halfSize);
+		cnImageRGBA8_AllocateSized(&expectedResized, resized);
+		cnImageRGBA8_AllocateSized(&actualResized, resized);
+		fillPattern(&src, 4);
+		const uint8_t order[4] = { 3, 0, 2, 1 };
+
+		for (uint32_t i = 1; i < CN_ARRAY_SIZE(levels); ++i) {
+			cnImageKernels_SetMaxLevel(CnImageKernelLevelScalar);
+			memcpy(expected.pixels.contents, src.pixels.contents, src.pixels.size);
+			cnImageRGBA8_Premultiply(&expected);
+			cnImageKernels_SetMaxLevel(levels[i]);
+			memcpy(actual.pixels.contents, src.pixels.contents, src.pixels.size);
+			cnImageRGBA8_Premultiply(&actual);
+			CN_TEST_ASSERT_TRUE(sameImage(&expected, &actual));
+
+			cnImageKernels_SetMaxLevel(CnImageKernelLevelScalar);
+			memcpy(expected.pixels.contents, src.pixels.contents, src.pixels.size);
+			cnImageRGBA8_Swizzle(&expected, order);
+			cnImageKernels_SetMaxLevel(levels[i]);
+			memcpy(actual.pixels.contents, src.pixels.contents, src.pixels.size);
+			cnImageRGBA8_Swizzle(&actual, order);
+			CN_TEST_ASSERT_TRUE(sameImage(&expected, &actual));
+
+			cnImageKernels_SetMaxLevel(CnImageKernelLevelScalar);
+			cnImageRGBA8_Downsample(&expectedHalf, &src);
+			cnImageKernels_SetMaxLevel(levels[i]);
+			cnImageRGBA8_Downsample(&actualHalf, &src);
+			CN_TEST_ASSERT_TRUE(sameImage(&expectedHalf, &actualHalf));
+
+			for (uint32_t filter = CnImageFilterNearest; filter <= CnImageFilterBilinear; ++filter) {
+				cnImageKernels_SetMaxLevel(CnImageKernelLevelScalar);
+				cnImageRGBA8_Resize(&expectedResized, &src, (CnImageFilter)filter);
+				cnImageKernels_SetMaxLevel(levels[i]);
+				cnImageRGBA8_Resize(&actualResized, &src, (CnImageFilter)filter);
+				CN_TEST_ASSERT_TRUE(sameImage(&expectedResized, &actualResized));
+			}
+		}
+		cnImageKernels_SetMaxLevel(CnImageKernelLevelAVX2);
+
+		cnImageRGBA8_Free(&src);
+		cnImageRGBA8_Free(&expected);
+		cnImageRGBA8_Free(&actual);
+		cnImageRGBA8_Free(&expectedHalf);
+		cnImageRGBA8_Free(&actualHalf);
+		cnImageRGBA8_Free(&expectedResized);
+		cnImageRGBA8_Free(&actualResized);
+	}
+
+CN_TEST_SUITE_END
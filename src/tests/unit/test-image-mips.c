@@ -0,0 +1,49 @@
+#include <calendon/test.h>
+
+#include <calendon/image-mips.h>
+
+CN_TEST_SUITE_BEGIN("image mips")
+	CN_TEST_UNIT("Chains go down to 1x1") {
+		CN_TEST_ASSERT_EQ_U32(1, cnImageMips_NumLevels((CnDimension2u32) { 1, 1 }));
+		CN_TEST_ASSERT_EQ_U32(2, cnImageMips_NumLevels((CnDimension2u32) { 2, 1 }));
+		CN_TEST_ASSERT_EQ_U32(3, cnImageMips_NumLevels((CnDimension2u32) { 5, 3 }));
+		CN_TEST_ASSERT_EQ_U32(11, cnImageMips_NumLevels((CnDimension2u32) { 1024, 16 }));
+	}
+
+	CN_TEST_UNIT("Level sizes halve and clamp to 1") {
+		const CnDimension2u32 size = { 5, 3 };
+		CnDimension2u32 level = cnImageMips_LevelSize(size, 1);
+		CN_TEST_ASSERT_EQ_U32(2, level.width);
+		CN_TEST_ASSERT_EQ_U32(1, level.height);
+		level = cnImageMips_LevelSize(size, 2);
+		CN_TEST_ASSERT_EQ_U32(1, level.width);
+		CN_TEST_ASSERT_EQ_U32(1, level.height);
+
+		CN_TEST_ASSERT_EQ_U32(0, cnImageMips_TailOffset(size, 1));
+		CN_TEST_ASSERT_EQ_U32(8, cnImageMips_TailOffset(size, 2));
+		CN_TEST_ASSERT_EQ_U32(12, cnImageMips_TailSize(size, 3));
+		CN_TEST_ASSERT_EQ_U32(0, cnImageMips_TailSize(size, 1));
+	}
+
+	CN_TEST_UNIT("Each level averages the one before it") {
+		// A 4x2 image whose red channel is 0, 4, 8, ... 28.
+		uint8_t pixels[4 * 4 * 2] = { 0 };
+		for (uint32_t i = 0; i < 8; ++i) {
+			pixels[4 * i] = (uint8_t)(4 * i);
+			pixels[4 * i + 3] = 255;
+		}
+
+		const CnDimension2u32 size = { 4, 2 };
+		uint8_t tail[4 * (2 + 1)];
+		cnImageMips_Build(tail, pixels, size, cnImageMips_NumLevels(size));
+
+		// Level 1 is 2x1: averages of {0, 4, 16, 20} and {8, 12, 24, 28}.
+		CN_TEST_ASSERT_EQ_U32(10, tail[0]);
+		CN_TEST_ASSERT_EQ_U32(18, tail[4]);
+		CN_TEST_ASSERT_EQ_U32(255, tail[3]);
+
+		// Level 2 is 1x1, the average of level 1.
+		CN_TEST_ASSERT_EQ_U32(14, tail[8]);
+		CN_TEST_ASSERT_EQ_U32(255, tail[11]);
+	}
+CN_TEST_SUITE_END
@@ -3,6 +3,68 @@
 #include <calendon/cn.h>
 #include <calendon/image.h>
 
+#include <stdio.h>
+
+// 5x4 RGBA8 PNGs where the pixel at (x, y), with y=0 as the top row, is
+// { 40x, 60y, 10(x + y), 255 - x - y }.
+static const uint8_t plainPng[] = {
+	0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+	0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x04,
+	0x08, 0x06, 0x00, 0x00, 0x00, 0x46, 0x33, 0xf5, 0x40, 0x00, 0x00, 0x00,
+	0x4d, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x05, 0xc1, 0xa1, 0x01, 0xc0,
+	0x20, 0x0c, 0x04, 0xc0, 0xd7, 0x68, 0x74, 0x74, 0x34, 0x3a, 0xba, 0x3a,
+	0xe3, 0xfc, 0x38, 0x19, 0x22, 0xc3, 0x15, 0x08, 0xb4, 0x77, 0x00, 0xf0,
+	0x29, 0xda, 0x75, 0xf4, 0x43, 0x48, 0x05, 0x74, 0x03, 0xd6, 0xae, 0x5a,
+	0x3f, 0x6e, 0x52, 0x34, 0xdd, 0x61, 0x63, 0x01, 0xec, 0x47, 0x29, 0xe5,
+	0xd4, 0x4d, 0x8e, 0x15, 0xb4, 0x09, 0xa4, 0x94, 0xa6, 0x6e, 0xcf, 0xb1,
+	0x98, 0x36, 0x23, 0x9f, 0xf7, 0x07, 0x1c, 0x6f, 0x23, 0xab, 0x9e, 0x1c,
+	0x5e, 0xa4, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42,
+	0x60, 0x82,
+};
+
+// The same image, Adam7 interlaced.
+static const uint8_t interlacedPng[] = {
+	0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+	0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x04,
+	0x08, 0x06, 0x00, 0x00, 0x01, 0x31, 0x34, 0xc5, 0xd6, 0x00, 0x00, 0x00,
+	0x4f, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x15, 0xca, 0xab, 0x15, 0x80,
+	0x30, 0x10, 0x45, 0xc1, 0xab, 0xa3, 0xd1, 0xd1, 0xab, 0xa3, 0x57, 0xa3,
+	0x53, 0xce, 0x2b, 0x27, 0x45, 0x6c, 0x71, 0x40, 0x3e, 0x10, 0xec, 0x9c,
+	0x01, 0x78, 0x69, 0x58, 0xa7, 0x72, 0x4c, 0xd0, 0x31, 0xab, 0xac, 0x37,
+	0xf9, 0x8d, 0x91, 0x96, 0xc8, 0x03, 0x53, 0x1e, 0x52, 0x79, 0xc0, 0xd3,
+	0x32, 0xdf, 0xc5, 0x37, 0xf8, 0x6e, 0xfe, 0x63, 0xe4, 0x61, 0x61, 0xbd,
+	0x46, 0x79, 0x14, 0x7e, 0xb7, 0x38, 0xaf, 0x0f, 0x66, 0x69, 0x23, 0xab,
+	0x3b, 0xa2, 0x96, 0x78, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44,
+	0xae, 0x42, 0x60, 0x82,
+};
+
+static bool writePng(const char* path, const uint8_t* contents, size_t size)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file) {
+		return false;
+	}
+	const bool written = fwrite(contents, 1, size, file) == size;
+	fclose(file);
+	return written;
+}
+
+static bool pixelsAreFlipped(const CnImageRGBA8* image)
+{
+	for (uint32_t y = 0; y < image->height; ++y) {
+		for (uint32_t x = 0; x < image->width; ++x) {
+			const uint8_t* pixel = (const uint8_t*)image->pixels.contents
+				+ 4 * ((image->height - y - 1) * image->width + x);
+			if (pixel[0] != 40 * x || pixel[1] != 60 * y || pixel[2] != 10 * (x + y)
+				|| pixel[3] != 255 - x - y)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 CN_TEST_SUITE_BEGIN("image")
 	CN_TEST_UNIT("Cannot create inappropriate texture atlases.") {
 		CnImageRGBA8 image;
@@ -10,4 +72,38 @@ CN_TEST_SUITE_BEGIN("image")
 		cnImageRGBA8_GetPixelRowCol(&image, (CnRowColu32) { .row = 0, .col = 0 });
 	}
 
+	CN_TEST_UNIT("PNG rows decode bottom-up") {
+		CN_TEST_ASSERT_TRUE(writePng("test-image-plain.png", plainPng, sizeof(plainPng)));
+
+		CnImageRGBA8 image;
+		CN_TEST_ASSERT_TRUE(cnImageRGBA8_Allocate(&image, "test-image-plain.png"));
+		CN_TEST_ASSERT_EQ_U32(5, image.width);
+		CN_TEST_ASSERT_EQ_U32(4, image.height);
+		CN_TEST_ASSERT_EQ_U32(5 * 4 * 4, image.pixels.size);
+		CN_TEST_ASSERT_TRUE(pixelsAreFlipped(&image));
+		cnImageRGBA8_Free(&image);
+		remove("test-image-plain.png");
+	}
+
+	CN_TEST_UNIT("Interlaced PNG rows decode bottom-up") {
+		CN_TEST_ASSERT_TRUE(writePng("test-image-interlaced.png", interlacedPng, sizeof(interlacedPng)));
+
+		CnImageRGBA8 image;
+		CN_TEST_ASSERT_TRUE(cnImageRGBA8_Allocate(&image, "test-image-interlaced.png"));
+		CN_TEST_ASSERT_TRUE(pixelsAreFlipped(&image));
+		cnImageRGBA8_Free(&image);
+		remove("test-image-interlaced.png");
+	}
+
+	CN_TEST_UNIT("PNG decoding rejects small buffers") {
+		CN_TEST_ASSERT_TRUE(writePng("test-image-small.png", plainPng, sizeof(plainPng)));
+
+		CnImageDecoder decoder;
+		CN_TEST_ASSERT_TRUE(cnImageDecoder_Open(&decoder, "test-image-small.png"));
+		uint8_t pixels[4 * 5 * 3];
+		CN_TEST_ASSERT_FALSE(cnImageDecoder_DecodeRGBA8(&decoder, pixels, sizeof(pixels)));
+		cnImageDecoder_Close(&decoder);
+		remove("test-image-small.png");
+	}
+
 CN_TEST_SUITE_END
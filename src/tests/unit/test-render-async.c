@@ -0,0 +1,83 @@
+#include <calendon/test.h>
+
+#include <calendon/compat-sdl.h>
+#include <calendon/log.h>
+#include <calendon/render-async.h>
+
+#include <signal.h>
+#include <stdio.h>
+
+static CnLoadId loadedId;
+static CnLoadStatus loadedStatus;
+static uint32_t numLoaded;
+
+static void onLoaded(CnLoadId load, CnLoadStatus status, void* userData)
+{
+	CN_UNUSED(userData);
+	loadedId = load;
+	loadedStatus = status;
+	++numLoaded;
+}
+
+static bool writeFile(const char* path, const char* contents)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file) {
+		return false;
+	}
+	fputs(contents, file);
+	fclose(file);
+	return true;
+}
+
+/**
+ * Decoding happens on workers, so drain until the load finishes or it's
+ * clear it never will.
+ */
+static CnLoadStatus drainUntilDone(CnLoadId load)
+{
+	for (uint32_t i = 0; i < 1000 && cnRAsync_Status(load) == CnLoadStatusPending; ++i) {
+		cnRAsync_DrainUploads();
+		SDL_Delay(1);
+	}
+	return cnRAsync_Status(load);
+}
+
+CN_TEST_SUITE_BEGIN("Render async")
+	// Failed loads are logged as errors, which break into the debugger in debug
+	// builds.
+	signal(SIGTRAP, SIG_IGN);
+	cnLog_PreInit();
+	cnRAsync_Init();
+
+	CN_TEST_UNIT("Missing files aren't queued") {
+		numLoaded = 0;
+		CN_TEST_ASSERT_EQ_U32(0, cnRAsync_QueueFont(1, "test-render-async-missing.psf2", onLoaded, NULL));
+		CN_TEST_ASSERT_EQ_U32(0, numLoaded);
+	}
+
+	CN_TEST_UNIT("Fonts which fail to decode fail their load") {
+		CN_TEST_ASSERT_TRUE(writeFile("test-render-async-bad.psf2",
+			"This is not a PSF2 font, but is long enough to have a header."));
+		numLoaded = 0;
+
+		const CnLoadId load = cnRAsync_QueueFont(2, "test-render-async-bad.psf2", onLoaded, NULL);
+		CN_TEST_ASSERT_TRUE(load != 0);
+		CN_TEST_ASSERT_EQ_U32(CnLoadStatusPending, cnRAsync_Status(load));
+
+		CN_TEST_ASSERT_EQ_U32(CnLoadStatusFailed, drainUntilDone(load));
+		CN_TEST_ASSERT_EQ_U32(1, numLoaded);
+		CN_TEST_ASSERT_EQ_U32(load, loadedId);
+		CN_TEST_ASSERT_EQ_U32(CnLoadStatusFailed, loadedStatus);
+
+		// Failed loads can be retried.
+		const CnLoadId retry = cnRAsync_QueueFont(2, "test-render-async-bad.psf2", NULL, NULL);
+		CN_TEST_ASSERT_EQ_U32(load, retry);
+		CN_TEST_ASSERT_EQ_U32(CnLoadStatusFailed, drainUntilDone(retry));
+		CN_TEST_ASSERT_EQ_U32(1, numLoaded);
+
+		remove("test-render-async-bad.psf2");
+	}
+
+	cnRAsync_Shutdown();
+CN_TEST_SUITE_END
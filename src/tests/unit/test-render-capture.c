@@ -0,0 +1,71 @@
+#include <calendon/test.h>
+
+#include <calendon/render-capture.h>
+
+static uint8_t encoded[512];
+
+static void fill(CnImageRGBA8* image, const uint8_t* rgba, uint32_t numPixels)
+{
+	memcpy(image->pixels.contents, rgba, 4 * numPixels);
+}
+
+CN_TEST_SUITE_BEGIN("Render capture")
+	CN_TEST_UNIT("QOI header and end marker") {
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 2, 1 });
+		const uint8_t pixels[] = { 10, 20, 30, 255, 10, 20, 30, 255 };
+		fill(&image, pixels, 2);
+
+		const size_t size = cnRCapture_EncodeQOI(&image, encoded);
+		CN_TEST_ASSERT_TRUE(size <= cnRCapture_MaxQOISize((CnDimension2u32) { 2, 1 }));
+
+		// An RGB op for the first pixel and a run of one for the second.
+		CN_TEST_ASSERT_EQ_SIZE_T(14 + 4 + 1 + 8, size);
+		CN_TEST_ASSERT_TRUE(memcmp(encoded, "qoif", 4) == 0);
+		CN_TEST_ASSERT_EQ_U8(2, encoded[7]);
+		CN_TEST_ASSERT_EQ_U8(1, encoded[11]);
+		CN_TEST_ASSERT_EQ_U8(4, encoded[12]);
+		CN_TEST_ASSERT_EQ_U8(0xFE, encoded[14]);
+		CN_TEST_ASSERT_EQ_U8(10, encoded[15]);
+		CN_TEST_ASSERT_EQ_U8(0xC0, encoded[18]);
+		CN_TEST_ASSERT_EQ_U8(0, encoded[19]);
+		CN_TEST_ASSERT_EQ_U8(1, encoded[26]);
+		cnImageRGBA8_Free(&image);
+	}
+
+	CN_TEST_UNIT("QOI picks the smallest op for each pixel") {
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 5, 1 });
+		const uint8_t pixels[] = {
+			1, 1, 0, 255,     // diff from the initial black
+			11, 11, 5, 255,   // luma, green moved by 10
+			11, 11, 5, 128,   // alpha changed
+			1, 1, 0, 255,     // seen before
+			1, 1, 0, 255      // run
+		};
+		fill(&image, pixels, 5);
+
+		const size_t size = cnRCapture_EncodeQOI(&image, encoded);
+		CN_TEST_ASSERT_EQ_SIZE_T(14 + 1 + 2 + 5 + 1 + 1 + 8, size);
+		CN_TEST_ASSERT_EQ_U8(0x40 | 3 << 4 | 3 << 2 | 2, encoded[14]);
+		CN_TEST_ASSERT_EQ_U8(0x80 | (10 + 32), encoded[15]);
+		CN_TEST_ASSERT_EQ_U8((0 + 8) << 4 | (-5 + 8), encoded[16]);
+		CN_TEST_ASSERT_EQ_U8(0xFF, encoded[17]);
+		CN_TEST_ASSERT_EQ_U8(128, encoded[21]);
+		CN_TEST_ASSERT_EQ_U8((1 * 3 + 1 * 5 + 0 * 7 + 255 * 11) % 64, encoded[22]);
+		CN_TEST_ASSERT_EQ_U8(0xC0, encoded[23]);
+		cnImageRGBA8_Free(&image);
+	}
+
+	CN_TEST_UNIT("QOI runs are split at 62 pixels") {
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 63, 1 });
+		cnImageRGBA8_ClearRGBA(&image, 0, 0, 0, 255);
+
+		const size_t size = cnRCapture_EncodeQOI(&image, encoded);
+		CN_TEST_ASSERT_EQ_SIZE_T(14 + 2 + 8, size);
+		CN_TEST_ASSERT_EQ_U8(0xC0 | 61, encoded[14]);
+		CN_TEST_ASSERT_EQ_U8(0xC0, encoded[15]);
+		cnImageRGBA8_Free(&image);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,95 @@
+#include <calendon/test.h>
+
+#include <calendon/render-commands.h>
+
+static uint32_t calls[1000];
+static uint32_t numCalls;
+
+static void recordCall(void* data)
+{
+	calls[numCalls++] = (uint32_t)(uintptr_t)data;
+}
+
+CN_TEST_SUITE_BEGIN("Render commands")
+	CN_TEST_UNIT("Replay runs commands in recorded order") {
+		CnRCommandList list;
+		cnRCommandList_Init(&list);
+		numCalls = 0;
+
+		// Grows past the initial capacity.
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(calls); ++i) {
+			cnRCommands_Invoke(&list, recordCall, (void*)(uintptr_t)i);
+		}
+		CN_TEST_ASSERT_EQ_U32(CN_ARRAY_SIZE(calls), list.numCommands);
+
+		cnRCommandList_Replay(&list);
+		CN_TEST_ASSERT_EQ_U32(CN_ARRAY_SIZE(calls), numCalls);
+		for (uint32_t i = 0; i < numCalls; ++i) {
+			CN_TEST_ASSERT_EQ_U32(i, calls[i]);
+		}
+		cnRCommandList_Free(&list);
+	}
+
+	CN_TEST_UNIT("Clearing keeps storage") {
+		CnRCommandList list;
+		cnRCommandList_Init(&list);
+		numCalls = 0;
+
+		cnRCommands_Invoke(&list, recordCall, NULL);
+		cnRCommandList_AddData(&list, "text", 5);
+		const uint32_t commandCapacity = list.commandCapacity;
+		const uint32_t dataCapacity = list.dataCapacity;
+
+		cnRCommandList_Clear(&list);
+		CN_TEST_ASSERT_EQ_U32(0, list.numCommands);
+		CN_TEST_ASSERT_EQ_U32(0, list.dataSize);
+		CN_TEST_ASSERT_EQ_U32(commandCapacity, list.commandCapacity);
+		CN_TEST_ASSERT_EQ_U32(dataCapacity, list.dataCapacity);
+
+		cnRCommandList_Replay(&list);
+		CN_TEST_ASSERT_EQ_U32(0, numCalls);
+		cnRCommandList_Free(&list);
+	}
+
+	CN_TEST_UNIT("Text and points are copied") {
+		CnRCommandList list;
+		cnRCommandList_Init(&list);
+
+		char text[] = "Hello";
+		const CnTextDrawParams params = { 0 };
+		cnRCommands_DrawSimpleText(&list, 1, &params, text);
+		text[0] = 'J';
+
+		CnFloat2 points[3] = { { 1.0f, 2.0f }, { 3.0f, 4.0f }, { 5.0f, 6.0f } };
+		const CnOpaqueColor white = { 1.0f, 1.0f, 1.0f };
+		cnRCommands_DrawDebugLineStrip(&list, points, 3, white);
+		points[2].x = 0.0f;
+
+		CN_TEST_ASSERT_EQ_U32(2, list.numCommands);
+		const CnRCommand* textCommand = &list.commands[0];
+		CN_TEST_ASSERT_EQ_STR("Hello", list.data + textCommand->args.text.offset);
+
+		const CnRCommand* stripCommand = &list.commands[1];
+		CN_TEST_ASSERT_EQ_U32(3, stripCommand->args.lineStrip.numPoints);
+		CN_TEST_ASSERT_EQ_U32(0, stripCommand->args.lineStrip.offset % 8);
+		const CnFloat2* copied = (const CnFloat2*)(list.data + stripCommand->args.lineStrip.offset);
+		CN_TEST_ASSERT_EXACT_F(5.0f, copied[2].x);
+		CN_TEST_ASSERT_EXACT_F(6.0f, copied[2].y);
+		cnRCommandList_Free(&list);
+	}
+
+	CN_TEST_UNIT("Data grows past its initial capacity") {
+		CnRCommandList list;
+		cnRCommandList_Init(&list);
+
+		uint8_t block[1000];
+		for (uint32_t i = 0; i < 20; ++i) {
+			memset(block, (int)i, sizeof(block));
+			const uint32_t offset = cnRCommandList_AddData(&list, block, sizeof(block));
+			CN_TEST_ASSERT_EQ_U32(0, offset % 8);
+		}
+		CN_TEST_ASSERT_TRUE(list.dataCapacity >= list.dataSize);
+		CN_TEST_ASSERT_EQ_U8(19, (uint8_t)list.data[list.dataSize - 1]);
+		cnRCommandList_Free(&list);
+	}
+CN_TEST_SUITE_END
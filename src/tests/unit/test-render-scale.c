@@ -0,0 +1,60 @@
+#include <calendon/test.h>
+
+#include <calendon/render-scale.h>
+
+static void addFrames(CnRenderScale* rs, uint64_t micros, uint32_t numFrames)
+{
+	for (uint32_t i = 0; i < numFrames; ++i) {
+		cnRenderScale_AddFrame(rs, micros);
+	}
+}
+
+CN_TEST_SUITE_BEGIN("Render scale")
+	CN_TEST_UNIT("No budget stays at full resolution") {
+		CnRenderScale rs;
+		cnRenderScale_Init(&rs, CN_RENDER_SCALE_NO_BUDGET, 0.5f);
+		addFrames(&rs, 100000, 100);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, cnRenderScale_Scale(&rs), 0.0001f);
+	}
+
+	CN_TEST_UNIT("Scale drops in one jump after enough slow frames") {
+		CnRenderScale rs;
+		cnRenderScale_Init(&rs, 10000, 0.25f);
+		for (uint32_t i = 0; i + 1 < CN_RENDER_SCALE_FRAMES; ++i) {
+			CN_TEST_ASSERT_FALSE(cnRenderScale_AddFrame(&rs, 20000));
+		}
+		CN_TEST_ASSERT_TRUE(cnRenderScale_AddFrame(&rs, 20000));
+
+		// Twice the budget needs half the pixels, so 1/sqrt(2) of the scale.
+		CN_TEST_ASSERT_CLOSE_F(0.70f, cnRenderScale_Scale(&rs), 0.0001f);
+	}
+
+	CN_TEST_UNIT("Scale never drops below the minimum") {
+		CnRenderScale rs;
+		cnRenderScale_Init(&rs, 1000, 0.5f);
+		addFrames(&rs, 100000, 10 * CN_RENDER_SCALE_FRAMES);
+		CN_TEST_ASSERT_CLOSE_F(0.5f, cnRenderScale_Scale(&rs), 0.0001f);
+	}
+
+	CN_TEST_UNIT("Scale rises one step at a time with headroom") {
+		CnRenderScale rs;
+		cnRenderScale_Init(&rs, 10000, 0.25f);
+		addFrames(&rs, 40000, CN_RENDER_SCALE_FRAMES);
+		CN_TEST_ASSERT_CLOSE_F(0.5f, cnRenderScale_Scale(&rs), 0.0001f);
+
+		addFrames(&rs, 5000, CN_RENDER_SCALE_FRAMES);
+		CN_TEST_ASSERT_CLOSE_F(0.55f, cnRenderScale_Scale(&rs), 0.0001f);
+
+		// 8.5ms at 0.55 predicts over 9ms at 0.6, which is too close to the budget.
+		addFrames(&rs, 8500, 4 * CN_RENDER_SCALE_FRAMES);
+		CN_TEST_ASSERT_CLOSE_F(0.55f, cnRenderScale_Scale(&rs), 0.0001f);
+	}
+
+	CN_TEST_UNIT("Fast frames reach full resolution") {
+		CnRenderScale rs;
+		cnRenderScale_Init(&rs, 10000, 0.25f);
+		addFrames(&rs, 40000, CN_RENDER_SCALE_FRAMES);
+		addFrames(&rs, 1000, CN_RENDER_SCALE_STEPS * CN_RENDER_SCALE_FRAMES);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, cnRenderScale_Scale(&rs), 0.0001f);
+	}
+CN_TEST_SUITE_END
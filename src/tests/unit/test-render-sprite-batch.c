@@ -0,0 +1,163 @@
+#include <calendon/test.h>
+
+#include <calendon/assets.h>
+#include <calendon/assets-config.h>
+#include <calendon/compat-gl.h>
+#include <calendon/compat-sdl.h>
+#include <calendon/log.h>
+#include <calendon/render.h>
+#include <calendon/ui.h>
+
+static const CnDimension2u32 resolution = { 64, 64 };
+
+/**
+ * Drawing needs a window with a GL context, which machines running tests
+ * might not be able to create, so check before starting the renderer which
+ * fails hard without one.
+ */
+static bool canCreateContext(void)
+{
+	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+		return false;
+	}
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
+
+	bool created = false;
+	SDL_Window* probe = SDL_CreateWindow("Calendon", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+		(int)resolution.width, (int)resolution.height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+	if (probe) {
+		SDL_GLContext context = SDL_GL_CreateContext(probe);
+		created = context != NULL;
+		if (context) {
+			SDL_GL_DeleteContext(context);
+		}
+		SDL_DestroyWindow(probe);
+	}
+	SDL_Quit();
+	return created;
+}
+
+static bool loadSprite(CnSpriteId* id, bool inArray)
+{
+	CnPathBuffer path;
+	cnR_SetSpriteArrays(inArray);
+	return cnR_CreateSprite(id)
+		&& cnAssets_PathBufferFor("sprites/test_sprite.png", &path)
+		&& cnR_LoadSprite(*id, path.str);
+}
+
+static uint32_t readPixel(int32_t x, int32_t y)
+{
+	uint8_t pixel[4] = { 0 };
+	glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+	return (uint32_t)pixel[0] | ((uint32_t)pixel[1] << 8) | ((uint32_t)pixel[2] << 16);
+}
+
+CN_TEST_SUITE_BEGIN("Render sprite batch")
+	const bool hasContext = canCreateContext();
+	if (!hasContext) {
+		cnPrint("Unable to create a GL context, skipping drawing tests.\n");
+	}
+	else {
+		cnLog_PreInit();
+
+		CnSystem assets = cnAssets_System();
+		CnAssetsConfig* config = (CnAssetsConfig*)assets.config();
+		memset(config, 0, sizeof(CnAssetsConfig));
+		cnPathBuffer_Set(&config->assetDirPath, CN_TEST_ASSETS_DIR);
+		assets.init();
+
+		CnUIInitParams uiParams = { resolution };
+		cnUI_Init(&uiParams);
+		cnR_Init(resolution);
+	}
+
+	CN_TEST_UNIT("Sprites drawn after a batch keep their transform") {
+		if (!hasContext) {
+			break;
+		}
+
+		CnSpriteId batched;
+		CnSpriteId single;
+		CN_TEST_ASSERT_TRUE(loadSprite(&batched, true));
+		CN_TEST_ASSERT_TRUE(loadSprite(&single, false));
+
+		// Drawing the second sprite draws the pending batch first, which must
+		// not replace the transform set up for the second sprite.
+		cnR_StartFrame();
+		cnR_DrawSprite(batched, cnFloat2_Make(0.0f, 0.0f), (CnDimension2f) { 8.0f, 8.0f });
+		cnR_DrawSprite(single, cnFloat2_Make(24.0f, 24.0f), (CnDimension2f) { 16.0f, 16.0f });
+		CN_TEST_ASSERT_EQ_U32(0xFFFFFF, readPixel(32, 32));
+		cnR_EndFrame();
+	}
+
+	CN_TEST_UNIT("Rects drawn after a batch keep their transform") {
+		if (!hasContext) {
+			break;
+		}
+
+		CnSpriteId batched;
+		CN_TEST_ASSERT_TRUE(loadSprite(&batched, true));
+
+		cnR_StartFrame();
+		cnR_DrawSprite(batched, cnFloat2_Make(0.0f, 0.0f), (CnDimension2f) { 8.0f, 8.0f });
+		const CnOpaqueColor red = { 1.0f, 0.0f, 0.0f };
+		cnR_DrawRect(cnFloat2_Make(0.0f, 0.0f), (CnDimension2f) { 16.0f, 16.0f }, red,
+			cnTransform2_MakeTranslateXY(32.0f, 32.0f));
+		CN_TEST_ASSERT_EQ_U32(0x0000FF, readPixel(32, 32));
+		cnR_EndFrame();
+	}
+
+	CN_TEST_UNIT("Sprites too large to batch are still drawn") {
+		if (!hasContext) {
+			break;
+		}
+
+		CnSpriteId batched;
+		CN_TEST_ASSERT_TRUE(loadSprite(&batched, true));
+
+		// Far more than the packed positions of a batch can reach.
+		cnR_StartFrame();
+		cnR_DrawSprite(batched, cnFloat2_Make(-100000.0f, -100000.0f), (CnDimension2f) { 200000.0f, 200000.0f });
+		cnR_DrawSprite(batched, cnFloat2_Make(0.0f, 0.0f), (CnDimension2f) { 8.0f, 8.0f });
+		CN_TEST_ASSERT_EQ_U32(0xFFFFFF, readPixel(32, 32));
+		cnR_EndFrame();
+	}
+
+	CN_TEST_UNIT("Tilesets stay out of sprite arrays") {
+		if (!hasContext) {
+			break;
+		}
+
+		CnSpriteId batched;
+		CnTilemapId tilemap;
+		CN_TEST_ASSERT_TRUE(loadSprite(&batched, true));
+		CN_TEST_ASSERT_FALSE(cnR_CreateTilemap(&tilemap, (CnDimension2u32) { 4, 4 }, batched,
+			(CnDimension2u32) { 1, 1 }));
+
+		// Loading after the tilemap is created, as asynchronous loads do, must
+		// not move the tileset into an array.
+		CnSpriteId tileset;
+		CnPathBuffer path;
+		CN_TEST_ASSERT_TRUE(cnR_CreateSprite(&tileset));
+		CN_TEST_ASSERT_TRUE(cnR_CreateTilemap(&tilemap, (CnDimension2u32) { 4, 4 }, tileset,
+			(CnDimension2u32) { 1, 1 }));
+		cnR_SetSpriteArrays(true);
+		CN_TEST_ASSERT_TRUE(cnAssets_PathBufferFor("sprites/test_sprite.png", &path));
+		CN_TEST_ASSERT_TRUE(cnR_LoadSprite(tileset, path.str));
+
+		cnR_SetTile(tilemap, (CnRowColu32) { .row = 0, .col = 0 }, 1);
+		cnR_StartFrame();
+		cnR_DrawTilemap(tilemap, cnFloat2_Make(0.0f, 0.0f), (CnDimension2f) { 16.0f, 16.0f });
+		cnR_EndFrame();
+		cnR_DestroyTilemap(tilemap);
+	}
+
+	if (hasContext) {
+		cnR_Shutdown();
+		cnUI_Shutdown();
+		cnAssets_System().shutdown();
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,87 @@
+#include <calendon/test.h>
+
+#include <calendon/residency.h>
+
+typedef struct {
+	uint32_t evicted[CN_RESIDENCY_MAX_ENTRIES];
+	uint32_t numEvicted;
+} EvictLog;
+
+static void recordEviction(uint32_t entry, void* userData)
+{
+	EvictLog* log = (EvictLog*)userData;
+	log->evicted[log->numEvicted++] = entry;
+}
+
+CN_TEST_SUITE_BEGIN("Residency")
+	CN_TEST_UNIT("No budget never evicts") {
+		CnResidency residency;
+		cnResidency_Init(&residency, CN_RESIDENCY_NO_BUDGET);
+		cnResidency_Add(&residency, 0, 1000, false);
+		cnResidency_StartFrame(&residency);
+
+		EvictLog log = { 0 };
+		CN_TEST_ASSERT_EQ_U32(0, cnResidency_Evict(&residency, recordEviction, &log));
+		CN_TEST_ASSERT_EQ_U32(0, log.numEvicted);
+	}
+
+	CN_TEST_UNIT("Least recently used are evicted first") {
+		CnResidency residency;
+		cnResidency_Init(&residency, 250);
+		cnResidency_Add(&residency, 1, 100, false);
+		cnResidency_Add(&residency, 2, 100, false);
+		cnResidency_Add(&residency, 3, 100, false);
+
+		cnResidency_StartFrame(&residency);
+		CN_TEST_ASSERT_TRUE(cnResidency_Touch(&residency, 1));
+		cnResidency_StartFrame(&residency);
+		CN_TEST_ASSERT_TRUE(cnResidency_Touch(&residency, 3));
+
+		EvictLog log = { 0 };
+		CN_TEST_ASSERT_EQ_U32(1, cnResidency_Evict(&residency, recordEviction, &log));
+		CN_TEST_ASSERT_EQ_U32(2, log.evicted[0]);
+
+		cnResidency_StartFrame(&residency);
+		CnResidencyStats stats;
+		cnResidency_Stats(&residency, &stats);
+		CN_TEST_ASSERT_EQ_U32(1, stats.evictions);
+		CN_TEST_ASSERT_EQ_U64(200, stats.residentBytes);
+	}
+
+	CN_TEST_UNIT("Textures used this frame and pinned textures stay") {
+		CnResidency residency;
+		cnResidency_Init(&residency, 50);
+		cnResidency_Add(&residency, 0, 100, true);
+		cnResidency_StartFrame(&residency);
+		cnResidency_Add(&residency, 1, 100, false);
+
+		EvictLog log = { 0 };
+		CN_TEST_ASSERT_EQ_U32(0, cnResidency_Evict(&residency, recordEviction, &log));
+
+		cnResidency_StartFrame(&residency);
+		CN_TEST_ASSERT_EQ_U32(1, cnResidency_Evict(&residency, recordEviction, &log));
+		CN_TEST_ASSERT_EQ_U32(1, log.evicted[0]);
+	}
+
+	CN_TEST_UNIT("Evicted textures need reloading") {
+		CnResidency residency;
+		cnResidency_Init(&residency, 10);
+		cnResidency_Add(&residency, 4, 100, false);
+		cnResidency_StartFrame(&residency);
+
+		EvictLog log = { 0 };
+		CN_TEST_ASSERT_EQ_U32(1, cnResidency_Evict(&residency, recordEviction, &log));
+
+		cnResidency_StartFrame(&residency);
+		CN_TEST_ASSERT_FALSE(cnResidency_Touch(&residency, 4));
+		cnResidency_Reloaded(&residency, 4, 25);
+		CN_TEST_ASSERT_TRUE(cnResidency_Touch(&residency, 4));
+
+		cnResidency_StartFrame(&residency);
+		CnResidencyStats stats;
+		cnResidency_Stats(&residency, &stats);
+		CN_TEST_ASSERT_EQ_U32(1, stats.reloads);
+		CN_TEST_ASSERT_EQ_U64(25, stats.reloadMicros);
+		CN_TEST_ASSERT_EQ_U64(100, stats.residentBytes);
+	}
+CN_TEST_SUITE_END
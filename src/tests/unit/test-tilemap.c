@@ -0,0 +1,105 @@
+#include <calendon/test.h>
+
+#include <calendon/tilemap.h>
+
+static CnTilemapVertex vertices[CN_TILEMAP_CHUNK_TILES * CN_TILEMAP_VERTICES_PER_TILE];
+
+CN_TEST_SUITE_BEGIN("Tilemap")
+	CN_TEST_UNIT("Maps start empty and dirty") {
+		CnTilemap map;
+		CN_TEST_ASSERT_TRUE(cnTilemap_Allocate(&map, (CnDimension2u32) { 40, 70 }));
+		CN_TEST_ASSERT_EQ_U32(2, map.numChunks.width);
+		CN_TEST_ASSERT_EQ_U32(3, map.numChunks.height);
+		CN_TEST_ASSERT_EQ_U32(CN_TILE_EMPTY, cnTilemap_Get(&map, (CnRowColu32) { .row = 69, .col = 39 }));
+
+		const CnTilemapChunk* chunk = cnTilemap_Chunk(&map, (CnRowColu32) { .row = 2, .col = 1 });
+		CN_TEST_ASSERT_TRUE(chunk->dirty);
+		CN_TEST_ASSERT_EQ_U32(0, chunk->numTiles);
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Setting tiles only dirties their chunk") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { 64, 64 });
+		const CnRowColu32 chunk = { .row = 1, .col = 0 };
+		const CnRowColu32 other = { .row = 0, .col = 1 };
+		cnTilemap_BuildChunk(&map, chunk, (CnDimension2u32) { 1, 1 }, vertices);
+		cnTilemap_BuildChunk(&map, other, (CnDimension2u32) { 1, 1 }, vertices);
+
+		const CnRowColu32 position = { .row = 33, .col = 5 };
+		cnTilemap_Set(&map, position, 7);
+		CN_TEST_ASSERT_EQ_U32(7, cnTilemap_Get(&map, position));
+		CN_TEST_ASSERT_TRUE(cnTilemap_Chunk(&map, chunk)->dirty);
+		CN_TEST_ASSERT_FALSE(cnTilemap_Chunk(&map, other)->dirty);
+		CN_TEST_ASSERT_EQ_U32(1, cnTilemap_Chunk(&map, chunk)->numTiles);
+
+		cnTilemap_Set(&map, position, 3);
+		CN_TEST_ASSERT_EQ_U32(1, cnTilemap_Chunk(&map, chunk)->numTiles);
+		cnTilemap_Set(&map, position, CN_TILE_EMPTY);
+		CN_TEST_ASSERT_EQ_U32(0, cnTilemap_Chunk(&map, chunk)->numTiles);
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Visible chunks are clamped to the map") {
+		CnTilemap map;
+		// 8 chunks wide and 4 chunks tall.
+		cnTilemap_Allocate(&map, (CnDimension2u32) { 256, 128 });
+		const CnFloat2 origin = cnFloat2_Make(100.0f, 0.0f);
+		const CnDimension2f tileSize = { 1.0f, 2.0f };
+		CnRowColu32 first, last;
+
+		const CnAABB2 inside = cnAABB2_MakeMinMax(cnFloat2_Make(164.0f, 70.0f), cnFloat2_Make(300.0f, 130.0f));
+		CN_TEST_ASSERT_TRUE(cnTilemap_VisibleChunks(&map, origin, tileSize, inside, &first, &last));
+		CN_TEST_ASSERT_EQ_U32(2, first.col);
+		CN_TEST_ASSERT_EQ_U32(1, first.row);
+		CN_TEST_ASSERT_EQ_U32(6, last.col);
+		CN_TEST_ASSERT_EQ_U32(2, last.row);
+
+		const CnAABB2 overlapping = cnAABB2_MakeMinMax(cnFloat2_Make(-50.0f, -50.0f), cnFloat2_Make(120.0f, 10.0f));
+		CN_TEST_ASSERT_TRUE(cnTilemap_VisibleChunks(&map, origin, tileSize, overlapping, &first, &last));
+		CN_TEST_ASSERT_EQ_U32(0, first.col);
+		CN_TEST_ASSERT_EQ_U32(0, first.row);
+		CN_TEST_ASSERT_EQ_U32(0, last.col);
+		CN_TEST_ASSERT_EQ_U32(0, last.row);
+
+		const CnAABB2 everything = cnAABB2_MakeMinMax(cnFloat2_Make(-1e6f, -1e6f), cnFloat2_Make(1e6f, 1e6f));
+		CN_TEST_ASSERT_TRUE(cnTilemap_VisibleChunks(&map, origin, tileSize, everything, &first, &last));
+		CN_TEST_ASSERT_EQ_U32(7, last.col);
+		CN_TEST_ASSERT_EQ_U32(3, last.row);
+
+		const CnAABB2 outside = cnAABB2_MakeMinMax(cnFloat2_Make(0.0f, 0.0f), cnFloat2_Make(50.0f, 50.0f));
+		CN_TEST_ASSERT_FALSE(cnTilemap_VisibleChunks(&map, origin, tileSize, outside, &first, &last));
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Building a chunk skips empty tiles") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { 32, 32 });
+		cnTilemap_Set(&map, (CnRowColu32) { .row = 2, .col = 3 }, 1);
+		cnTilemap_Set(&map, (CnRowColu32) { .row = 0, .col = 0 }, 4);
+
+		const CnRowColu32 chunk = { .row = 0, .col = 0 };
+		CN_TEST_ASSERT_EQ_U32(2 * CN_TILEMAP_VERTICES_PER_TILE,
+			cnTilemap_BuildChunk(&map, chunk, (CnDimension2u32) { 2, 2 }, vertices));
+		CN_TEST_ASSERT_FALSE(cnTilemap_Chunk(&map, chunk)->dirty);
+
+		// Tile 4 is the lower right of a 2x2 tileset.
+		CN_TEST_ASSERT_EQ_I16(0, vertices[0].position[0]);
+		CN_TEST_ASSERT_EQ_I16(0, vertices[0].position[1]);
+		CN_TEST_ASSERT_EQ_U16(32767, vertices[0].texCoord[0]);
+		CN_TEST_ASSERT_EQ_U16(0, vertices[0].texCoord[1]);
+		CN_TEST_ASSERT_EQ_U16(65535, vertices[4].texCoord[0]);
+		CN_TEST_ASSERT_EQ_U16(32767, vertices[4].texCoord[1]);
+
+		// Tile 1 is the upper left of a 2x2 tileset.
+		const CnTilemapVertex* v = &vertices[CN_TILEMAP_VERTICES_PER_TILE];
+		CN_TEST_ASSERT_EQ_I16(3, v[0].position[0]);
+		CN_TEST_ASSERT_EQ_I16(2, v[0].position[1]);
+		CN_TEST_ASSERT_EQ_I16(4, v[4].position[0]);
+		CN_TEST_ASSERT_EQ_I16(3, v[4].position[1]);
+		CN_TEST_ASSERT_EQ_U16(0, v[0].texCoord[0]);
+		CN_TEST_ASSERT_EQ_U16(32767, v[0].texCoord[1]);
+		CN_TEST_ASSERT_EQ_U16(65535, v[4].texCoord[1]);
+		cnTilemap_Free(&map);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,150 @@
+/**
+ * @file calendon-bake.c
+ *
+ * Populates the image cache ahead of time, so the first run after a change to
+ * assets doesn't pay for decoding every image or building every font atlas.
+ * See `image-cache.h`.
+ *
+ * Usage: calendon-baker ASSET_DIR CACHE_DIR
+ */
+#include <calendon/cn.h>
+
+#include <calendon/font-psf2.h>
+#include <calendon/image-cache.h>
+#include <calendon/image-mips.h>
+#include <calendon/log.h>
+#include <calendon/path.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tools-walk.h"
+
+typedef struct {
+	uint32_t numBaked;
+	uint32_t numCurrent;
+} CnBakeStats;
+
+static bool cnBake_HasExtension(const char* name, const char* extension)
+{
+	const size_t length = strlen(name);
+	const size_t extensionLength = strlen(extension);
+	return length > extensionLength && strcmp(name + length - extensionLength, extension) == 0;
+}
+
+static bool cnBake_Font(const char* path, const char* name, CnBakeStats* stats)
+{
+	CnFontPSF2 font;
+	if (cnFont_PSF2LoadCached(&font, name, path)) {
+		cnFont_PSF2Free(&font);
+		++stats->numCurrent;
+		return true;
+	}
+
+	if (!cnFont_PSF2Build(&font, path)) {
+		fprintf(stderr, "Unable to build font: %s\n", path);
+		return false;
+	}
+
+	const bool stored = cnFont_PSF2StoreCached(&font, name, path);
+	cnFont_PSF2Free(&font);
+	if (!stored) {
+		fprintf(stderr, "Unable to cache: %s\n", name);
+		return false;
+	}
+
+	printf("Baked %s\n", name);
+	++stats->numBaked;
+	return true;
+}
+
+static bool cnBake_File(const char* path, const char* name, void* userData)
+{
+	CnBakeStats* stats = (CnBakeStats*)userData;
+
+	if (cnBake_HasExtension(name, ".psf") || cnBake_HasExtension(name, ".psf2")) {
+		return cnBake_Font(path, name, stats);
+	}
+
+	if (!cnBake_HasExtension(name, ".png")) {
+		return true;
+	}
+
+	// Sprites are uploaded with full mip chains, so entries without them are
+	// out of date.
+	CnCachedImage cached;
+	if (cnImageCache_Map(&cached, name, path)) {
+		const CnDimension2u32 size = { cached.width, cached.height };
+		const bool current = cached.numLevels == cnImageMips_NumLevels(size);
+		cnImageCache_Release(&cached);
+		if (current) {
+			++stats->numCurrent;
+			return true;
+		}
+	}
+
+	CnImageRGBA8 image;
+	if (!cnImageRGBA8_Allocate(&image, path)) {
+		fprintf(stderr, "Unable to decode: %s\n", path);
+		return false;
+	}
+
+	const CnDimension2u32 size = { image.width, image.height };
+	const uint32_t numLevels = cnImageMips_NumLevels(size);
+	CnDynamicBuffer mips = { 0 };
+	if (numLevels > 1) {
+		cnDynamicBuffer_Allocate(&mips, cnImageMips_TailSize(size, numLevels));
+		cnImageMips_Build((uint8_t*)mips.contents, (const uint8_t*)image.pixels.contents, size, numLevels);
+	}
+
+	const bool stored = cnImageCache_Store(&image, (const uint8_t*)mips.contents, numLevels, name, path);
+	if (mips.contents) {
+		cnDynamicBuffer_Free(&mips);
+	}
+	cnImageRGBA8_Free(&image);
+	if (!stored) {
+		fprintf(stderr, "Unable to cache: %s\n", name);
+		return false;
+	}
+
+	printf("Baked %s\n", name);
+	++stats->numBaked;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage: %s ASSET_DIR CACHE_DIR\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char* assetDir = argv[1];
+	const char* cacheDir = argv[2];
+
+	if (!cnPath_IsDir(assetDir)) {
+		fprintf(stderr, "Asset directory does not exist: %s\n", assetDir);
+		return EXIT_FAILURE;
+	}
+
+	// Engine systems aren't running, so errors are reported here instead.
+	cnLog_SetEnabled(false);
+
+	if (!cnImageCache_Open(cacheDir)) {
+		fprintf(stderr, "Unable to open image cache: %s\n", cacheDir);
+		return EXIT_FAILURE;
+	}
+
+	CnBakeStats stats;
+	memset(&stats, 0, sizeof(stats));
+	const bool baked = cnTools_WalkFiles(assetDir, cnBake_File, &stats);
+	cnImageCache_Close();
+
+	if (!baked) {
+		return EXIT_FAILURE;
+	}
+
+	printf("Baked %" PRIu32 " assets, %" PRIu32 " already up to date, into %s\n",
+		stats.numBaked, stats.numCurrent, cacheDir);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file calendon-pack.c
+ *
+ * Packs every file within an asset directory into a single asset archive,
+ * which the assets system maps and prefers over loose files.  See
+ * `assets-archive.h` for the archive layout.
+ *
+ * Usage: calendon-packer [--compress] ASSET_DIR OUTPUT_FILE
+ *
+ * With `--compress`, entries are zlib compressed when that makes them
+ * smaller.  Already compressed formats (such as PNG) are usually left stored.
+ */
+#include <calendon/cn.h>
+
+#include <calendon/assets-archive.h>
+#include <calendon/path.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "tools-walk.h"
+
+typedef struct {
+	char* name;
+	uint64_t nameHash;
+	uint8_t* stored;
+	uint32_t storedSize;
+	uint32_t size;
+	uint32_t flags;
+} CnPackEntry;
+
+typedef struct {
+	CnPackEntry* entries;
+	uint32_t numEntries;
+	uint32_t capacity;
+	bool compress;
+} CnPackList;
+
+static bool cnPack_ReadWholeFile(const char* path, uint8_t** contents, uint32_t* size)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file) {
+		fprintf(stderr, "Unable to open: %s\n", path);
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	const long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (length < 0 || (unsigned long)length > UINT32_MAX) {
+		fprintf(stderr, "Unable to determine size of: %s\n", path);
+		fclose(file);
+		return false;
+	}
+
+	*size = (uint32_t)length;
+	*contents = NULL;
+	if (*size == 0) {
+		fclose(file);
+		return true;
+	}
+
+	*contents = malloc(*size);
+	if (!*contents || fread(*contents, 1, *size, file) != *size) {
+		fprintf(stderr, "Unable to read: %s\n", path);
+		free(*contents);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+	return true;
+}
+
+static bool cnPack_AddFile(const char* path, const char* name, void* userData)
+{
+	CnPackList* list = (CnPackList*)userData;
+
+	uint8_t* contents;
+	uint32_t size;
+	if (!cnPack_ReadWholeFile(path, &contents, &size)) {
+		return false;
+	}
+
+	// Empty files can't be mapped, so leave them as loose files.
+	if (size == 0) {
+		printf("Skipping empty file: %s\n", name);
+		return true;
+	}
+
+	if (list->numEntries == list->capacity) {
+		list->capacity = list->capacity ? list->capacity * 2 : 64;
+		list->entries = realloc(list->entries, list->capacity * sizeof(CnPackEntry));
+		if (!list->entries) {
+			fprintf(stderr, "Unable to allocate pack entries.\n");
+			return false;
+		}
+	}
+
+	CnPackEntry* entry = &list->entries[list->numEntries++];
+	entry->name = malloc(strlen(name) + 1);
+	strcpy(entry->name, name);
+	entry->nameHash = cnArchive_HashName(name);
+	entry->stored = contents;
+	entry->storedSize = size;
+	entry->size = size;
+	entry->flags = 0;
+
+	if (list->compress) {
+		uLongf compressedSize = compressBound(size);
+		uint8_t* compressed = malloc(compressedSize);
+		if (compressed
+			&& compress2(compressed, &compressedSize, contents, size, Z_BEST_COMPRESSION) == Z_OK
+			&& compressedSize < size)
+		{
+			free(entry->stored);
+			entry->stored = compressed;
+			entry->storedSize = (uint32_t)compressedSize;
+			entry->flags |= CN_ARCHIVE_ENTRY_FLAG_ZLIB;
+		}
+		else {
+			free(compressed);
+		}
+	}
+	return true;
+}
+
+static int cnPack_CompareEntries(const void* left, const void* right)
+{
+	const CnPackEntry* a = (const CnPackEntry*)left;
+	const CnPackEntry* b = (const CnPackEntry*)right;
+	if (a->nameHash != b->nameHash) {
+		return a->nameHash < b->nameHash ? -1 : 1;
+	}
+	return strcmp(a->name, b->name);
+}
+
+static uint64_t cnPack_Align(uint64_t offset)
+{
+	return (offset + CN_ARCHIVE_ALIGNMENT - 1) & ~(uint64_t)(CN_ARCHIVE_ALIGNMENT - 1);
+}
+
+static bool cnPack_WritePadding(FILE* file, uint64_t from, uint64_t to)
+{
+	static const uint8_t zeroes[CN_ARCHIVE_ALIGNMENT] = { 0 };
+	const size_t padding = (size_t)(to - from);
+	return padding == 0 || fwrite(zeroes, 1, padding, file) == padding;
+}
+
+/**
+ * Writes the archive.  This assumes a little-endian host, as do readers.
+ */
+static bool cnPack_Write(const CnPackList* list, const char* outputPath)
+{
+	CnArchiveHeader header;
+	memcpy(header.magic, cnArchive_Magic, sizeof(header.magic));
+	header.version = CN_ARCHIVE_VERSION;
+	header.numEntries = list->numEntries;
+	header.namesSize = 0;
+
+	CnArchiveEntry* entries = calloc(list->numEntries ? list->numEntries : 1, sizeof(CnArchiveEntry));
+	if (!entries) {
+		fprintf(stderr, "Unable to allocate archive table of contents.\n");
+		return false;
+	}
+
+	for (uint32_t i = 0; i < list->numEntries; ++i) {
+		entries[i].nameOffset = header.namesSize;
+		header.namesSize += (uint32_t)strlen(list->entries[i].name) + 1;
+	}
+
+	uint64_t offset = sizeof(CnArchiveHeader)
+		+ (uint64_t)list->numEntries * sizeof(CnArchiveEntry)
+		+ header.namesSize;
+	for (uint32_t i = 0; i < list->numEntries; ++i) {
+		offset = cnPack_Align(offset);
+		entries[i].nameHash = list->entries[i].nameHash;
+		entries[i].offset = offset;
+		entries[i].storedSize = list->entries[i].storedSize;
+		entries[i].size = list->entries[i].size;
+		entries[i].flags = list->entries[i].flags;
+		offset += list->entries[i].storedSize;
+	}
+
+	FILE* file = fopen(outputPath, "wb");
+	if (!file) {
+		fprintf(stderr, "Unable to open output: %s\n", outputPath);
+		free(entries);
+		return false;
+	}
+
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1
+		&& (list->numEntries == 0
+			|| fwrite(entries, sizeof(CnArchiveEntry), list->numEntries, file) == list->numEntries);
+	for (uint32_t i = 0; written && i < list->numEntries; ++i) {
+		const size_t nameSize = strlen(list->entries[i].name) + 1;
+		written = fwrite(list->entries[i].name, 1, nameSize, file) == nameSize;
+	}
+
+	uint64_t position = sizeof(CnArchiveHeader)
+		+ (uint64_t)list->numEntries * sizeof(CnArchiveEntry)
+		+ header.namesSize;
+	for (uint32_t i = 0; written && i < list->numEntries; ++i) {
+		written = cnPack_WritePadding(file, position, entries[i].offset)
+			&& fwrite(list->entries[i].stored, 1, entries[i].storedSize, file) == entries[i].storedSize;
+		position = entries[i].offset + entries[i].storedSize;
+	}
+
+	fclose(file);
+	free(entries);
+
+	if (!written) {
+		fprintf(stderr, "Unable to write output: %s\n", outputPath);
+	}
+	return written;
+}
+
+int main(int argc, char* argv[])
+{
+	CnPackList list;
+	memset(&list, 0, sizeof(list));
+
+	int nextArg = 1;
+	if (nextArg < argc && strcmp(argv[nextArg], "--compress") == 0) {
+		list.compress = true;
+		++nextArg;
+	}
+
+	if (argc - nextArg != 2) {
+		fprintf(stderr, "Usage: %s [--compress] ASSET_DIR OUTPUT_FILE\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char* assetDir = argv[nextArg];
+	const char* outputPath = argv[nextArg + 1];
+
+	if (!cnPath_IsDir(assetDir)) {
+		fprintf(stderr, "Asset directory does not exist: %s\n", assetDir);
+		return EXIT_FAILURE;
+	}
+
+	if (!cnTools_WalkFiles(assetDir, cnPack_AddFile, &list)) {
+		return EXIT_FAILURE;
+	}
+
+	qsort(list.entries, list.numEntries, sizeof(CnPackEntry), cnPack_CompareEntries);
+
+	uint64_t totalSize = 0;
+	uint64_t totalStored = 0;
+	for (uint32_t i = 0; i < list.numEntries; ++i) {
+		totalSize += list.entries[i].size;
+		totalStored += list.entries[i].storedSize;
+		if (i > 0 && cnPack_CompareEntries(&list.entries[i - 1], &list.entries[i]) == 0) {
+			fprintf(stderr, "Duplicate asset name: %s\n", list.entries[i].name);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!cnPack_Write(&list, outputPath)) {
+		return EXIT_FAILURE;
+	}
+
+	printf("Packed %" PRIu32 " assets (%" PRIu64 " bytes, %" PRIu64 " stored) into %s\n",
+		list.numEntries, totalSize, totalStored, outputPath);
+
+	for (uint32_t i = 0; i < list.numEntries; ++i) {
+		free(list.entries[i].name);
+		free(list.entries[i].stored);
+	}
+	free(list.entries);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#include "tools-walk.h"
+
+#include <calendon/path.h>
+
+#include <stdio.h>
+
+#ifdef _WIN32
+	#include <calendon/compat-windows.h>
+#else
+	#include <dirent.h>
+#endif
+
+static bool cnTools_WalkDirectory(const char* dir, const char* relative, CnTools_WalkFn onFile,
+	void* userData)
+{
+	char path[CN_MAX_TERMINATED_PATH];
+	char name[CN_MAX_TERMINATED_PATH];
+
+#ifdef _WIN32
+	char search[CN_MAX_TERMINATED_PATH];
+	snprintf(search, sizeof(search), "%s/*", dir);
+
+	WIN32_FIND_DATAA found;
+	HANDLE finder = FindFirstFileA(search, &found);
+	if (finder == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "Unable to read directory: %s\n", dir);
+		return false;
+	}
+	do {
+		const char* child = found.cFileName;
+#else
+	DIR* handle = opendir(dir);
+	if (!handle) {
+		fprintf(stderr, "Unable to read directory: %s\n", dir);
+		return false;
+	}
+	struct dirent* found;
+	while ((found = readdir(handle)) != NULL) {
+		const char* child = found->d_name;
+#endif
+		// Skip ".", ".." and hidden files.
+		if (child[0] == '.') {
+			continue;
+		}
+
+		snprintf(path, sizeof(path), "%s/%s", dir, child);
+		if (relative[0]) {
+			snprintf(name, sizeof(name), "%s/%s", relative, child);
+		}
+		else {
+			snprintf(name, sizeof(name), "%s", child);
+		}
+
+		const bool keepWalking = cnPath_IsDir(path)
+			? cnTools_WalkDirectory(path, name, onFile, userData)
+			: onFile(path, name, userData);
+		if (!keepWalking) {
+#ifdef _WIN32
+			FindClose(finder);
+#else
+			closedir(handle);
+#endif
+			return false;
+		}
+#ifdef _WIN32
+	} while (FindNextFileA(finder, &found));
+	FindClose(finder);
+#else
+	}
+	closedir(handle);
+#endif
+	return true;
+}
+
+/**
+ * Visits every file under a directory, recursively, skipping hidden files and
+ * directories.
+ *
+ * @return false if a directory couldn't be read or `onFile` stopped the walk
+ */
+bool cnTools_WalkFiles(const char* dir, CnTools_WalkFn onFile, void* userData)
+{
+	return cnTools_WalkDirectory(dir, "", onFile, userData);
+}
@@ -0,0 +1,17 @@
+#ifndef CN_TOOLS_WALK_H
+#define CN_TOOLS_WALK_H
+
+#include <calendon/cn.h>
+
+/**
+ * Called for each file found by `cnTools_WalkFiles`.
+ *
+ * @param path the path to the file, usable for opening it
+ * @param name the path relative to the walked directory, using '/' separators
+ * @return false to stop walking
+ */
+typedef bool (*CnTools_WalkFn)(const char* path, const char* name, void* userData);
+
+bool cnTools_WalkFiles(const char* dir, CnTools_WalkFn onFile, void* userData);
+
+#endif /* CN_TOOLS_WALK_H */